@@ -3014,7 +3014,9 @@ MagickExport MagickBooleanType IsBlobTemporary(const Image *image)
 %
 %    o file: map this file descriptor.
 %
-%    o mode: ReadMode, WriteMode, or IOMode.
+%    o mode: ReadMode, WriteMode, IOMode, or PersistMode.  PersistMode maps
+%      the file privately: pages are shared until written, and writes are never
+%      carried through to the file.
 %
 %    o offset: starting at this offset within the file.
 %
@@ -3063,6 +3065,12 @@ MagickExport void *MapBlob(int file,const MapMode mode,
       flags|=MAP_SHARED;
       break;
     }
+    case PersistMode:
+    {
+      protection=PROT_READ | PROT_WRITE;
+      flags|=MAP_PRIVATE;
+      break;
+    }
   }
 #if !defined(MAGICKCORE_HAVE_HUGEPAGES) || !defined(MAP_HUGETLB)
   map=mmap((char *) NULL,length,protection,flags,file,offset);
@@ -122,6 +122,13 @@ typedef struct _NexusInfo
   void
     *metacontent;
 
+  size_t
+    sequential;
+
+  ssize_t
+    readahead_y,
+    release_y;
+
   size_t
     signature;
 
@@ -183,13 +190,15 @@ typedef struct _CacheInfo
     **nexus_info;
 
   Quantum
-    *pixels;
+    *pixels,
+    *shared_pixels;
 
   void
     *metacontent;
 
   int
-    file;
+    file,
+    shared_file;
 
   char
     filename[MagickPathExtent],
@@ -202,7 +211,9 @@ typedef struct _CacheInfo
     *random_info;
 
   void
-    *server_info;
+    *server_info,
+    *tier_info,
+    *ring_info;
 
   MagickBooleanType
     synchronize,
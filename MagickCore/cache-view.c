@@ -166,7 +166,7 @@ MagickExport CacheView *AcquireVirtualCacheView(const Image *image,
     ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
   (void) memset(cache_view,0,sizeof(*cache_view));
   cache_view->image=ReferenceImage((Image *) image);
-  cache_view->number_threads=GetOpenMPMaximumThreads();
+  cache_view->number_threads=GetMagickTaskThreads();
   if (GetMagickResourceLimit(ThreadResource) > cache_view->number_threads)
     cache_view->number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
   if (cache_view->number_threads == 0)
@@ -300,7 +300,7 @@ MagickExport Quantum *GetCacheViewAuthenticPixels(CacheView *cache_view,
   ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict pixels;
@@ -341,7 +341,7 @@ MagickExport Quantum *GetCacheViewAuthenticPixels(CacheView *cache_view,
 MagickExport void *GetCacheViewAuthenticMetacontent(CacheView *cache_view)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(cache_view != (CacheView *) NULL);
   assert(cache_view->signature == MagickCoreSignature);
@@ -378,7 +378,7 @@ MagickExport void *GetCacheViewAuthenticMetacontent(CacheView *cache_view)
 MagickExport Quantum *GetCacheViewAuthenticPixelQueue(CacheView *cache_view)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(cache_view != (CacheView *) NULL);
   assert(cache_view->signature == MagickCoreSignature);
@@ -447,7 +447,7 @@ MagickExport ColorspaceType GetCacheViewColorspace(const CacheView *cache_view)
 MagickExport MagickSizeType GetCacheViewExtent(const CacheView *cache_view)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   MagickSizeType
     extent;
@@ -558,7 +558,7 @@ MagickExport const void *GetCacheViewVirtualMetacontent(
   const CacheView *cache_view)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const void
     *magick_restrict metacontent;
@@ -601,7 +601,7 @@ MagickExport const Quantum *GetCacheViewVirtualPixelQueue(
   const CacheView *cache_view)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict pixels;
@@ -652,7 +652,7 @@ MagickExport const Quantum *GetCacheViewVirtualPixels(
   const size_t columns,const size_t rows,ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict pixels;
@@ -702,7 +702,7 @@ MagickExport MagickBooleanType GetOneCacheViewAuthenticPixel(
   ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict q;
@@ -774,7 +774,7 @@ MagickExport MagickBooleanType GetOneCacheViewVirtualPixel(
   ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict p;
@@ -847,7 +847,7 @@ MagickExport MagickBooleanType GetOneCacheViewVirtualPixelInfo(
   ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict p;
@@ -906,7 +906,7 @@ MagickExport MagickBooleanType GetOneCacheViewVirtualMethodPixel(
   const ssize_t x,const ssize_t y,Quantum *pixel,ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict p;
@@ -978,7 +978,7 @@ MagickExport Quantum *QueueCacheViewAuthenticPixels(CacheView *cache_view,
   ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict pixels;
@@ -1100,7 +1100,7 @@ MagickExport MagickBooleanType SyncCacheViewAuthenticPixels(
   CacheView *magick_restrict cache_view,ExceptionInfo *exception)
 {
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   MagickBooleanType
     status;
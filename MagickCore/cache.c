@@ -81,6 +81,13 @@
 #if defined(MAGICKCORE_HAVE_SYS_LOADAVG_H)
 #  include <sys/loadavg.h>
 #endif
+#if defined(__linux__) && defined(MAGICKCORE_HAVE_MMAP)
+#  include <sys/syscall.h>
+#  if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#    include <linux/io_uring.h>
+#    define CacheRingSupport  1
+#  endif
+#endif
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
 #  include "zlib.h"
 #endif
@@ -88,13 +95,74 @@
 /*
   Define declarations.
 */
+#define CacheReadaheadExtent  8388608UL
+#define CacheRingEntries  64U
 #define CacheTick(offset,extent)  QuantumTick((MagickOffsetType) offset,extent)
+#define CacheSharedExtent  67108864UL
+#define CacheTierBlockExtent  16384UL
+#define CacheTierResidentExtent  67108864UL
 #define IsFileDescriptorLimitExceeded() (GetMagickResource(FileResource) > \
   GetMagickResourceLimit(FileResource) ? MagickTrue : MagickFalse)
 
 /*
   Typedef declarations.
 */
+typedef struct _CacheBlockInfo
+{
+  unsigned char
+    *pixels,
+    *blob;
+
+  size_t
+    length;
+
+  MagickBooleanType
+    dirty,
+    referenced;
+} CacheBlockInfo;
+
+typedef struct _CacheTierInfo
+{
+  CacheBlockInfo
+    *blocks;
+
+  size_t
+    number_blocks,
+    *resident,
+    number_resident,
+    max_resident,
+    hand;
+
+  MagickSizeType
+    limit;
+} CacheTierInfo;
+
+#if defined(CacheRingSupport)
+typedef struct _CacheRingInfo
+{
+  int
+    file;
+
+  struct io_uring_params
+    parameters;
+
+  unsigned char
+    *sq_ring,
+    *cq_ring;
+
+  size_t
+    sq_extent,
+    cq_extent,
+    sqes_extent;
+
+  struct io_uring_sqe
+    *sqes;
+
+  struct iovec
+    iovecs[CacheRingEntries];
+} CacheRingInfo;
+#endif
+
 typedef struct _MagickModulo
 {
   ssize_t
@@ -122,6 +190,7 @@ static const void
   *GetVirtualMetacontentFromCache(const Image *);
 
 static MagickBooleanType
+  AcquirePixelCacheTier(CacheInfo *),
   GetOneAuthenticPixelFromCache(Image *,const ssize_t,const ssize_t,Quantum *,
     ExceptionInfo *),
   GetOneVirtualPixelFromCache(const Image *,const VirtualPixelMethod,
@@ -133,6 +202,7 @@ static MagickBooleanType
   ReadPixelCacheMetacontent(CacheInfo *magick_restrict,
     NexusInfo *magick_restrict,ExceptionInfo *),
   SyncAuthenticPixelsCache(Image *,ExceptionInfo *),
+  SyncPixelCacheTier(CacheInfo *),
   WritePixelCachePixels(CacheInfo *magick_restrict,NexusInfo *magick_restrict,
     ExceptionInfo *),
   WritePixelCacheMetacontent(CacheInfo *,NexusInfo *magick_restrict,
@@ -148,6 +218,9 @@ static Quantum
     const MagickBooleanType,NexusInfo *magick_restrict,ExceptionInfo *)
     magick_hot_spot;
 
+static void
+  DestroyPixelCacheTier(CacheInfo *);
+
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
 static void
   CopyOpenCLBuffer(CacheInfo *magick_restrict);
@@ -164,7 +237,19 @@ static SemaphoreInfo
   *cache_semaphore = (SemaphoreInfo *) NULL;
 
 static ssize_t
-  cache_anonymous_memory = (-1);
+  cache_anonymous_memory = (-1),
+  cache_first_touch = (-1),
+  cache_shared_memory = (-1);
+
+#if defined(CacheRingSupport)
+static MagickBooleanType
+  cache_ring_disabled = MagickFalse;
+#endif
+
+static MagickSizeType
+  cache_physical_memory = 0,
+  cache_tier_compressed = 0,
+  cache_tier_resident = 0;
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -205,10 +290,11 @@ MagickPrivate Cache AcquirePixelCache(const size_t number_threads)
   cache_info->disk_mode=IOMode;
   cache_info->colorspace=sRGBColorspace;
   cache_info->file=(-1);
+  cache_info->shared_file=(-1);
   cache_info->id=GetMagickThreadId();
   cache_info->number_threads=number_threads;
-  if (GetOpenMPMaximumThreads() > cache_info->number_threads)
-    cache_info->number_threads=GetOpenMPMaximumThreads();
+  if (GetMagickTaskThreads() > cache_info->number_threads)
+    cache_info->number_threads=GetMagickTaskThreads();
   if (cache_info->number_threads == 0)
     cache_info->number_threads=1;
   cache_info->nexus_info=AcquirePixelCacheNexus(cache_info->number_threads);
@@ -629,6 +715,9 @@ static MagickBooleanType ClonePixelCacheOnDisk(
   /*
     Clone pixel cache on disk with identical morphology.
   */
+  if ((SyncPixelCacheTier(cache_info) == MagickFalse) ||
+      (SyncPixelCacheTier(clone_info) == MagickFalse))
+    return(MagickFalse);
   if ((OpenPixelCacheOnDisk(cache_info,ReadMode) == MagickFalse) ||
       (OpenPixelCacheOnDisk(clone_info,IOMode) == MagickFalse))
     return(MagickFalse);
@@ -722,6 +811,68 @@ static inline int GetCacheNumberThreads(const CacheInfo *source,
 }
 #endif
 
+static MagickBooleanType ShareCachePixels(CacheInfo *clone_info,
+  CacheInfo *cache_info)
+{
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MFD_CLOEXEC)
+  void
+    *clone_pixels,
+    *pixels;
+
+  /*
+    Share the pixels of a memory cache backed by an anonymous file: both caches
+    map the file privately so only the pages either one writes are copied.
+    Other images may still be reading the source through its shared mapping,
+    so that mapping is left in place until the source is relinquished and the
+    source moves to a fresh private mapping of the same pages.
+  */
+  if ((cache_info->type != MemoryCache) || (cache_info->shared_file == -1) ||
+      (clone_info->type != MemoryCache) ||
+      (clone_info->length != cache_info->length))
+    return(MagickFalse);
+  clone_pixels=mmap((char *) NULL,(size_t) cache_info->length,PROT_READ |
+    PROT_WRITE,MAP_PRIVATE,cache_info->shared_file,0);
+  if (clone_pixels == MAP_FAILED)
+    return(MagickFalse);
+  pixels=mmap((char *) NULL,(size_t) cache_info->length,PROT_READ |
+    PROT_WRITE,MAP_PRIVATE,cache_info->shared_file,0);
+  if (pixels == MAP_FAILED)
+    {
+      (void) munmap(clone_pixels,(size_t) cache_info->length);
+      return(MagickFalse);
+    }
+  cache_info->shared_pixels=cache_info->pixels;
+  cache_info->pixels=(Quantum *) pixels;
+  if (cache_info->metacontent_extent != 0)
+    cache_info->metacontent=(void *) (cache_info->pixels+
+      cache_info->number_channels*cache_info->columns*cache_info->rows);
+  (void) close(cache_info->shared_file);
+  cache_info->shared_file=(-1);
+  RelinquishMagickResource(FileResource,1);
+  if (clone_info->shared_file != -1)
+    {
+      (void) close(clone_info->shared_file);
+      clone_info->shared_file=(-1);
+      RelinquishMagickResource(FileResource,1);
+    }
+  if (clone_info->mapped != MagickFalse)
+    (void) UnmapBlob(clone_info->pixels,(size_t) clone_info->length);
+  else
+    clone_info->pixels=(Quantum *) RelinquishAlignedMemory(clone_info->pixels);
+  clone_info->mapped=MagickTrue;
+  clone_info->pixels=(Quantum *) clone_pixels;
+  clone_info->metacontent=(void *) NULL;
+  if (clone_info->metacontent_extent != 0)
+    clone_info->metacontent=(void *) (clone_info->pixels+
+      clone_info->number_channels*clone_info->columns*clone_info->rows);
+  return(MagickTrue);
+#else
+  magick_unreferenced(clone_info);
+  magick_unreferenced(cache_info);
+  return(MagickFalse);
+#endif
+}
+
 static MagickBooleanType ClonePixelCacheRepository(
   CacheInfo *magick_restrict clone_info,CacheInfo *magick_restrict cache_info,
   ExceptionInfo *exception)
@@ -766,6 +917,8 @@ static MagickBooleanType ClonePixelCacheRepository(
            (cache_info->type == MapCache)) &&
           ((clone_info->type == MemoryCache) || (clone_info->type == MapCache)))
         {
+          if (ShareCachePixels(clone_info,cache_info) != MagickFalse)
+            return(MagickTrue);
           (void) memcpy(clone_info->pixels,cache_info->pixels,
             cache_info->number_channels*cache_info->columns*cache_info->rows*
             sizeof(*cache_info->pixels));
@@ -798,7 +951,7 @@ static MagickBooleanType ClonePixelCacheRepository(
   for (y=0; y < (ssize_t) cache_info->rows; y++)
   {
     const int
-      id = GetOpenMPThreadId();
+      id = GetMagickTaskThreadId();
 
     Quantum
       *pixels;
@@ -879,7 +1032,7 @@ static MagickBooleanType ClonePixelCacheRepository(
       for (y=0; y < (ssize_t) cache_info->rows; y++)
       {
         const int
-          id = GetOpenMPThreadId();
+          id = GetMagickTaskThreadId();
 
         Quantum
           *pixels;
@@ -1018,6 +1171,299 @@ MagickExport void DestroyImagePixels(Image *image)
 %
 */
 
+#if defined(CacheRingSupport)
+/*
+  A disk cache reads the rows of a nexus region that are not contiguous on disk
+  through an io_uring submission queue: one request per row, submitted in
+  batches of up to CacheRingEntries, so a region costs one system call per
+  batch rather than one per row and the device sees the whole batch at once.
+  Writes stay synchronous: buffered io_uring writes are handed to kernel worker
+  threads, which costs more than the pwrite() they replace.  All ring accesses
+  are serialized by the cache file semaphore.
+*/
+
+static CacheRingInfo *DestroyCacheRingInfo(CacheRingInfo *ring_info)
+{
+  if (ring_info->sqes != (struct io_uring_sqe *) NULL)
+    (void) munmap(ring_info->sqes,ring_info->sqes_extent);
+  if ((ring_info->cq_ring != (unsigned char *) NULL) &&
+      (ring_info->cq_ring != ring_info->sq_ring))
+    (void) munmap(ring_info->cq_ring,ring_info->cq_extent);
+  if (ring_info->sq_ring != (unsigned char *) NULL)
+    (void) munmap(ring_info->sq_ring,ring_info->sq_extent);
+  if (ring_info->file != -1)
+    {
+      (void) close(ring_info->file);
+      RelinquishMagickResource(FileResource,1);
+    }
+  return((CacheRingInfo *) RelinquishMagickMemory(ring_info));
+}
+
+static CacheRingInfo *AcquireCacheRingInfo(void)
+{
+  CacheRingInfo
+    *ring_info;
+
+  struct io_uring_params
+    *parameters;
+
+  void
+    *map;
+
+  ring_info=(CacheRingInfo *) AcquireMagickMemory(sizeof(*ring_info));
+  if (ring_info == (CacheRingInfo *) NULL)
+    return((CacheRingInfo *) NULL);
+  (void) memset(ring_info,0,sizeof(*ring_info));
+  ring_info->file=(-1);
+  if (AcquireMagickResource(FileResource,1) == MagickFalse)
+    {
+      RelinquishMagickResource(FileResource,1);
+      return(DestroyCacheRingInfo(ring_info));
+    }
+  parameters=(&ring_info->parameters);
+  ring_info->file=(int) syscall(__NR_io_uring_setup,CacheRingEntries,
+    parameters);
+  if (ring_info->file < 0)
+    {
+      /*
+        Only stop trying for good if the kernel refuses io_uring outright.
+      */
+      if ((errno == ENOSYS) || (errno == EPERM))
+        cache_ring_disabled=MagickTrue;
+      ring_info->file=(-1);
+      RelinquishMagickResource(FileResource,1);
+      return(DestroyCacheRingInfo(ring_info));
+    }
+  ring_info->sq_extent=parameters->sq_off.array+parameters->sq_entries*
+    sizeof(unsigned int);
+  ring_info->cq_extent=parameters->cq_off.cqes+parameters->cq_entries*
+    sizeof(struct io_uring_cqe);
+  if ((parameters->features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+      ring_info->sq_extent=MagickMax(ring_info->sq_extent,ring_info->cq_extent);
+      ring_info->cq_extent=ring_info->sq_extent;
+    }
+  map=mmap((void *) NULL,ring_info->sq_extent,PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE,ring_info->file,IORING_OFF_SQ_RING);
+  if (map == MAP_FAILED)
+    return(DestroyCacheRingInfo(ring_info));
+  ring_info->sq_ring=(unsigned char *) map;
+  ring_info->cq_ring=ring_info->sq_ring;
+  if ((parameters->features & IORING_FEAT_SINGLE_MMAP) == 0)
+    {
+      map=mmap((void *) NULL,ring_info->cq_extent,PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,ring_info->file,IORING_OFF_CQ_RING);
+      if (map == MAP_FAILED)
+        {
+          ring_info->cq_ring=(unsigned char *) NULL;
+          return(DestroyCacheRingInfo(ring_info));
+        }
+      ring_info->cq_ring=(unsigned char *) map;
+    }
+  ring_info->sqes_extent=parameters->sq_entries*sizeof(struct io_uring_sqe);
+  map=mmap((void *) NULL,ring_info->sqes_extent,PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE,ring_info->file,IORING_OFF_SQES);
+  if (map == MAP_FAILED)
+    return(DestroyCacheRingInfo(ring_info));
+  ring_info->sqes=(struct io_uring_sqe *) map;
+  return(ring_info);
+}
+
+static int ReapCacheRingRows(CacheRingInfo *ring_info,const size_t number_rows,
+  const size_t length,MagickBooleanType *status)
+{
+  int
+    count;
+
+  size_t
+    j;
+
+  struct io_uring_params
+    *parameters;
+
+  unsigned int
+    *cq_head,
+    cq_mask,
+    *cq_tail,
+    head;
+
+  /*
+    Consume the completions of the submitted requests.
+  */
+  parameters=(&ring_info->parameters);
+  cq_head=(unsigned int *) (ring_info->cq_ring+parameters->cq_off.head);
+  cq_tail=(unsigned int *) (ring_info->cq_ring+parameters->cq_off.tail);
+  cq_mask=(*(unsigned int *) (ring_info->cq_ring+parameters->cq_off.ring_mask));
+  head=(*cq_head);
+  for (j=0; j < number_rows; )
+  {
+    struct io_uring_cqe
+      *cqe;
+
+    if (head == __atomic_load_n(cq_tail,__ATOMIC_ACQUIRE))
+      {
+        do
+        {
+          count=(int) syscall(__NR_io_uring_enter,ring_info->file,0U,1U,
+            IORING_ENTER_GETEVENTS,(void *) NULL,0);
+        } while ((count < 0) && (errno == EINTR));
+        if (count < 0)
+          {
+            __atomic_store_n(cq_head,head,__ATOMIC_RELEASE);
+            return(-1);
+          }
+        continue;
+      }
+    cqe=(struct io_uring_cqe *) (ring_info->cq_ring+parameters->cq_off.cqes)+
+      (head & cq_mask);
+    if (cqe->res != (int) length)
+      *status=MagickFalse;
+    head++;
+    j++;
+  }
+  __atomic_store_n(cq_head,head,__ATOMIC_RELEASE);
+  return(0);
+}
+
+static ssize_t ReadCacheRingRows(CacheRingInfo *ring_info,const int file,
+  const MagickOffsetType offset,const MagickOffsetType stride,
+  const size_t length,const size_t rows,unsigned char *magick_restrict buffer)
+{
+  MagickBooleanType
+    status;
+
+  size_t
+    i,
+    number_rows;
+
+  struct io_uring_params
+    *parameters;
+
+  unsigned int
+    *sq_array,
+    sq_mask,
+    *sq_tail,
+    tail;
+
+  parameters=(&ring_info->parameters);
+  sq_tail=(unsigned int *) (ring_info->sq_ring+parameters->sq_off.tail);
+  sq_mask=(*(unsigned int *) (ring_info->sq_ring+parameters->sq_off.ring_mask));
+  sq_array=(unsigned int *) (ring_info->sq_ring+parameters->sq_off.array);
+  status=MagickTrue;
+  for (i=0; i < rows; i+=number_rows)
+  {
+    int
+      count;
+
+    size_t
+      j;
+
+    /*
+      Queue one request per row, then wait for all of them to complete.
+    */
+    number_rows=MagickMin(rows-i,(size_t) MagickMin(CacheRingEntries,
+      parameters->sq_entries));
+    tail=(*sq_tail);
+    for (j=0; j < number_rows; j++)
+    {
+      struct io_uring_sqe
+        *sqe;
+
+      unsigned int
+        index;
+
+      index=(tail+(unsigned int) j) & sq_mask;
+      sqe=ring_info->sqes+index;
+      (void) memset(sqe,0,sizeof(*sqe));
+      sqe->opcode=IORING_OP_READV;
+      sqe->fd=file;
+      sqe->off=(unsigned long long) (offset+(MagickOffsetType) (i+j)*stride);
+      ring_info->iovecs[j].iov_base=buffer+(i+j)*length;
+      ring_info->iovecs[j].iov_len=length;
+      sqe->addr=(unsigned long long) (size_t) (ring_info->iovecs+j);
+      sqe->len=1;
+      sqe->user_data=(unsigned long long) j;
+      sq_array[index]=index;
+    }
+    __atomic_store_n(sq_tail,tail+(unsigned int) number_rows,__ATOMIC_RELEASE);
+    do
+    {
+      count=(int) syscall(__NR_io_uring_enter,ring_info->file,(unsigned int)
+        number_rows,(unsigned int) number_rows,IORING_ENTER_GETEVENTS,
+        (void *) NULL,0);
+    } while ((count < 0) && (errno == EINTR));
+    if (count != (int) number_rows)
+      {
+        int
+          error;
+
+        /*
+          Wait for the requests that were submitted so none of them writes to
+          the buffer once the caller has retired the ring.
+        */
+        error=count < 0 ? errno : EAGAIN;
+        if (count > 0)
+          (void) ReapCacheRingRows(ring_info,(size_t) count,length,&status);
+        errno=error;
+        return(-1);
+      }
+    if (ReapCacheRingRows(ring_info,number_rows,length,&status) < 0)
+      return(-1);
+    if (status == MagickFalse)
+      return(0);
+  }
+  return((ssize_t) rows);
+}
+#endif
+
+static MagickBooleanType ReadPixelCacheRows(CacheInfo *cache_info,
+  const MagickOffsetType offset,const MagickOffsetType stride,
+  const MagickSizeType length,const size_t rows,
+  unsigned char *magick_restrict buffer)
+{
+#if defined(CacheRingSupport)
+  ssize_t
+    count;
+
+  /*
+    Read rows at a fixed stride in the cache file with an io_uring batch.  On
+    failure, the caller reads the rows one at a time instead.
+  */
+  if ((rows < 2) || (cache_info->tier_info != (void *) NULL) ||
+      (length != (MagickSizeType) ((unsigned int) length)) ||
+      (cache_ring_disabled != MagickFalse))
+    return(MagickFalse);
+  if (cache_info->ring_info == (void *) NULL)
+    {
+      cache_info->ring_info=(void *) AcquireCacheRingInfo();
+      if (cache_info->ring_info == (void *) NULL)
+        return(MagickFalse);
+    }
+  count=ReadCacheRingRows((CacheRingInfo *) cache_info->ring_info,
+    cache_info->file,offset,stride,(size_t) length,rows,buffer);
+  if (count < 0)
+    {
+      /*
+        The ring is no longer in a known state: retire it, and stop using
+        io_uring altogether only if the kernel refuses it.
+      */
+      if ((errno == ENOSYS) || (errno == EPERM))
+        cache_ring_disabled=MagickTrue;
+      cache_info->ring_info=(void *) DestroyCacheRingInfo((CacheRingInfo *)
+        cache_info->ring_info);
+    }
+  return(count == (ssize_t) rows ? MagickTrue : MagickFalse);
+#else
+  magick_unreferenced(cache_info);
+  magick_unreferenced(offset);
+  magick_unreferenced(stride);
+  magick_unreferenced(length);
+  magick_unreferenced(rows);
+  magick_unreferenced(buffer);
+  return(MagickFalse);
+#endif
+}
+
 static MagickBooleanType ClosePixelCacheOnDisk(CacheInfo *cache_info)
 {
   int
@@ -1040,6 +1486,12 @@ static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
     case MemoryCache:
     {
       (void) ShredMagickMemory(cache_info->pixels,(size_t) cache_info->length);
+      if (cache_info->shared_file != -1)
+        {
+          (void) close(cache_info->shared_file);
+          cache_info->shared_file=(-1);
+          RelinquishMagickResource(FileResource,1);
+        }
 #if defined(MAGICKCORE_OPENCL_SUPPORT)
       if (cache_info->opencl != (MagickCLCacheInfo) NULL)
         {
@@ -1049,6 +1501,12 @@ static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
           break;
         }
 #endif
+      if (cache_info->shared_pixels != (Quantum *) NULL)
+        {
+          (void) UnmapBlob(cache_info->shared_pixels,(size_t)
+            cache_info->length);
+          cache_info->shared_pixels=(Quantum *) NULL;
+        }
       if (cache_info->mapped == MagickFalse)
         cache_info->pixels=(Quantum *) RelinquishAlignedMemory(
           cache_info->pixels);
@@ -1072,6 +1530,7 @@ static inline void RelinquishPixelCachePixels(CacheInfo *cache_info)
     }
     case DiskCache:
     {
+      DestroyPixelCacheTier(cache_info);
       if (cache_info->file != -1)
         (void) ClosePixelCacheOnDisk(cache_info);
       if ((cache_info->mode != ReadMode) && (cache_info->mode != PersistMode))
@@ -1132,6 +1591,11 @@ MagickPrivate Cache DestroyPixelCache(Cache cache)
       cache_info->number_threads);
   if (cache_info->random_info != (RandomInfo *) NULL)
     cache_info->random_info=DestroyRandomInfo(cache_info->random_info);
+#if defined(CacheRingSupport)
+  if (cache_info->ring_info != (void *) NULL)
+    cache_info->ring_info=(void *) DestroyCacheRingInfo((CacheRingInfo *)
+      cache_info->ring_info);
+#endif
   if (cache_info->file_semaphore != (SemaphoreInfo *) NULL)
     RelinquishSemaphoreInfo(&cache_info->file_semaphore);
   if (cache_info->semaphore != (SemaphoreInfo *) NULL)
@@ -1230,7 +1694,7 @@ MagickExport void *GetAuthenticMetacontent(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -1281,7 +1745,7 @@ static void *GetAuthenticMetacontentFromCache(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -1452,7 +1916,7 @@ static Quantum *GetAuthenticPixelsFromCache(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -1493,7 +1957,7 @@ MagickExport Quantum *GetAuthenticPixelQueue(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -1560,7 +2024,7 @@ MagickExport Quantum *GetAuthenticPixels(Image *image,const ssize_t x,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *pixels;
@@ -1622,7 +2086,7 @@ static Quantum *GetAuthenticPixelsCache(Image *image,const ssize_t x,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict pixels;
@@ -1669,7 +2133,7 @@ MagickExport MagickSizeType GetImageExtent(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -2032,7 +2496,7 @@ static MagickBooleanType GetOneAuthenticPixelFromCache(Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict q;
@@ -2087,7 +2551,7 @@ MagickExport MagickBooleanType GetOneVirtualPixel(const Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *p;
@@ -2150,7 +2614,7 @@ static MagickBooleanType GetOneVirtualPixelFromCache(const Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *p;
@@ -2209,7 +2673,7 @@ MagickExport MagickBooleanType GetOneVirtualPixelInfo(const Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict p;
@@ -2581,7 +3045,7 @@ static const void *GetVirtualMetacontentFromCache(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const void
     *magick_restrict metacontent;
@@ -2667,7 +3131,7 @@ MagickExport const void *GetVirtualMetacontent(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const void
     *magick_restrict metacontent;
@@ -3253,7 +3717,7 @@ static const Quantum *GetVirtualPixelCache(const Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict p;
@@ -3298,7 +3762,7 @@ MagickExport const Quantum *GetVirtualPixelQueue(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -3367,7 +3831,7 @@ MagickExport const Quantum *GetVirtualPixels(const Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   const Quantum
     *magick_restrict p;
@@ -3416,7 +3880,7 @@ static const Quantum *GetVirtualPixelsCache(const Image *image)
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -3595,12 +4059,94 @@ static MagickBooleanType MaskPixelCacheNexus(Image *image,NexusInfo *nexus_info,
 %
 %    o image: the image.
 %
-%    o mode: ReadMode, WriteMode, or IOMode.
+%    o mode: ReadMode, WriteMode, IOMode, or PersistMode.  PersistMode maps an
+%      existing persistent cache file copy-on-write.
 %
 %    o exception: return any errors or warnings in this structure.
 %
 */
 
+static Quantum *AcquireSharedCachePixels(CacheInfo *cache_info)
+{
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MFD_CLOEXEC)
+  int
+    file;
+
+  Quantum
+    *pixels;
+
+  /*
+    Back a large memory cache with an anonymous file so its pixels can later
+    be shared copy-on-write with a clone rather than copied.  The descriptor is
+    only taken while at most half the file limit is in use; otherwise the
+    cache uses anonymous memory and disk caches keep their descriptors.  The
+    cache:shared-memory policy turns this off.
+  */
+  if ((cache_shared_memory <= 0) ||
+      (cache_info->length < CacheSharedExtent) ||
+      (cache_info->length != (MagickSizeType) ((off_t) cache_info->length)) ||
+      (GetMagickResource(FileResource) >=
+       (GetMagickResourceLimit(FileResource)/2)))
+    return((Quantum *) NULL);
+  if (AcquireMagickResource(FileResource,1) == MagickFalse)
+    {
+      RelinquishMagickResource(FileResource,1);
+      return((Quantum *) NULL);
+    }
+  file=memfd_create("magick-pixel-cache",MFD_CLOEXEC);
+  if (file == -1)
+    {
+      RelinquishMagickResource(FileResource,1);
+      return((Quantum *) NULL);
+    }
+  pixels=(Quantum *) NULL;
+  if (ftruncate(file,(off_t) cache_info->length) == 0)
+    pixels=(Quantum *) MapBlob(file,IOMode,0,(size_t) cache_info->length);
+  if (pixels == (Quantum *) NULL)
+    {
+      (void) close(file);
+      RelinquishMagickResource(FileResource,1);
+      return((Quantum *) NULL);
+    }
+  cache_info->mapped=MagickTrue;
+  cache_info->shared_file=file;
+  return(pixels);
+#else
+  magick_unreferenced(cache_info);
+  return((Quantum *) NULL);
+#endif
+}
+
+static void TouchPixelCachePixels(const Image *image,CacheInfo *cache_info)
+{
+  size_t
+    extent,
+    length;
+
+  ssize_t
+    y;
+
+  /*
+    Zero the pixels with the same static row partition the image operators
+    use, so each page is first touched, and placed, by the thread that will
+    later work on it.
+  */
+  length=cache_info->number_channels*cache_info->columns;
+  extent=cache_info->metacontent_extent*cache_info->columns;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static) \
+    magick_number_threads(image,image,cache_info->rows,1)
+#endif
+  for (y=0; y < (ssize_t) cache_info->rows; y++)
+  {
+    (void) memset(cache_info->pixels+(size_t) y*length,0,length*
+      sizeof(*cache_info->pixels));
+    if (extent != 0)
+      (void) memset((unsigned char *) cache_info->metacontent+(size_t) y*
+        extent,0,extent);
+  }
+}
+
 static inline MagickBooleanType CacheOverflowSanityCheckGetSize(
   const MagickSizeType count,const size_t quantum,MagickSizeType *const extent)
 {
@@ -3637,6 +4183,7 @@ static MagickBooleanType OpenPixelCacheOnDisk(CacheInfo *cache_info,
     switch (mode)
     {
       case ReadMode:
+      case PersistMode:
       {
         file=open_utf8(cache_info->cache_filename,O_RDONLY | O_BINARY,0);
         break;
@@ -3679,12 +4226,24 @@ static inline MagickOffsetType WritePixelCacheRegion(
   ssize_t
     count = 0;
 
+#if !defined(MAGICKCORE_HAVE_PWRITE)
   if (lseek(cache_info->file,offset,SEEK_SET) < 0)
     return((MagickOffsetType) -1);
+#endif
   for (i=0; i < (MagickOffsetType) length; i+=count)
   {
+#if !defined(MAGICKCORE_HAVE_PWRITE)
     count=MagickWrite(cache_info->file,buffer+i,(size_t) MagickMin(length-
       (MagickSizeType) i,MagickMaxBufferExtent));
+#else
+    count=pwrite(cache_info->file,buffer+i,(size_t) MagickMin(length-
+      (MagickSizeType) i,MagickMaxBufferExtent),(off_t) (offset+i));
+    if ((count < 0) && (errno == EINTR))
+      {
+        count=0;
+        continue;
+      }
+#endif
     if (count <= 0)
       break;
   }
@@ -3795,6 +4354,34 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
         }
       value=DestroyString(value);
     }
+  if (cache_first_touch < 0)
+    {
+      char
+        *value;
+
+      /*
+        Does the policy ask for NUMA-friendly first-touch initialization?
+      */
+      cache_first_touch=0;
+      value=GetPolicyValue("cache:first-touch");
+      if (IsStringTrue(value) != MagickFalse)
+        cache_first_touch=1;
+      value=DestroyString(value);
+    }
+  if (cache_shared_memory < 0)
+    {
+      char
+        *value;
+
+      /*
+        May large memory caches be backed by an anonymous file and shared?
+      */
+      cache_shared_memory=1;
+      value=GetPolicyValue("cache:shared-memory");
+      if (IsStringFalse(value) != MagickFalse)
+        cache_shared_memory=0;
+      value=DestroyString(value);
+    }
   if ((image->columns == 0) || (image->rows == 0))
     ThrowBinaryException(CacheError,"NoPixelsDefinedInCache",image->filename);
   cache_info=(CacheInfo *) image->cache;
@@ -3815,8 +4402,23 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
         ThrowBinaryException(ResourceLimitError,"ListLengthExceedsLimit",
           image->filename);
     }
+  if (cache_info->tier_info != (void *) NULL)
+    {
+      /*
+        The source pixels must be in the backing file before it is reopened.
+      */
+      status=SyncPixelCacheTier(cache_info);
+      DestroyPixelCacheTier(cache_info);
+      if (status == MagickFalse)
+        ThrowBinaryException(CacheError,"UnableToWritePixelCache",
+          image->filename);
+    }
   source_info=(*cache_info);
   source_info.file=(-1);
+  if (mode == PersistMode)
+    source_info.storage_class=UndefinedClass;  /* attach, never copy */
+  cache_info->shared_file=(-1);
+  cache_info->shared_pixels=(Quantum *) NULL;
   (void) FormatLocaleString(cache_info->filename,MagickPathExtent,"%s[%.17g]",
     image->filename,(double) image->scene);
   cache_info->storage_class=image->storage_class;
@@ -3877,8 +4479,10 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
           if (cache_anonymous_memory <= 0)
             {
               cache_info->mapped=MagickFalse;
-              cache_info->pixels=(Quantum *) MagickAssumeAligned(
-                AcquireAlignedMemory(1,(size_t) cache_info->length));
+              cache_info->pixels=AcquireSharedCachePixels(cache_info);
+              if (cache_info->pixels == (Quantum *) NULL)
+                cache_info->pixels=(Quantum *) MagickAssumeAligned(
+                  AcquireAlignedMemory(1,(size_t) cache_info->length));
             }
           else
             {
@@ -3902,6 +4506,11 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
               if (cache_info->metacontent_extent != 0)
                 cache_info->metacontent=(void *) (cache_info->pixels+
                   cache_info->number_channels*number_pixels);
+              if (cache_info->mapped != MagickFalse)
+                AdviseHugePageMemory(cache_info->pixels,(size_t)
+                  cache_info->length);
+              if (cache_first_touch > 0)
+                TouchPixelCachePixels(image,cache_info);
               if ((source_info.storage_class != UndefinedClass) &&
                   (mode != ReadMode))
                 {
@@ -4055,9 +4664,12 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
       return(MagickFalse);
     }
   cache_info->type=DiskCache;
+  if ((cache_info->mode != ReadMode) && (cache_info->mode != PersistMode))
+    (void) AcquirePixelCacheTier(cache_info);
   length=number_pixels*(cache_info->number_channels*sizeof(Quantum)+
     cache_info->metacontent_extent);
-  if (length == (MagickSizeType) ((size_t) length))
+  if ((length == (MagickSizeType) ((size_t) length)) &&
+      (cache_info->tier_info == (void *) NULL))
     {
       status=AcquireMagickResource(MapResource,cache_info->length);
       if (status != MagickFalse)
@@ -4116,6 +4728,8 @@ static MagickBooleanType OpenPixelCache(Image *image,const MapMode mode,
             }
         }
     }
+  if (cache_info->mode == PersistMode)
+    cache_info->mode=ReadMode;  /* unmapped persistent cache is read-only */
   status=MagickTrue;
   if ((source_info.storage_class != UndefinedClass) && (mode != ReadMode))
     {
@@ -4210,7 +4824,8 @@ MagickExport MagickBooleanType PersistPixelCache(Image *image,
   if (attach != MagickFalse)
     {
       /*
-        Attach existing persistent pixel cache.
+        Attach existing persistent pixel cache: map it copy-on-write so
+        readers share its pages and writers never clone it.
       */
       if (cache_info->debug != MagickFalse)
         (void) LogMagickEvent(CacheEvent,GetMagickModule(),
@@ -4219,7 +4834,7 @@ MagickExport MagickBooleanType PersistPixelCache(Image *image,
         MagickPathExtent);
       cache_info->type=MapCache;
       cache_info->offset=(*offset);
-      if (OpenPixelCache(image,ReadMode,exception) == MagickFalse)
+      if (OpenPixelCache(image,PersistMode,exception) == MagickFalse)
         return(MagickFalse);
       *offset=(*offset+(MagickOffsetType) cache_info->length+page_size-
         ((MagickOffsetType) cache_info->length % page_size));
@@ -4402,7 +5017,7 @@ static Quantum *QueueAuthenticPixelsCache(Image *image,const ssize_t x,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict pixels;
@@ -4482,7 +5097,7 @@ MagickExport Quantum *QueueAuthenticPixels(Image *image,const ssize_t x,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   Quantum
     *magick_restrict pixels;
@@ -4544,18 +5159,541 @@ static inline MagickOffsetType ReadPixelCacheRegion(
   ssize_t
     count = 0;
 
+#if !defined(MAGICKCORE_HAVE_PREAD)
   if (lseek(cache_info->file,offset,SEEK_SET) < 0)
     return((MagickOffsetType) -1);
+#endif
   for (i=0; i < (MagickOffsetType) length; i+=count)
   {
+#if !defined(MAGICKCORE_HAVE_PREAD)
     count=MagickRead(cache_info->file,buffer+i,(size_t) MagickMin(length-
       (MagickSizeType) i,(size_t) MagickMaxBufferExtent));
+#else
+    count=pread(cache_info->file,buffer+i,(size_t) MagickMin(length-
+      (MagickSizeType) i,(size_t) MagickMaxBufferExtent),(off_t) (offset+i));
+    if ((count < 0) && (errno == EINTR))
+      {
+        count=0;
+        continue;
+      }
+#endif
     if (count <= 0)
       break;
   }
   return(i);
 }
 
+/*
+  When the cache:compressed-memory policy is set, a disk cache is fronted by a
+  block tier: recently used blocks stay uncompressed in memory, evicted blocks
+  are compressed in memory up to the policy limit, and only then are they
+  written to the backing file.  All tier accesses are serialized by the file
+  semaphore.  Resident and compressed blocks of every tier in the process share
+  one budget each and are charged to the memory resource; when either is
+  denied, the tier reads and writes the backing file directly.
+*/
+
+static MagickBooleanType AcquireCacheTierExtent(const MagickSizeType extent,
+  const MagickSizeType limit,MagickSizeType *magick_restrict total)
+{
+  MagickBooleanType
+    status;
+
+  if (cache_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&cache_semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  status=MagickFalse;
+  if (((*total+extent) <= limit) &&
+      (AcquireMagickResource(MemoryResource,extent) != MagickFalse))
+    {
+      *total+=extent;
+      status=MagickTrue;
+    }
+  UnlockSemaphoreInfo(cache_semaphore);
+  return(status);
+}
+
+static void RelinquishCacheTierExtent(const MagickSizeType extent,
+  MagickSizeType *magick_restrict total)
+{
+  if (cache_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&cache_semaphore);
+  LockSemaphoreInfo(cache_semaphore);
+  *total-=extent;
+  RelinquishMagickResource(MemoryResource,extent);
+  UnlockSemaphoreInfo(cache_semaphore);
+}
+
+static inline size_t GetPixelCacheBlockExtent(
+  const CacheInfo *magick_restrict cache_info,const size_t index)
+{
+  MagickSizeType
+    offset;
+
+  offset=(MagickSizeType) index*CacheTierBlockExtent;
+  return((size_t) MagickMin(cache_info->length-offset,CacheTierBlockExtent));
+}
+
+static void RelinquishPixelCacheBlock(CacheBlockInfo *block,
+  const size_t extent)
+{
+  if (block->pixels != (unsigned char *) NULL)
+    {
+      block->pixels=(unsigned char *) RelinquishMagickMemory(block->pixels);
+      RelinquishCacheTierExtent(extent,&cache_tier_resident);
+    }
+  if (block->blob != (unsigned char *) NULL)
+    {
+      block->blob=(unsigned char *) RelinquishMagickMemory(block->blob);
+      RelinquishCacheTierExtent(block->length,&cache_tier_compressed);
+    }
+  block->length=0;
+  block->dirty=MagickFalse;
+}
+
+static MagickBooleanType AcquirePixelCacheTier(CacheInfo *cache_info)
+{
+  CacheTierInfo
+    *tier_info;
+
+  char
+    *value;
+
+  MagickSizeType
+    limit;
+
+  value=GetPolicyValue("cache:compressed-memory");
+  if (value == (char *) NULL)
+    return(MagickFalse);
+  limit=StringToMagickSizeType(value,100.0);
+  value=DestroyString(value);
+  if ((limit == 0) || (cache_info->length == 0))
+    return(MagickFalse);
+  tier_info=(CacheTierInfo *) AcquireMagickMemory(sizeof(*tier_info));
+  if (tier_info == (CacheTierInfo *) NULL)
+    return(MagickFalse);
+  (void) memset(tier_info,0,sizeof(*tier_info));
+  tier_info->limit=limit;
+  tier_info->number_blocks=(size_t) ((cache_info->length+CacheTierBlockExtent-
+    1)/CacheTierBlockExtent);
+  tier_info->max_resident=MagickMin(MagickMax(CacheTierResidentExtent/
+    CacheTierBlockExtent,4*cache_info->number_threads),
+    tier_info->number_blocks);
+  tier_info->blocks=(CacheBlockInfo *) AcquireQuantumMemory(
+    tier_info->number_blocks,sizeof(*tier_info->blocks));
+  tier_info->resident=(size_t *) AcquireQuantumMemory(tier_info->max_resident,
+    sizeof(*tier_info->resident));
+  if ((tier_info->blocks == (CacheBlockInfo *) NULL) ||
+      (tier_info->resident == (size_t *) NULL))
+    {
+      if (tier_info->resident != (size_t *) NULL)
+        tier_info->resident=(size_t *) RelinquishMagickMemory(
+          tier_info->resident);
+      if (tier_info->blocks != (CacheBlockInfo *) NULL)
+        tier_info->blocks=(CacheBlockInfo *) RelinquishMagickMemory(
+          tier_info->blocks);
+      tier_info=(CacheTierInfo *) RelinquishMagickMemory(tier_info);
+      return(MagickFalse);
+    }
+  (void) memset(tier_info->blocks,0,tier_info->number_blocks*
+    sizeof(*tier_info->blocks));
+  cache_info->tier_info=(void *) tier_info;
+  return(MagickTrue);
+}
+
+static void DestroyPixelCacheTier(CacheInfo *cache_info)
+{
+  CacheTierInfo
+    *tier_info;
+
+  ssize_t
+    i;
+
+  tier_info=(CacheTierInfo *) cache_info->tier_info;
+  if (tier_info == (CacheTierInfo *) NULL)
+    return;
+  for (i=0; i < (ssize_t) tier_info->number_blocks; i++)
+    RelinquishPixelCacheBlock(tier_info->blocks+i,GetPixelCacheBlockExtent(
+      cache_info,(size_t) i));
+  tier_info->resident=(size_t *) RelinquishMagickMemory(tier_info->resident);
+  tier_info->blocks=(CacheBlockInfo *) RelinquishMagickMemory(
+    tier_info->blocks);
+  cache_info->tier_info=RelinquishMagickMemory(tier_info);
+}
+
+static MagickBooleanType CompressPixelCacheBlock(CacheTierInfo *tier_info,
+  CacheBlockInfo *block,const size_t extent)
+{
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  uLongf
+    length;
+
+  unsigned char
+    *blob;
+
+  length=compressBound((uLong) extent);
+  blob=(unsigned char *) AcquireQuantumMemory(length,sizeof(*blob));
+  if (blob == (unsigned char *) NULL)
+    return(MagickFalse);
+  if ((compress2(blob,&length,block->pixels,(uLong) extent,1) != Z_OK) ||
+      (length >= (uLongf) extent) ||
+      (AcquireCacheTierExtent(length,tier_info->limit,&cache_tier_compressed) ==
+       MagickFalse))
+    {
+      blob=(unsigned char *) RelinquishMagickMemory(blob);
+      return(MagickFalse);
+    }
+  block->blob=(unsigned char *) ResizeQuantumMemory(blob,length,sizeof(*blob));
+  if (block->blob == (unsigned char *) NULL)
+    block->blob=blob;
+  block->length=(size_t) length;
+  return(MagickTrue);
+#else
+  magick_unreferenced(tier_info);
+  magick_unreferenced(block);
+  magick_unreferenced(extent);
+  return(MagickFalse);
+#endif
+}
+
+static MagickBooleanType DecompressPixelCacheBlock(const CacheBlockInfo *block,
+  const size_t extent,unsigned char *pixels)
+{
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+  uLongf
+    length;
+
+  length=(uLongf) extent;
+  if ((uncompress(pixels,&length,block->blob,(uLong) block->length) != Z_OK) ||
+      (length != (uLongf) extent))
+    return(MagickFalse);
+  return(MagickTrue);
+#else
+  magick_unreferenced(block);
+  magick_unreferenced(extent);
+  magick_unreferenced(pixels);
+  return(MagickFalse);
+#endif
+}
+
+static MagickBooleanType EvictPixelCacheBlock(
+  const CacheInfo *magick_restrict cache_info,CacheTierInfo *tier_info)
+{
+  CacheBlockInfo
+    *block;
+
+  size_t
+    extent,
+    index;
+
+  /*
+    Evict a resident block that was not referenced since the clock hand last
+    passed it.
+  */
+  for ( ; ; )
+  {
+    if (tier_info->hand >= tier_info->number_resident)
+      tier_info->hand=0;
+    block=tier_info->blocks+tier_info->resident[tier_info->hand];
+    if (block->referenced == MagickFalse)
+      break;
+    block->referenced=MagickFalse;
+    tier_info->hand++;
+  }
+  index=tier_info->resident[tier_info->hand];
+  extent=GetPixelCacheBlockExtent(cache_info,index);
+  if ((block->dirty != MagickFalse) &&
+      (CompressPixelCacheBlock(tier_info,block,extent) == MagickFalse))
+    {
+      MagickOffsetType
+        count;
+
+      count=WritePixelCacheRegion(cache_info,cache_info->offset+
+        (MagickOffsetType) index*(MagickOffsetType) CacheTierBlockExtent,
+        extent,block->pixels);
+      if (count != (MagickOffsetType) extent)
+        return(MagickFalse);
+    }
+  block->pixels=(unsigned char *) RelinquishMagickMemory(block->pixels);
+  RelinquishCacheTierExtent(extent,&cache_tier_resident);
+  block->dirty=MagickFalse;
+  tier_info->number_resident--;
+  tier_info->resident[tier_info->hand]=
+    tier_info->resident[tier_info->number_resident];
+  return(MagickTrue);
+}
+
+static CacheBlockInfo *GetPixelCacheBlock(
+  const CacheInfo *magick_restrict cache_info,const size_t index,
+  const MagickBooleanType load)
+{
+  CacheBlockInfo
+    *block;
+
+  CacheTierInfo
+    *tier_info;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    extent;
+
+  tier_info=(CacheTierInfo *) cache_info->tier_info;
+  block=tier_info->blocks+index;
+  if (block->pixels != (unsigned char *) NULL)
+    {
+      block->referenced=MagickTrue;
+      return(block);
+    }
+  if ((tier_info->number_resident >= tier_info->max_resident) &&
+      (EvictPixelCacheBlock(cache_info,tier_info) == MagickFalse))
+    return((CacheBlockInfo *) NULL);
+  extent=GetPixelCacheBlockExtent(cache_info,index);
+  while (AcquireCacheTierExtent(extent,CacheTierResidentExtent,
+         &cache_tier_resident) == MagickFalse)
+  {
+    /*
+      The shared budget is spent: give up one of our own blocks, if any.
+    */
+    if ((tier_info->number_resident == 0) ||
+        (EvictPixelCacheBlock(cache_info,tier_info) == MagickFalse))
+      return((CacheBlockInfo *) NULL);
+  }
+  block->pixels=(unsigned char *) AcquireQuantumMemory(extent,
+    sizeof(*block->pixels));
+  if (block->pixels == (unsigned char *) NULL)
+    {
+      RelinquishCacheTierExtent(extent,&cache_tier_resident);
+      return((CacheBlockInfo *) NULL);
+    }
+  status=MagickTrue;
+  if (load != MagickFalse)
+    {
+      if (block->blob != (unsigned char *) NULL)
+        status=DecompressPixelCacheBlock(block,extent,block->pixels);
+      else
+        if (ReadPixelCacheRegion(cache_info,cache_info->offset+
+            (MagickOffsetType) index*(MagickOffsetType) CacheTierBlockExtent,
+            extent,block->pixels) != (MagickOffsetType) extent)
+          status=MagickFalse;
+    }
+  if (status == MagickFalse)
+    {
+      block->pixels=(unsigned char *) RelinquishMagickMemory(block->pixels);
+      RelinquishCacheTierExtent(extent,&cache_tier_resident);
+      return((CacheBlockInfo *) NULL);
+    }
+  block->referenced=MagickTrue;
+  tier_info->resident[tier_info->number_resident++]=index;
+  return(block);
+}
+
+static MagickBooleanType SpillPixelCacheBlock(
+  const CacheInfo *magick_restrict cache_info,const size_t index)
+{
+  CacheBlockInfo
+    *block;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    extent;
+
+  unsigned char
+    *pixels;
+
+  /*
+    Move a compressed block to the backing file so it can be accessed there.
+  */
+  block=((CacheTierInfo *) cache_info->tier_info)->blocks+index;
+  if (block->blob == (unsigned char *) NULL)
+    return(MagickTrue);
+  extent=GetPixelCacheBlockExtent(cache_info,index);
+  pixels=(unsigned char *) AcquireQuantumMemory(extent,sizeof(*pixels));
+  if (pixels == (unsigned char *) NULL)
+    return(MagickFalse);
+  status=DecompressPixelCacheBlock(block,extent,pixels);
+  if ((status != MagickFalse) && (WritePixelCacheRegion(cache_info,
+       cache_info->offset+(MagickOffsetType) index*(MagickOffsetType)
+       CacheTierBlockExtent,extent,pixels) != (MagickOffsetType) extent))
+    status=MagickFalse;
+  pixels=(unsigned char *) RelinquishMagickMemory(pixels);
+  if (status != MagickFalse)
+    RelinquishPixelCacheBlock(block,extent);
+  return(status);
+}
+
+static MagickOffsetType ReadPixelCacheTier(
+  const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
+  const MagickSizeType length,unsigned char *magick_restrict buffer)
+{
+  MagickSizeType
+    i,
+    position;
+
+  size_t
+    count = 0;
+
+  if ((cache_info->tier_info == (void *) NULL) ||
+      (offset < cache_info->offset) ||
+      (((MagickSizeType) (offset-cache_info->offset)+length) >
+       cache_info->length))
+    return(ReadPixelCacheRegion(cache_info,offset,length,buffer));
+  position=(MagickSizeType) (offset-cache_info->offset);
+  for (i=0; i < length; i+=count)
+  {
+    CacheBlockInfo
+      *block;
+
+    size_t
+      extent,
+      index,
+      start;
+
+    index=(size_t) ((position+i)/CacheTierBlockExtent);
+    start=(size_t) ((position+i) % CacheTierBlockExtent);
+    extent=GetPixelCacheBlockExtent(cache_info,index);
+    count=(size_t) MagickMin(length-i,(MagickSizeType) (extent-start));
+    block=GetPixelCacheBlock(cache_info,index,MagickTrue);
+    if (block == (CacheBlockInfo *) NULL)
+      {
+        if ((SpillPixelCacheBlock(cache_info,index) == MagickFalse) ||
+            (ReadPixelCacheRegion(cache_info,offset+(MagickOffsetType) i,count,
+             buffer+i) != (MagickOffsetType) count))
+          break;
+        continue;
+      }
+    (void) memcpy(buffer+i,block->pixels+start,count);
+  }
+  return((MagickOffsetType) i);
+}
+
+static MagickOffsetType WritePixelCacheTier(
+  const CacheInfo *magick_restrict cache_info,const MagickOffsetType offset,
+  const MagickSizeType length,const unsigned char *magick_restrict buffer)
+{
+  MagickSizeType
+    i,
+    position;
+
+  size_t
+    count = 0;
+
+  if ((cache_info->tier_info == (void *) NULL) ||
+      (offset < cache_info->offset) ||
+      (((MagickSizeType) (offset-cache_info->offset)+length) >
+       cache_info->length))
+    return(WritePixelCacheRegion(cache_info,offset,length,buffer));
+  position=(MagickSizeType) (offset-cache_info->offset);
+  for (i=0; i < length; i+=count)
+  {
+    CacheBlockInfo
+      *block;
+
+    size_t
+      extent,
+      index,
+      start;
+
+    index=(size_t) ((position+i)/CacheTierBlockExtent);
+    start=(size_t) ((position+i) % CacheTierBlockExtent);
+    extent=GetPixelCacheBlockExtent(cache_info,index);
+    count=(size_t) MagickMin(length-i,(MagickSizeType) (extent-start));
+    block=GetPixelCacheBlock(cache_info,index,count == extent ? MagickFalse :
+      MagickTrue);
+    if (block == (CacheBlockInfo *) NULL)
+      {
+        if ((SpillPixelCacheBlock(cache_info,index) == MagickFalse) ||
+            (WritePixelCacheRegion(cache_info,offset+(MagickOffsetType) i,count,
+             buffer+i) != (MagickOffsetType) count))
+          break;
+        continue;
+      }
+    (void) memcpy(block->pixels+start,buffer+i,count);
+    block->dirty=MagickTrue;
+    if (block->blob != (unsigned char *) NULL)
+      {
+        block->blob=(unsigned char *) RelinquishMagickMemory(block->blob);
+        RelinquishCacheTierExtent(block->length,&cache_tier_compressed);
+        block->length=0;
+      }
+  }
+  return((MagickOffsetType) i);
+}
+
+static MagickBooleanType SyncPixelCacheTier(CacheInfo *cache_info)
+{
+  CacheTierInfo
+    *tier_info;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    i;
+
+  unsigned char
+    *pixels;
+
+  /*
+    Write the tier back to the backing file and release its blocks.
+  */
+  tier_info=(CacheTierInfo *) cache_info->tier_info;
+  if (tier_info == (CacheTierInfo *) NULL)
+    return(MagickTrue);
+  pixels=(unsigned char *) NULL;
+  status=MagickTrue;
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  if (OpenPixelCacheOnDisk(cache_info,IOMode) == MagickFalse)
+    status=MagickFalse;
+  for (i=0; (status != MagickFalse) && (i < (ssize_t) tier_info->number_blocks);
+       i++)
+  {
+    CacheBlockInfo
+      *block;
+
+    size_t
+      extent;
+
+    block=tier_info->blocks+i;
+    extent=GetPixelCacheBlockExtent(cache_info,(size_t) i);
+    if ((block->pixels != (unsigned char *) NULL) &&
+        (block->dirty != MagickFalse))
+      status=WritePixelCacheRegion(cache_info,cache_info->offset+
+        (MagickOffsetType) i*(MagickOffsetType) CacheTierBlockExtent,extent,
+        block->pixels) == (MagickOffsetType) extent ? MagickTrue : MagickFalse;
+    else
+      if ((block->pixels == (unsigned char *) NULL) &&
+          (block->blob != (unsigned char *) NULL))
+        {
+          if (pixels == (unsigned char *) NULL)
+            pixels=(unsigned char *) AcquireQuantumMemory(CacheTierBlockExtent,
+              sizeof(*pixels));
+          status=pixels == (unsigned char *) NULL ? MagickFalse :
+            DecompressPixelCacheBlock(block,extent,pixels);
+          if (status != MagickFalse)
+            status=WritePixelCacheRegion(cache_info,cache_info->offset+
+              (MagickOffsetType) i*(MagickOffsetType) CacheTierBlockExtent,
+              extent,pixels) == (MagickOffsetType) extent ? MagickTrue :
+              MagickFalse;
+        }
+    if (status == MagickFalse)
+      break;
+    RelinquishPixelCacheBlock(block,extent);
+  }
+  if (pixels != (unsigned char *) NULL)
+    pixels=(unsigned char *) RelinquishMagickMemory(pixels);
+  tier_info->number_resident=0;
+  tier_info->hand=0;
+  for (i=0; i < (ssize_t) tier_info->number_blocks; i++)
+    if (tier_info->blocks[i].pixels != (unsigned char *) NULL)
+      tier_info->resident[tier_info->number_resident++]=(size_t) i;
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+  return(status);
+}
+
 static MagickBooleanType ReadPixelCacheMetacontent(
   CacheInfo *magick_restrict cache_info,NexusInfo *magick_restrict nexus_info,
   ExceptionInfo *exception)
@@ -4638,9 +5776,17 @@ static MagickBooleanType ReadPixelCacheMetacontent(
           rows=1UL;
         }
       extent=(MagickSizeType) cache_info->columns*cache_info->rows;
-      for (y=0; y < (ssize_t) rows; y++)
+      if (ReadPixelCacheRows(cache_info,cache_info->offset+
+            (MagickOffsetType) extent*(MagickOffsetType)
+            cache_info->number_channels*(MagickOffsetType) sizeof(Quantum)+
+            offset*(MagickOffsetType) cache_info->metacontent_extent,
+            (MagickOffsetType) cache_info->columns*(MagickOffsetType)
+            cache_info->metacontent_extent,length,rows,(unsigned char *) q) !=
+            MagickFalse)
+        y=(ssize_t) rows;
+      for ( ; y < (ssize_t) rows; y++)
       {
-        count=ReadPixelCacheRegion(cache_info,cache_info->offset+
+        count=ReadPixelCacheTier(cache_info,cache_info->offset+
           (MagickOffsetType) extent*(MagickOffsetType)
           cache_info->number_channels*(MagickOffsetType) sizeof(Quantum)+offset*
           (MagickOffsetType) cache_info->metacontent_extent,length,
@@ -4818,9 +5964,15 @@ static MagickBooleanType ReadPixelCachePixels(
           length=extent;
           rows=1UL;
         }
-      for (y=0; y < (ssize_t) rows; y++)
+      if (ReadPixelCacheRows(cache_info,cache_info->offset+offset*
+            (MagickOffsetType) cache_info->number_channels*(MagickOffsetType)
+            sizeof(*q),(MagickOffsetType) cache_info->columns*
+            (MagickOffsetType) cache_info->number_channels*(MagickOffsetType)
+            sizeof(*q),length,rows,(unsigned char *) q) != MagickFalse)
+        y=(ssize_t) rows;
+      for ( ; y < (ssize_t) rows; y++)
       {
-        count=ReadPixelCacheRegion(cache_info,cache_info->offset+offset*
+        count=ReadPixelCacheTier(cache_info,cache_info->offset+offset*
           (MagickOffsetType) cache_info->number_channels*(MagickOffsetType)
           sizeof(*q),length,(unsigned char *) q);
         if (count != (MagickOffsetType) length)
@@ -5195,6 +6347,118 @@ static inline MagickBooleanType AcquireCacheNexusPixels(
   return(MagickTrue);
 }
 
+static void AdvisePixelCacheRows(const CacheInfo *magick_restrict cache_info,
+  const ssize_t y,const size_t rows,const MagickBooleanType release)
+{
+  MagickSizeType
+    extent,
+    length,
+    offset;
+
+  size_t
+    page_size;
+
+  /*
+    Hint the kernel to read rows ahead of, or reclaim rows behind, a stream.
+  */
+  extent=(MagickSizeType) cache_info->columns*cache_info->number_channels*
+    sizeof(Quantum);
+  page_size=(size_t) GetMagickPageSize();
+  offset=(MagickSizeType) y*extent;
+  length=(MagickSizeType) rows*extent;
+  if (cache_info->type == MapCache)
+    {
+      unsigned char
+        *address;
+
+      address=(unsigned char *) cache_info->pixels+offset;
+      length+=(MagickSizeType) ((size_t) address % page_size);
+      address-=(size_t) address % page_size;
+      if (release == MagickFalse)
+        {
+#if defined(MAGICKCORE_HAVE_POSIX_MADVISE)
+          (void) posix_madvise(address,(size_t) length,POSIX_MADV_WILLNEED);
+#endif
+          return;
+        }
+#if defined(MAGICKCORE_HAVE_MMAP) && defined(MADV_COLD)
+      /*
+        Unlike MADV_DONTNEED, MADV_COLD is safe for private mappings: it only
+        makes the pages the first to be reclaimed.
+      */
+      (void) madvise(address,(size_t) length,MADV_COLD);
+#endif
+      return;
+    }
+#if defined(MAGICKCORE_HAVE_POSIX_FADVISE)
+  LockSemaphoreInfo(cache_info->file_semaphore);
+  if (cache_info->file != -1)
+    (void) posix_fadvise(cache_info->file,(off_t) (cache_info->offset+
+      (MagickOffsetType) offset),(off_t) length,release == MagickFalse ?
+      POSIX_FADV_WILLNEED : POSIX_FADV_DONTNEED);
+  UnlockSemaphoreInfo(cache_info->file_semaphore);
+#endif
+}
+
+static MagickSizeType GetPixelCachePhysicalMemory(void)
+{
+  if (cache_physical_memory == 0)
+    {
+      ssize_t
+        pages;
+
+      pages=(-1);
+#if defined(MAGICKCORE_HAVE_SYSCONF) && defined(_SC_PHYS_PAGES)
+      pages=(ssize_t) sysconf(_SC_PHYS_PAGES);
+#endif
+      cache_physical_memory=MagickResourceInfinity;
+      if (pages > 0)
+        cache_physical_memory=(MagickSizeType) pages*(MagickSizeType)
+          GetMagickPageSize();
+    }
+  return(cache_physical_memory);
+}
+
+static inline void ReadaheadPixelCacheNexus(
+  const CacheInfo *magick_restrict cache_info,
+  NexusInfo *magick_restrict nexus_info)
+{
+  size_t
+    rows;
+
+  ssize_t
+    y;
+
+  /*
+    Once a nexus walks a map or disk cache row strip by row strip, keep a
+    window of rows ahead of it resident.  A cache larger than physical memory
+    cannot stay resident anyway, so the rows it has left behind are released
+    for reclaim.
+  */
+  if (((cache_info->type != MapCache) && (cache_info->type != DiskCache)) ||
+      (cache_info->tier_info != (void *) NULL) || (nexus_info->sequential < 2))
+    return;
+  rows=(size_t) MagickMax(CacheReadaheadExtent/((MagickSizeType)
+    cache_info->columns*cache_info->number_channels*sizeof(Quantum)),1);
+  y=nexus_info->region.y+(ssize_t) nexus_info->region.height;
+  if (nexus_info->readahead_y < y)
+    nexus_info->readahead_y=y;
+  if (((size_t) (nexus_info->readahead_y-y) > (rows/2)) ||
+      (nexus_info->readahead_y >= (ssize_t) cache_info->rows))
+    return;
+  rows=MagickMin(rows,cache_info->rows-(size_t) nexus_info->readahead_y);
+  AdvisePixelCacheRows(cache_info,nexus_info->readahead_y,rows,MagickFalse);
+  nexus_info->readahead_y+=(ssize_t) rows;
+  y=nexus_info->region.y-(ssize_t) rows;
+  if ((y > nexus_info->release_y) &&
+      (cache_info->length > GetPixelCachePhysicalMemory()))
+    {
+      AdvisePixelCacheRows(cache_info,nexus_info->release_y,(size_t) (y-
+        nexus_info->release_y),MagickTrue);
+      nexus_info->release_y=y;
+    }
+}
+
 static inline void PrefetchPixelCacheNexusPixels(const NexusInfo *nexus_info,
   const MapMode mode)
 {
@@ -5227,6 +6491,19 @@ static Quantum *SetPixelCacheNexusPixels(
   if (cache_info->type == UndefinedCache)
     return((Quantum *) NULL);
   assert(nexus_info->signature == MagickCoreSignature);
+  if ((y > nexus_info->region.y) &&
+      (y <= (nexus_info->region.y+(ssize_t) nexus_info->region.height)))
+    nexus_info->sequential++;
+  else
+    if (y != nexus_info->region.y)
+      {
+        nexus_info->sequential=0;
+        if ((y < nexus_info->release_y) || (y > nexus_info->readahead_y))
+          {
+            nexus_info->readahead_y=y;
+            nexus_info->release_y=y;
+          }
+      }
   (void) memset(&nexus_info->region,0,sizeof(nexus_info->region));
   if ((width == 0) || (height == 0))
     {
@@ -5276,6 +6553,8 @@ static Quantum *SetPixelCacheNexusPixels(
           nexus_info->region.x=x;
           nexus_info->region.y=y;
           nexus_info->authentic_pixel_cache=MagickTrue;
+          if (mode == ReadMode)
+            ReadaheadPixelCacheNexus(cache_info,nexus_info);
           PrefetchPixelCacheNexusPixels(nexus_info,mode);
           return(nexus_info->pixels);
         }
@@ -5310,6 +6589,8 @@ static Quantum *SetPixelCacheNexusPixels(
   nexus_info->region.y=y;
   nexus_info->authentic_pixel_cache=cache_info->type == PingCache ?
     MagickTrue : MagickFalse;
+  if (mode == ReadMode)
+    ReadaheadPixelCacheNexus(cache_info,nexus_info);
   PrefetchPixelCacheNexusPixels(nexus_info,mode);
   return(nexus_info->pixels);
 }
@@ -5597,7 +6878,7 @@ static MagickBooleanType SyncAuthenticPixelsCache(Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   MagickBooleanType
     status;
@@ -5647,7 +6928,7 @@ MagickExport MagickBooleanType SyncAuthenticPixels(Image *image,
     *magick_restrict cache_info;
 
   const int
-    id = GetOpenMPThreadId();
+    id = GetMagickTaskThreadId();
 
   MagickBooleanType
     status;
@@ -5821,7 +7102,7 @@ static MagickBooleanType WritePixelCacheMetacontent(CacheInfo *cache_info,
       extent=(MagickSizeType) cache_info->columns*cache_info->rows;
       for (y=0; y < (ssize_t) rows; y++)
       {
-        count=WritePixelCacheRegion(cache_info,cache_info->offset+
+        count=WritePixelCacheTier(cache_info,cache_info->offset+
           (MagickOffsetType) extent*(MagickOffsetType)
           cache_info->number_channels*(MagickOffsetType) sizeof(Quantum)+offset*
           (MagickOffsetType) cache_info->metacontent_extent,length,
@@ -5993,7 +7274,7 @@ static MagickBooleanType WritePixelCachePixels(
         }
       for (y=0; y < (ssize_t) rows; y++)
       {
-        count=WritePixelCacheRegion(cache_info,cache_info->offset+offset*
+        count=WritePixelCacheTier(cache_info,cache_info->offset+offset*
           (MagickOffsetType) cache_info->number_channels*(MagickOffsetType)
           sizeof(*p),length,(const unsigned char *) p);
         if (count != (MagickOffsetType) length)
@@ -756,20 +756,12 @@ static inline void ConvertXYZToCAT02LMS(const double X,const double Y,
   *S=0.0030*X+0.0136*Y+0.9834*Z;
 }
 
-static inline void ConvertRGBToXYZ(const double red,const double green,
-  const double blue,double *X,double *Y,double *Z)
+static inline void ConvertLinearRGBToXYZ(const double r,const double g,
+  const double b,double *X,double *Y,double *Z)
 {
-  double
-    b,
-    g,
-    r;
-
   /*
-    Convert RGB to XYZ colorspace.
+    Convert normalized linear RGB to XYZ colorspace.
   */
-  r=QuantumScale*DecodePixelGamma(red);
-  g=QuantumScale*DecodePixelGamma(green);
-  b=QuantumScale*DecodePixelGamma(blue);
   *X=(0.4123955889674142161*r)+(0.3575834307637148171*g)+
     (0.1804926473817015735*b);
   *Y=(0.2125862307855955516*r)+(0.7151703037034108499*g)+
@@ -778,6 +770,16 @@ static inline void ConvertRGBToXYZ(const double red,const double green,
     (0.9504971251315797660*b);
 }
 
+static inline void ConvertRGBToXYZ(const double red,const double green,
+  const double blue,double *X,double *Y,double *Z)
+{
+  /*
+    Convert RGB to XYZ colorspace.
+  */
+  ConvertLinearRGBToXYZ(QuantumScale*DecodePixelGamma(red),QuantumScale*
+    DecodePixelGamma(green),QuantumScale*DecodePixelGamma(blue),X,Y,Z);
+}
+
 static inline void ConvertRGBToCAT02LMS(const double R,const double G,
   const double B,double *L,double *M,double *S)
 {
@@ -91,6 +91,46 @@ typedef struct _TransformPacket
 */
 static MagickBooleanType
   TransformsRGBImage(Image *,ExceptionInfo *);
+
+/*
+  Gamma maps tabulate DecodePixelGamma() or EncodePixelGamma() for each
+  integral quantum, so sRGB transforms of large images look up rather than
+  evaluate the power law.  Non-integral HDRI quanta still evaluate it.
+*/
+static MagickRealType *AcquireGammaMap(const Image *image,
+  MagickRealType (*gamma)(const MagickRealType))
+{
+  MagickRealType
+    *gamma_map;
+
+  ssize_t
+    i;
+
+  if (((double) MaxMap != (double) QuantumRange) ||
+      (((MagickSizeType) image->columns*image->rows) < (MagickSizeType) MaxMap))
+    return((MagickRealType *) NULL);
+  gamma_map=(MagickRealType *) AcquireQuantumMemory((size_t) MaxMap+1UL,
+    sizeof(*gamma_map));
+  if (gamma_map == (MagickRealType *) NULL)
+    return((MagickRealType *) NULL);
+  for (i=0; i <= (ssize_t) MaxMap; i++)
+    gamma_map[i]=gamma((MagickRealType) i);
+  return(gamma_map);
+}
+
+static inline MagickRealType MapPixelGamma(
+  const MagickRealType *magick_restrict gamma_map,const Quantum pixel,
+  MagickRealType (*gamma)(const MagickRealType))
+{
+  if (gamma_map == (const MagickRealType *) NULL)
+    return(gamma((MagickRealType) pixel));
+#if defined(MAGICKCORE_HDRI_SUPPORT)
+  if ((pixel < 0.0) || (pixel > (Quantum) MaxMap) ||
+      (pixel != (Quantum) ((size_t) pixel)))
+    return(gamma((MagickRealType) pixel));
+#endif
+  return(gamma_map[(size_t) pixel]);
+}
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -744,6 +784,9 @@ static MagickBooleanType sRGBTransformImage(Image *image,
   MagickOffsetType
     progress;
 
+  MagickRealType
+    *gamma_map;
+
   PrimaryInfo
     primary_info;
 
@@ -857,6 +900,7 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           if (SetImageStorageClass(image,DirectClass,exception) == MagickFalse)
             return(MagickFalse);
         }
+      gamma_map=AcquireGammaMap(image,DecodePixelGamma);
       image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
       #pragma omp parallel for schedule(static) shared(status) \
@@ -887,9 +931,10 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           MagickRealType
             gray;
 
-          gray=0.212656*DecodePixelGamma(GetPixelRed(image,q))+0.715158*
-            DecodePixelGamma(GetPixelGreen(image,q))+0.072186*
-            DecodePixelGamma(GetPixelBlue(image,q));
+          gray=0.212656*MapPixelGamma(gamma_map,GetPixelRed(image,q),
+            DecodePixelGamma)+0.715158*MapPixelGamma(gamma_map,
+            GetPixelGreen(image,q),DecodePixelGamma)+0.072186*
+            MapPixelGamma(gamma_map,GetPixelBlue(image,q),DecodePixelGamma);
           SetPixelGray(image,ClampToQuantum(gray),q);
           q+=(ptrdiff_t) GetPixelChannels(image);
         }
@@ -898,6 +943,8 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           status=MagickFalse;
       }
       image_view=DestroyCacheView(image_view);
+      if (gamma_map != (MagickRealType *) NULL)
+        gamma_map=(MagickRealType *) RelinquishMagickMemory(gamma_map);
       if (SetImageColorspace(image,colorspace,exception) == MagickFalse)
         return(MagickFalse);
       image->type=GrayscaleType;
@@ -1008,6 +1055,14 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           if (SetImageStorageClass(image,DirectClass,exception) == MagickFalse)
             return(MagickFalse);
         }
+      /*
+        Lab looks up the sRGB decode gamma and feeds linear RGB straight into
+        the XYZ matrix.  The reverse transform encodes non-integral linear
+        values, so it has no such table and stays on the generic path.
+      */
+      gamma_map=(MagickRealType *) NULL;
+      if (colorspace == LabColorspace)
+        gamma_map=AcquireGammaMap(image,DecodePixelGamma);
       image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
       #pragma omp parallel for schedule(static) shared(status) \
@@ -1040,9 +1095,19 @@ static MagickBooleanType sRGBTransformImage(Image *image,
             Y,
             Z;
 
-          ConvertRGBToGeneric(colorspace,(double) GetPixelRed(image,q),
-            (double) GetPixelGreen(image,q),(double) GetPixelBlue(image,q),
-            white_luminance,illuminant,&X,&Y,&Z);
+          if (gamma_map == (MagickRealType *) NULL)
+            ConvertRGBToGeneric(colorspace,(double) GetPixelRed(image,q),
+              (double) GetPixelGreen(image,q),(double) GetPixelBlue(image,q),
+              white_luminance,illuminant,&X,&Y,&Z);
+          else
+            {
+              ConvertLinearRGBToXYZ(QuantumScale*MapPixelGamma(gamma_map,
+                GetPixelRed(image,q),DecodePixelGamma),QuantumScale*
+                MapPixelGamma(gamma_map,GetPixelGreen(image,q),
+                DecodePixelGamma),QuantumScale*MapPixelGamma(gamma_map,
+                GetPixelBlue(image,q),DecodePixelGamma),&X,&Y,&Z);
+              ConvertXYZToLab(X,Y,Z,illuminant,&X,&Y,&Z);
+            }
           SetPixelRed(image,ClampToQuantum((double) QuantumRange*X),q);
           SetPixelGreen(image,ClampToQuantum((double) QuantumRange*Y),q);
           SetPixelBlue(image,ClampToQuantum((double) QuantumRange*Z),q);
@@ -1053,6 +1118,8 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           status=MagickFalse;
       }
       image_view=DestroyCacheView(image_view);
+      if (gamma_map != (MagickRealType *) NULL)
+        gamma_map=(MagickRealType *) RelinquishMagickMemory(gamma_map);
       if (SetImageColorspace(image,colorspace,exception) == MagickFalse)
         return(MagickFalse);
       return(status);
@@ -1179,6 +1246,7 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           if (SetImageStorageClass(image,DirectClass,exception) == MagickFalse)
             return(MagickFalse);
         }
+      gamma_map=AcquireGammaMap(image,DecodePixelGamma);
       image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
       #pragma omp parallel for schedule(static) shared(status) \
@@ -1211,9 +1279,10 @@ static MagickBooleanType sRGBTransformImage(Image *image,
             green,
             red;
 
-          red=DecodePixelGamma((MagickRealType) GetPixelRed(image,q));
-          green=DecodePixelGamma((MagickRealType) GetPixelGreen(image,q));
-          blue=DecodePixelGamma((MagickRealType) GetPixelBlue(image,q));
+          red=MapPixelGamma(gamma_map,GetPixelRed(image,q),DecodePixelGamma);
+          green=MapPixelGamma(gamma_map,GetPixelGreen(image,q),
+            DecodePixelGamma);
+          blue=MapPixelGamma(gamma_map,GetPixelBlue(image,q),DecodePixelGamma);
           SetPixelRed(image,ClampToQuantum(red),q);
           SetPixelGreen(image,ClampToQuantum(green),q);
           SetPixelBlue(image,ClampToQuantum(blue),q);
@@ -1224,6 +1293,8 @@ static MagickBooleanType sRGBTransformImage(Image *image,
           status=MagickFalse;
       }
       image_view=DestroyCacheView(image_view);
+      if (gamma_map != (MagickRealType *) NULL)
+        gamma_map=(MagickRealType *) RelinquishMagickMemory(gamma_map);
       if (SetImageColorspace(image,colorspace,exception) == MagickFalse)
         return(MagickFalse);
       return(status);
@@ -2082,6 +2153,9 @@ static MagickBooleanType TransformsRGBImage(Image *image,
   MagickOffsetType
     progress;
 
+  MagickRealType
+    *gamma_map;
+
   ssize_t
     i,
     y;
@@ -2187,6 +2261,7 @@ static MagickBooleanType TransformsRGBImage(Image *image,
         }
       if (SetImageColorspace(image,sRGBColorspace,exception) == MagickFalse)
         return(MagickFalse);
+      gamma_map=AcquireGammaMap(image,EncodePixelGamma);
       image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
       #pragma omp parallel for schedule(static) shared(status) \
@@ -2217,9 +2292,10 @@ static MagickBooleanType TransformsRGBImage(Image *image,
           MagickRealType
             gray;
 
-          gray=0.212656*EncodePixelGamma(GetPixelRed(image,q))+0.715158*
-            EncodePixelGamma(GetPixelGreen(image,q))+0.072186*
-            EncodePixelGamma(GetPixelBlue(image,q));
+          gray=0.212656*MapPixelGamma(gamma_map,GetPixelRed(image,q),
+            EncodePixelGamma)+0.715158*MapPixelGamma(gamma_map,
+            GetPixelGreen(image,q),EncodePixelGamma)+0.072186*
+            MapPixelGamma(gamma_map,GetPixelBlue(image,q),EncodePixelGamma);
           SetPixelRed(image,ClampToQuantum(gray),q);
           SetPixelGreen(image,ClampToQuantum(gray),q);
           SetPixelBlue(image,ClampToQuantum(gray),q);
@@ -2230,6 +2306,8 @@ static MagickBooleanType TransformsRGBImage(Image *image,
           status=MagickFalse;
       }
       image_view=DestroyCacheView(image_view);
+      if (gamma_map != (MagickRealType *) NULL)
+        gamma_map=(MagickRealType *) RelinquishMagickMemory(gamma_map);
       if (SetImageColorspace(image,sRGBColorspace,exception) == MagickFalse)
         return(MagickFalse);
       return(status);
@@ -2525,6 +2603,7 @@ static MagickBooleanType TransformsRGBImage(Image *image,
           if (SetImageStorageClass(image,DirectClass,exception) == MagickFalse)
             return(MagickFalse);
         }
+      gamma_map=AcquireGammaMap(image,EncodePixelGamma);
       image_view=AcquireAuthenticCacheView(image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
       #pragma omp parallel for schedule(static) shared(status) \
@@ -2557,9 +2636,10 @@ static MagickBooleanType TransformsRGBImage(Image *image,
             green,
             red;
 
-          red=EncodePixelGamma((MagickRealType) GetPixelRed(image,q));
-          green=EncodePixelGamma((MagickRealType) GetPixelGreen(image,q));
-          blue=EncodePixelGamma((MagickRealType) GetPixelBlue(image,q));
+          red=MapPixelGamma(gamma_map,GetPixelRed(image,q),EncodePixelGamma);
+          green=MapPixelGamma(gamma_map,GetPixelGreen(image,q),
+            EncodePixelGamma);
+          blue=MapPixelGamma(gamma_map,GetPixelBlue(image,q),EncodePixelGamma);
           SetPixelRed(image,ClampToQuantum(red),q);
           SetPixelGreen(image,ClampToQuantum(green),q);
           SetPixelBlue(image,ClampToQuantum(blue),q);
@@ -2570,6 +2650,8 @@ static MagickBooleanType TransformsRGBImage(Image *image,
           status=MagickFalse;
       }
       image_view=DestroyCacheView(image_view);
+      if (gamma_map != (MagickRealType *) NULL)
+        gamma_map=(MagickRealType *) RelinquishMagickMemory(gamma_map);
       if (SetImageColorspace(image,sRGBColorspace,exception) == MagickFalse)
         return(MagickFalse);
       return(status);
@@ -670,6 +670,31 @@ MagickExport Image *ReadImage(const ImageInfo *image_info,
             (GetMagickRawSupport(magick_info) != MagickFalse))
           read_info->endian=GetHostEndian();
     }
+  {
+    const char
+      *option;
+
+    option=GetImageOption(read_info,"decode:size");
+    if (option != (const char *) NULL)
+      {
+        GeometryInfo
+          geometry_info;
+
+        MagickStatusType
+          flags;
+
+        /*
+          Only pass an absolute size hint to decoders that honor it.
+        */
+        flags=ParseGeometry(option,&geometry_info);
+        if ((magick_info == (const MagickInfo *) NULL) ||
+            (GetMagickDecoderSizeHint(magick_info) == MagickFalse) ||
+            ((flags & (RhoValue | SigmaValue)) == 0) ||
+            ((flags & (PercentValue | AreaValue | AspectRatioValue |
+              LessValue)) != 0))
+          (void) DeleteImageOption(read_info,"decode:size");
+      }
+  }
   if ((magick_info != (const MagickInfo *) NULL) &&
       (GetMagickDecoderSeekableStream(magick_info) != MagickFalse))
     {
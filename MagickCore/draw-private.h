@@ -19,6 +19,7 @@
 #define MAGICKCORE_DRAW_PRIVATE_H
 
 #include "MagickCore/cache.h"
+#include "MagickCore/draw.h"
 #include "MagickCore/image.h"
 #include "MagickCore/memory_.h"
 
@@ -26,6 +27,13 @@
 extern "C" {
 #endif
 
+extern MagickPrivate MagickBooleanType
+  DrawComponentGenesis(void);
+
+extern MagickPrivate void
+  DrawComponentTerminus(void),
+  GetDrawPathStatistics(MagickSizeType *,MagickSizeType *);
+
 static inline void GetFillColor(const DrawInfo *draw_info,const ssize_t x,
   const ssize_t y,PixelInfo *fill,ExceptionInfo *exception)
 {
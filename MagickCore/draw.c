@@ -80,6 +80,7 @@
 #include "MagickCore/resample.h"
 #include "MagickCore/resample-private.h"
 #include "MagickCore/resource_.h"
+#include "MagickCore/semaphore.h"
 #include "MagickCore/splay-tree.h"
 #include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
@@ -95,6 +96,7 @@
 #define BezierQuantum  200
 #define PrimitiveExtentPad  4296.0
 #define MaxBezierCoordinates  67108864
+#define MaxTracedPathExtent  (32*1024*1024)
 #define ThrowPointExpectedException(token,exception) \
 { \
   (void) ThrowMagickException(exception,GetMagickModule(),DrawError, \
@@ -111,9 +113,6 @@ typedef struct _EdgeInfo
   SegmentInfo
     bounds;
 
-  double
-    scanline;
-
   PointInfo
     *points;
 
@@ -125,9 +124,6 @@ typedef struct _EdgeInfo
 
   MagickBooleanType
     ghostline;
-
-  size_t
-    highwater;
 } EdgeInfo;
 
 typedef struct _ElementInfo
@@ -184,6 +180,46 @@ typedef struct _PathInfo
   PathInfoCode
     code;
 } PathInfo;
+
+typedef struct _ScanlineInfo
+{
+  double
+    *fill_alpha,
+    scanline,
+    *stroke_alpha;
+
+  size_t
+    *active_edges,
+    *highwater,
+    next_edge,
+    number_active_edges;
+
+  ssize_t
+    *winding;
+} ScanlineInfo;
+
+typedef struct _TracedPathInfo
+{
+  PrimitiveInfo
+    *primitive_info;
+
+  size_t
+    coordinates;
+} TracedPathInfo;
+
+/*
+  Global declarations.
+*/
+static MagickSizeType
+  path_cache_extent = 0,
+  path_hits = 0,
+  path_misses = 0;
+
+static SemaphoreInfo
+  *path_semaphore = (SemaphoreInfo *) NULL;
+
+static SplayTreeInfo
+  *path_cache = (SplayTreeInfo *) NULL;
 
 /*
   Forward declarations.
@@ -575,8 +611,6 @@ static PolygonInfo *ConvertPathToPolygon(const PathInfo *path_info,
   (void) memset(&point,0,sizeof(point));
   (void) memset(&bounds,0,sizeof(bounds));
   polygon_info->edges[edge].number_points=(size_t) n;
-  polygon_info->edges[edge].scanline=0.0;
-  polygon_info->edges[edge].highwater=0;
   polygon_info->edges[edge].ghostline=ghostline;
   polygon_info->edges[edge].direction=(ssize_t) direction;
   polygon_info->edges[edge].points=points;
@@ -607,8 +641,6 @@ static PolygonInfo *ConvertPathToPolygon(const PathInfo *path_info,
                   }
               }
             polygon_info->edges[edge].number_points=(size_t) n;
-            polygon_info->edges[edge].scanline=(-1.0);
-            polygon_info->edges[edge].highwater=0;
             polygon_info->edges[edge].ghostline=ghostline;
             polygon_info->edges[edge].direction=(ssize_t) (direction > 0);
             if (direction < 0)
@@ -671,8 +703,6 @@ static PolygonInfo *ConvertPathToPolygon(const PathInfo *path_info,
               }
           }
         polygon_info->edges[edge].number_points=(size_t) n;
-        polygon_info->edges[edge].scanline=(-1.0);
-        polygon_info->edges[edge].highwater=0;
         polygon_info->edges[edge].ghostline=ghostline;
         polygon_info->edges[edge].direction=(ssize_t) (direction > 0);
         if (direction < 0)
@@ -742,8 +772,6 @@ static PolygonInfo *ConvertPathToPolygon(const PathInfo *path_info,
                 }
             }
           polygon_info->edges[edge].number_points=(size_t) n;
-          polygon_info->edges[edge].scanline=(-1.0);
-          polygon_info->edges[edge].highwater=0;
           polygon_info->edges[edge].ghostline=ghostline;
           polygon_info->edges[edge].direction=(ssize_t) (direction > 0);
           if (direction < 0)
@@ -1627,6 +1655,63 @@ static Image *DrawClippingMask(Image *image,const DrawInfo *draw_info,
   return(clip_mask);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D r a w C o m p o n e n t G e n e s i s                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DrawComponentGenesis() instantiates the draw component.
+%
+%  The format of the DrawComponentGenesis method is:
+%
+%      MagickBooleanType DrawComponentGenesis(void)
+%
+*/
+MagickPrivate MagickBooleanType DrawComponentGenesis(void)
+{
+  if (path_semaphore == (SemaphoreInfo *) NULL)
+    path_semaphore=AcquireSemaphoreInfo();
+  return(MagickTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   D r a w C o m p o n e n t T e r m i n u s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  DrawComponentTerminus() destroys the draw component and the paths it has
+%  traced.
+%
+%  The format of the DrawComponentTerminus method is:
+%
+%      void DrawComponentTerminus(void)
+%
+*/
+MagickPrivate void DrawComponentTerminus(void)
+{
+  if (path_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&path_semaphore);
+  LockSemaphoreInfo(path_semaphore);
+  if (path_cache != (SplayTreeInfo *) NULL)
+    path_cache=DestroySplayTree(path_cache);
+  RelinquishMagickResource(MemoryResource,path_cache_extent);
+  path_cache_extent=0;
+  UnlockSemaphoreInfo(path_semaphore);
+  RelinquishSemaphoreInfo(&path_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -2515,6 +2600,104 @@ static inline MagickBooleanType TracePoint(PrimitiveInfo *primitive_info,
   return(MagickTrue);
 }
 
+static void *DestroyTracedPath(void *traced_path)
+{
+  TracedPathInfo
+    *path_info;
+
+  path_info=(TracedPathInfo *) traced_path;
+  if (path_info->primitive_info != (PrimitiveInfo *) NULL)
+    path_info->primitive_info=(PrimitiveInfo *) RelinquishMagickMemory(
+      path_info->primitive_info);
+  return(RelinquishMagickMemory(path_info));
+}
+
+static ssize_t GetTracedPath(MVGInfo *mvg_info,const char *path)
+{
+  const TracedPathInfo
+    *path_info;
+
+  ssize_t
+    coordinates;
+
+  /*
+    Copy the points of a previously traced path, keyed on its path data.
+  */
+  if (path_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&path_semaphore);
+  LockSemaphoreInfo(path_semaphore);
+  path_info=(const TracedPathInfo *) NULL;
+  if (path_cache != (SplayTreeInfo *) NULL)
+    path_info=(const TracedPathInfo *) GetValueFromSplayTree(path_cache,path);
+  if ((path_info == (const TracedPathInfo *) NULL) ||
+      (CheckPrimitiveExtent(mvg_info,(double) path_info->coordinates) ==
+       MagickFalse))
+    {
+      path_misses++;
+      UnlockSemaphoreInfo(path_semaphore);
+      return(-1);
+    }
+  (void) memcpy(*mvg_info->primitive_info+mvg_info->offset,
+    path_info->primitive_info,path_info->coordinates*
+    sizeof(*path_info->primitive_info));
+  coordinates=(ssize_t) path_info->coordinates;
+  path_hits++;
+  UnlockSemaphoreInfo(path_semaphore);
+  return(coordinates);
+}
+
+static void SetTracedPath(const char *path,
+  const PrimitiveInfo *primitive_info,const size_t coordinates)
+{
+  MagickSizeType
+    extent;
+
+  TracedPathInfo
+    *path_info;
+
+  /*
+    Remember the points of a traced path; the cache is flushed whenever it
+    outgrows its extent and its memory is charged to the memory resource.
+  */
+  extent=(MagickSizeType) (strlen(path)+coordinates*sizeof(PrimitiveInfo));
+  if ((coordinates == 0) || (extent > MaxTracedPathExtent))
+    return;
+  path_info=(TracedPathInfo *) AcquireMagickMemory(sizeof(*path_info));
+  if (path_info == (TracedPathInfo *) NULL)
+    return;
+  path_info->coordinates=coordinates;
+  path_info->primitive_info=(PrimitiveInfo *) AcquireQuantumMemory(
+    coordinates,sizeof(*path_info->primitive_info));
+  if (path_info->primitive_info == (PrimitiveInfo *) NULL)
+    {
+      path_info=(TracedPathInfo *) DestroyTracedPath(path_info);
+      return;
+    }
+  (void) memcpy(path_info->primitive_info,primitive_info,coordinates*
+    sizeof(*path_info->primitive_info));
+  if (path_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&path_semaphore);
+  LockSemaphoreInfo(path_semaphore);
+  if (path_cache == (SplayTreeInfo *) NULL)
+    path_cache=NewSplayTree(CompareSplayTreeString,RelinquishMagickMemory,
+      DestroyTracedPath);
+  if ((path_cache_extent+extent) > MaxTracedPathExtent)
+    {
+      ResetSplayTree(path_cache);
+      RelinquishMagickResource(MemoryResource,path_cache_extent);
+      path_cache_extent=0;
+    }
+  if ((GetValueFromSplayTree(path_cache,path) != (const void *) NULL) ||
+      (AcquireMagickResource(MemoryResource,extent) == MagickFalse))
+    path_info=(TracedPathInfo *) DestroyTracedPath(path_info);
+  else
+    {
+      (void) AddValueToSplayTree(path_cache,ConstantString(path),path_info);
+      path_cache_extent+=extent;
+    }
+  UnlockSemaphoreInfo(path_semaphore);
+}
+
 static MagickBooleanType RenderMVGContent(Image *image,
   const DrawInfo *draw_info,const size_t depth,ExceptionInfo *exception)
 {
@@ -2548,6 +2731,7 @@ static MagickBooleanType RenderMVGContent(Image *image,
     **graphic_context;
 
   MagickBooleanType
+    cached_path,
     proceed;
 
   MagickStatusType
@@ -2655,6 +2839,14 @@ static MagickBooleanType RenderMVGContent(Image *image,
   mvg_info.extent=(&number_points);
   mvg_info.exception=exception;
   graphic_context[n]=CloneDrawInfo((ImageInfo *) NULL,draw_info);
+  if (graphic_context[n]->primitive != (char *) NULL)
+    {
+      /*
+        Every push would otherwise copy the entire vector graphic.
+      */
+      graphic_context[n]->primitive=DestroyString(
+        graphic_context[n]->primitive);
+    }
   graphic_context[n]->viewbox=image->page;
   if ((image->page.width == 0) || (image->page.height == 0))
     {
@@ -4224,6 +4416,7 @@ static MagickBooleanType RenderMVGContent(Image *image,
     /*
       Speculate how many points our primitive might consume.
     */
+    cached_path=MagickFalse;
     coordinates=(double) primitive_info[j].coordinates;
     switch (primitive_type)
     {
@@ -4259,6 +4452,14 @@ static MagickBooleanType RenderMVGContent(Image *image,
           *t;
 
         (void) GetNextToken(q,&q,extent,token);
+        mvg_info.offset=j;
+        coordinates=(double) GetTracedPath(&mvg_info,token);
+        primitive_info=(*mvg_info.primitive_info);
+        if (coordinates >= 0.0)
+          {
+            cached_path=MagickTrue;
+            break;
+          }
         coordinates=1.0;
         t=token;
         for (s=token; *s != '\0'; s=t)
@@ -4484,8 +4685,13 @@ static MagickBooleanType RenderMVGContent(Image *image,
       }
       case PathPrimitive:
       {
-        coordinates=(double) TracePath(&mvg_info,token,exception);
-        primitive_info=(*mvg_info.primitive_info);
+        if (cached_path == MagickFalse)
+          {
+            coordinates=(double) TracePath(&mvg_info,token,exception);
+            primitive_info=(*mvg_info.primitive_info);
+            if (coordinates >= 0.0)
+              SetTracedPath(token,primitive_info+j,(size_t) coordinates);
+          }
         if (status == MagickFalse)
           break;
         if (coordinates < 0.0)
@@ -4796,299 +5002,394 @@ MagickExport MagickBooleanType DrawPatternPath(Image *image,
 %
 */
 
-static PolygonInfo **DestroyPolygonTLS(PolygonInfo **polygon_info)
-{
-  ssize_t
-    i;
-
-  assert(polygon_info != (PolygonInfo **) NULL);
-  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
-    if (polygon_info[i] != (PolygonInfo *) NULL)
-      polygon_info[i]=DestroyPolygonInfo(polygon_info[i]);
-  polygon_info=(PolygonInfo **) RelinquishMagickMemory(polygon_info);
-  return(polygon_info);
-}
-
-static PolygonInfo **AcquirePolygonTLS(const PrimitiveInfo *primitive_info,
+static PolygonInfo *AcquirePolygonInfo(const PrimitiveInfo *primitive_info,
   ExceptionInfo *exception)
 {
   PathInfo
     *magick_restrict path_info;
 
   PolygonInfo
-    **polygon_info;
-
-  size_t
-    number_threads;
+    *polygon_info;
 
-  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
-  polygon_info=(PolygonInfo **) AcquireQuantumMemory(number_threads,
-    sizeof(*polygon_info));
-  if (polygon_info == (PolygonInfo **) NULL)
-    {
-      (void) ThrowMagickException(exception,GetMagickModule(),
-        ResourceLimitError,"MemoryAllocationFailed","`%s'","");
-      return((PolygonInfo **) NULL);
-    }
-  (void) memset(polygon_info,0,number_threads*sizeof(*polygon_info));
   path_info=ConvertPrimitiveToPath(primitive_info,exception);
   if (path_info == (PathInfo *) NULL)
-    return(DestroyPolygonTLS(polygon_info));
-  polygon_info[0]=ConvertPathToPolygon(path_info,exception);
-  if (polygon_info[0] == (PolygonInfo *) NULL)
-    {
-      (void) ThrowMagickException(exception,GetMagickModule(),
-        ResourceLimitError,"MemoryAllocationFailed","`%s'","");
-      return(DestroyPolygonTLS(polygon_info));
-    }
+    return((PolygonInfo *) NULL);
+  polygon_info=ConvertPathToPolygon(path_info,exception);
   path_info=(PathInfo *) RelinquishMagickMemory(path_info);
+  if (polygon_info == (PolygonInfo *) NULL)
+    (void) ThrowMagickException(exception,GetMagickModule(),
+      ResourceLimitError,"MemoryAllocationFailed","`%s'","");
   return(polygon_info);
 }
 
-static MagickBooleanType ClonePolygonEdgesTLS(PolygonInfo **polygon_info,
-  const size_t number_threads,ExceptionInfo *exception)
+static ScanlineInfo *DestroyScanlineInfo(ScanlineInfo *scanline_info)
+{
+  if (scanline_info->winding != (ssize_t *) NULL)
+    scanline_info->winding=(ssize_t *) RelinquishMagickMemory(
+      scanline_info->winding);
+  if (scanline_info->stroke_alpha != (double *) NULL)
+    scanline_info->stroke_alpha=(double *) RelinquishMagickMemory(
+      scanline_info->stroke_alpha);
+  if (scanline_info->highwater != (size_t *) NULL)
+    scanline_info->highwater=(size_t *) RelinquishMagickMemory(
+      scanline_info->highwater);
+  if (scanline_info->fill_alpha != (double *) NULL)
+    scanline_info->fill_alpha=(double *) RelinquishMagickMemory(
+      scanline_info->fill_alpha);
+  if (scanline_info->active_edges != (size_t *) NULL)
+    scanline_info->active_edges=(size_t *) RelinquishMagickMemory(
+      scanline_info->active_edges);
+  return((ScanlineInfo *) RelinquishMagickMemory(scanline_info));
+}
+
+static ScanlineInfo **DestroyScanlineTLS(ScanlineInfo **scanline_info,
+  const size_t number_threads)
 {
   ssize_t
     i;
 
-  for (i=1; i < (ssize_t) number_threads; i++)
-  {
-    EdgeInfo
-      *edge_info;
+  assert(scanline_info != (ScanlineInfo **) NULL);
+  for (i=0; i < (ssize_t) number_threads; i++)
+    if (scanline_info[i] != (ScanlineInfo *) NULL)
+      scanline_info[i]=DestroyScanlineInfo(scanline_info[i]);
+  scanline_info=(ScanlineInfo **) RelinquishMagickMemory(scanline_info);
+  return(scanline_info);
+}
 
-    ssize_t
-      j;
+static ScanlineInfo **AcquireScanlineTLS(const size_t number_threads,
+  const size_t columns,const size_t number_edges,ExceptionInfo *exception)
+{
+  ScanlineInfo
+    **scanline_info;
+
+  ssize_t
+    i;
+
+  scanline_info=(ScanlineInfo **) AcquireQuantumMemory(number_threads,
+    sizeof(*scanline_info));
+  if (scanline_info == (ScanlineInfo **) NULL)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'","");
+      return((ScanlineInfo **) NULL);
+    }
+  (void) memset(scanline_info,0,number_threads*sizeof(*scanline_info));
+  for (i=0; i < (ssize_t) number_threads; i++)
+  {
+    ScanlineInfo
+      *p;
 
-    polygon_info[i]=(PolygonInfo *) AcquireMagickMemory(
-      sizeof(*polygon_info[i]));
-    if (polygon_info[i] == (PolygonInfo *) NULL)
+    p=(ScanlineInfo *) AcquireMagickMemory(sizeof(*p));
+    if (p == (ScanlineInfo *) NULL)
       {
         (void) ThrowMagickException(exception,GetMagickModule(),
           ResourceLimitError,"MemoryAllocationFailed","`%s'","");
-        return(MagickFalse);
+        return(DestroyScanlineTLS(scanline_info,number_threads));
       }
-    polygon_info[i]->number_edges=0;
-    edge_info=polygon_info[0]->edges;
-    polygon_info[i]->edges=(EdgeInfo *) AcquireQuantumMemory(
-      polygon_info[0]->number_edges,sizeof(*edge_info));
-    if (polygon_info[i]->edges == (EdgeInfo *) NULL)
+    (void) memset(p,0,sizeof(*p));
+    scanline_info[i]=p;
+    p->active_edges=(size_t *) AcquireQuantumMemory(number_edges+1,
+      sizeof(*p->active_edges));
+    p->fill_alpha=(double *) AcquireQuantumMemory(columns,
+      sizeof(*p->fill_alpha));
+    p->highwater=(size_t *) AcquireQuantumMemory(number_edges+1,
+      sizeof(*p->highwater));
+    p->stroke_alpha=(double *) AcquireQuantumMemory(columns,
+      sizeof(*p->stroke_alpha));
+    p->winding=(ssize_t *) AcquireQuantumMemory(columns+1,
+      sizeof(*p->winding));
+    if ((p->active_edges == (size_t *) NULL) ||
+        (p->fill_alpha == (double *) NULL) ||
+        (p->highwater == (size_t *) NULL) ||
+        (p->stroke_alpha == (double *) NULL) ||
+        (p->winding == (ssize_t *) NULL))
       {
         (void) ThrowMagickException(exception,GetMagickModule(),
           ResourceLimitError,"MemoryAllocationFailed","`%s'","");
-        return(MagickFalse);
+        return(DestroyScanlineTLS(scanline_info,number_threads));
       }
-    (void) memcpy(polygon_info[i]->edges,edge_info,
-      polygon_info[0]->number_edges*sizeof(*edge_info));
-    for (j=0; j < (ssize_t) polygon_info[i]->number_edges; j++)
-      polygon_info[i]->edges[j].points=(PointInfo *) NULL;
-    polygon_info[i]->number_edges=polygon_info[0]->number_edges;
-    for (j=0; j < (ssize_t) polygon_info[i]->number_edges; j++)
-    {
-      edge_info=polygon_info[0]->edges+j;
-      polygon_info[i]->edges[j].points=(PointInfo *) AcquireQuantumMemory(
-        edge_info->number_points,sizeof(*edge_info));
-      if (polygon_info[i]->edges[j].points == (PointInfo *) NULL)
-        {
-          (void) ThrowMagickException(exception,GetMagickModule(),
-            ResourceLimitError,"MemoryAllocationFailed","`%s'","");
-          return(MagickFalse);
-        }
-      (void) memcpy(polygon_info[i]->edges[j].points,edge_info->points,
-        edge_info->number_points*sizeof(*edge_info->points));
-    }
+    p->scanline=(-MagickMaximumValue);
   }
-  return(MagickTrue);
+  return(scanline_info);
+}
+
+static inline ssize_t GetScanlineColumn(const double x,const ssize_t x1,
+  const ssize_t x2)
+{
+  /*
+    Return the first column greater than x, clamped to [x1,x2+1].
+  */
+  if (x < (double) x1)
+    return(x1);
+  if (x >= (double) x2)
+    return(x2+1);
+  if (x != x)
+    return(x1);
+  return((ssize_t) floor(x)+1);
 }
 
-static size_t DestroyEdge(PolygonInfo *polygon_info,const ssize_t edge)
+static inline MagickBooleanType IsScanlineLeftOfEdge(const PointInfo *q,
+  const ssize_t x,const ssize_t y)
 {
-  assert(edge < (ssize_t) polygon_info->number_edges);
-  polygon_info->edges[edge].points=(PointInfo *) RelinquishMagickMemory(
-    polygon_info->edges[edge].points);
-  polygon_info->number_edges--;
-  if (edge < (ssize_t) polygon_info->number_edges)
-    (void) memmove(polygon_info->edges+edge,polygon_info->edges+edge+1,
-      (polygon_info->number_edges-(size_t) edge)*sizeof(*polygon_info->edges));
-  return(polygon_info->number_edges);
+  if ((((q+1)->x-q->x)*(y-q->y)) <= (((q+1)->y-q->y)*(x-q->x)))
+    return(MagickTrue);
+  return(MagickFalse);
 }
 
-static double GetFillAlpha(PolygonInfo *polygon_info,const double mid,
-  const MagickBooleanType fill,const FillRule fill_rule,const ssize_t x,
-  const ssize_t y,double *stroke_alpha)
+static void GetScanlineAlpha(const PolygonInfo *polygon_info,const double mid,
+  const MagickBooleanType fill,const FillRule fill_rule,const ssize_t x1,
+  const ssize_t x2,const ssize_t y,ScanlineInfo *scanline_info)
 {
   double
-    alpha,
-    beta,
-    distance,
-    subpath_alpha;
-
-  const PointInfo
-    *q;
-
-  EdgeInfo
-    *p;
+    *magick_restrict fill_alpha,
+    reach,
+    *magick_restrict stroke_alpha;
 
-  PointInfo
-    delta;
+  size_t
+    columns;
 
   ssize_t
     i,
     j,
-    winding_number;
+    *magick_restrict winding,
+    winding_number,
+    x;
 
   /*
-    Compute fill & stroke opacity for this (x,y) point.
+    Compute the fill & stroke opacity of each pixel of this scanline.  An
+    active edge table holds the edges near the scanline; each segment near
+    it accumulates its distance-based opacity into just the columns it can
+    reach, and each edge it crosses adds a step to the winding number.
   */
-  *stroke_alpha=0.0;
-  subpath_alpha=0.0;
-  p=polygon_info->edges;
-  for (j=0; j < (ssize_t) polygon_info->number_edges; j++, p++)
+  if ((double) y < scanline_info->scanline)
+    {
+      scanline_info->next_edge=0;
+      scanline_info->number_active_edges=0;
+    }
+  if (scanline_info->next_edge == 0)
+    (void) memset(scanline_info->highwater,0,(polygon_info->number_edges+1)*
+      sizeof(*scanline_info->highwater));
+  scanline_info->scanline=(double) y;
+  while ((scanline_info->next_edge < polygon_info->number_edges) &&
+         (((double) y > (polygon_info->edges[scanline_info->next_edge].
+           bounds.y1-mid-0.5)) || ((double) y > polygon_info->edges[
+           scanline_info->next_edge].bounds.y1)))
+    scanline_info->active_edges[scanline_info->number_active_edges++]=
+      scanline_info->next_edge++;
+  j=0;
+  for (i=0; i < (ssize_t) scanline_info->number_active_edges; i++)
   {
-    if ((double) y <= (p->bounds.y1-mid-0.5))
-      break;
-    if ((double) y > (p->bounds.y2+mid+0.5))
-      {
-        p--;
-        (void) DestroyEdge(polygon_info,j--);
-        continue;
-      }
-    if (((double) x <= (p->bounds.x1-mid-0.5)) ||
-        ((double) x > (p->bounds.x2+mid+0.5)))
+    const EdgeInfo
+      *p;
+
+    p=polygon_info->edges+scanline_info->active_edges[i];
+    if (((double) y > (p->bounds.y2+mid+0.5)) && ((double) y > p->bounds.y2))
       continue;
-    i=(ssize_t) MagickMax((double) p->highwater,1.0);
-    for ( ; i < (ssize_t) p->number_points; i++)
-    {
-      if ((double) y <= (p->points[i-1].y-mid-0.5))
-        break;
-      if ((double) y > (p->points[i].y+mid+0.5))
-        continue;
-      if (p->scanline != (double) y)
-        {
-          p->scanline=(double) y;
-          p->highwater=(size_t) i;
-        }
-      /*
-        Compute distance between a point and an edge.
-      */
-      q=p->points+i-1;
-      delta.x=(q+1)->x-q->x;
-      delta.y=(q+1)->y-q->y;
-      beta=delta.x*(x-q->x)+delta.y*(y-q->y);  /* segLen*point-cos(theta) */
-      if (beta <= 0.0)
-        {
-          /*
-            Cosine <= 0, point is closest to q.
-          */
-          delta.x=(double) x-q->x;
-          delta.y=(double) y-q->y;
-          distance=delta.x*delta.x+delta.y*delta.y;
-        }
-      else
+    scanline_info->active_edges[j++]=scanline_info->active_edges[i];
+  }
+  scanline_info->number_active_edges=(size_t) j;
+  columns=(size_t) (x2-x1+1);
+  fill_alpha=scanline_info->fill_alpha;
+  stroke_alpha=scanline_info->stroke_alpha;
+  winding=scanline_info->winding;
+  (void) memset(fill_alpha,0,columns*sizeof(*fill_alpha));
+  (void) memset(stroke_alpha,0,columns*sizeof(*stroke_alpha));
+  (void) memset(winding,0,(columns+1)*sizeof(*winding));
+  reach=MagickMax(fabs(mid+0.75),1.0)+1.0;
+  winding_number=0;
+  for (i=0; i < (ssize_t) scanline_info->number_active_edges; i++)
+  {
+    const EdgeInfo
+      *p;
+
+    const PointInfo
+      *q;
+
+    size_t
+      *highwater;
+
+    ssize_t
+      first,
+      k,
+      last,
+      step;
+
+    p=polygon_info->edges+scanline_info->active_edges[i];
+    highwater=scanline_info->highwater+scanline_info->active_edges[i];
+    first=GetScanlineColumn(p->bounds.x1-mid-0.5,x1,x2);
+    last=GetScanlineColumn(p->bounds.x2+mid+0.5,x1,x2)-1;
+    if (((double) y > (p->bounds.y1-mid-0.5)) &&
+        ((double) y <= (p->bounds.y2+mid+0.5)) && (first <= last))
+      {
+        MagickBooleanType
+          update;
+
+        update=MagickTrue;
+        k=(ssize_t) MagickMax((double) *highwater,1.0);
+        for ( ; k < (ssize_t) p->number_points; k++)
         {
-          alpha=delta.x*delta.x+delta.y*delta.y;  /* segLen*segLen */
-          if (beta >= alpha)
-            {
-              /*
-                Point is closest to q+1.
-              */
-              delta.x=(double) x-(q+1)->x;
-              delta.y=(double) y-(q+1)->y;
-              distance=delta.x*delta.x+delta.y*delta.y;
-            }
-          else
+          PointInfo
+            delta;
+
+          ssize_t
+            u,
+            v;
+
+          if ((double) y <= (p->points[k-1].y-mid-0.5))
+            break;
+          if ((double) y > (p->points[k].y+mid+0.5))
+            continue;
+          if (update != MagickFalse)
             {
-              /*
-                Point is closest to point between q & q+1.
-              */
-              alpha=MagickSafeReciprocal(alpha);
-              beta=delta.x*(y-q->y)-delta.y*(x-q->x);
-              distance=alpha*beta*beta;
+              *highwater=(size_t) k;
+              update=MagickFalse;
             }
+          q=p->points+k-1;
+          delta.x=(q+1)->x-q->x;
+          delta.y=(q+1)->y-q->y;
+          u=GetScanlineColumn(MagickMin(q->x,(q+1)->x)-reach,first,last);
+          v=GetScanlineColumn(MagickMax(q->x,(q+1)->x)+reach,first,last)-1;
+          for (x=u; x <= v; x++)
+          {
+            double
+              alpha,
+              beta,
+              distance;
+
+            PointInfo
+              offset;
+
+            /*
+              Compute distance between a point and an edge.
+            */
+            beta=delta.x*(x-q->x)+delta.y*(y-q->y);
+            if (beta <= 0.0)
+              {
+                offset.x=(double) x-q->x;
+                offset.y=(double) y-q->y;
+                distance=offset.x*offset.x+offset.y*offset.y;
+              }
+            else
+              {
+                alpha=delta.x*delta.x+delta.y*delta.y;
+                if (beta >= alpha)
+                  {
+                    offset.x=(double) x-(q+1)->x;
+                    offset.y=(double) y-(q+1)->y;
+                    distance=offset.x*offset.x+offset.y*offset.y;
+                  }
+                else
+                  {
+                    alpha=MagickSafeReciprocal(alpha);
+                    beta=delta.x*(y-q->y)-delta.y*(x-q->x);
+                    distance=alpha*beta*beta;
+                  }
+              }
+            /*
+              Compute stroke & subpath opacity.
+            */
+            beta=0.0;
+            if (p->ghostline == MagickFalse)
+              {
+                alpha=mid+0.5;
+                if ((stroke_alpha[x-x1] < 1.0) &&
+                    (distance <= ((alpha+0.25)*(alpha+0.25))))
+                  {
+                    alpha=mid-0.5;
+                    if (distance <= ((alpha+0.25)*(alpha+0.25)))
+                      stroke_alpha[x-x1]=1.0;
+                    else
+                      {
+                        beta=1.0;
+                        if (fabs(distance-1.0) >= MagickEpsilon)
+                          beta=sqrt((double) distance);
+                        alpha=beta-mid-0.5;
+                        if (stroke_alpha[x-x1] < ((alpha-0.25)*(alpha-0.25)))
+                          stroke_alpha[x-x1]=(alpha-0.25)*(alpha-0.25);
+                      }
+                  }
+              }
+            if ((fill == MagickFalse) || (distance > 1.0) ||
+                (fill_alpha[x-x1] >= 1.0))
+              continue;
+            if (distance <= 0.0)
+              {
+                fill_alpha[x-x1]=1.0;
+                continue;
+              }
+            if (fabs(beta) < MagickEpsilon)
+              {
+                beta=1.0;
+                if (fabs(distance-1.0) >= MagickEpsilon)
+                  beta=sqrt(distance);
+              }
+            alpha=beta-1.0;
+            if (fill_alpha[x-x1] < (alpha*alpha))
+              fill_alpha[x-x1]=alpha*alpha;
+          }
         }
-      /*
-        Compute stroke & subpath opacity.
-      */
-      beta=0.0;
-      if (p->ghostline == MagickFalse)
-        {
-          alpha=mid+0.5;
-          if ((*stroke_alpha < 1.0) &&
-              (distance <= ((alpha+0.25)*(alpha+0.25))))
+      }
+    if ((fill == MagickFalse) || ((double) y <= p->bounds.y1) ||
+        ((double) y > p->bounds.y2))
+      continue;
+    /*
+      The edge adds to the winding number of every column right of where it
+      crosses the scanline.
+    */
+    step=p->direction != 0 ? 1 : -1;
+    k=(ssize_t) MagickMax((double) *highwater,1.0);
+    for ( ; k < (ssize_t) (p->number_points-1); k++)
+      if ((double) y <= p->points[k].y)
+        break;
+    q=p->points+k-1;
+    first=GetScanlineColumn(p->bounds.x1,x1,x2);
+    last=GetScanlineColumn(p->bounds.x2,x1,x2);
+    if (((q+1)->y-q->y) < 0.0)
+      {
+        for (x=first; x < last; x++)
+          if (IsScanlineLeftOfEdge(q,x,y) != MagickFalse)
             {
-              alpha=mid-0.5;
-              if (distance <= ((alpha+0.25)*(alpha+0.25)))
-                *stroke_alpha=1.0;
-              else
-                {
-                  beta=1.0;
-                  if (fabs(distance-1.0) >= MagickEpsilon)
-                    beta=sqrt((double) distance);
-                  alpha=beta-mid-0.5;
-                  if (*stroke_alpha < ((alpha-0.25)*(alpha-0.25)))
-                    *stroke_alpha=(alpha-0.25)*(alpha-0.25);
-                }
+              winding[x-x1]+=step;
+              winding[x-x1+1]-=step;
             }
-        }
-      if ((fill == MagickFalse) || (distance > 1.0) || (subpath_alpha >= 1.0))
-        continue;
-      if (distance <= 0.0)
-        {
-          subpath_alpha=1.0;
-          continue;
-        }
-      if (distance > 1.0)
-        continue;
-      if (fabs(beta) < MagickEpsilon)
+      }
+    else
+      {
+        ssize_t
+          middle;
+
+        while (first < last)
         {
-          beta=1.0;
-          if (fabs(distance-1.0) >= MagickEpsilon)
-            beta=sqrt(distance);
+          middle=first+(last-first)/2;
+          if (IsScanlineLeftOfEdge(q,middle,y) != MagickFalse)
+            last=middle;
+          else
+            first=middle+1;
         }
-      alpha=beta-1.0;
-      if (subpath_alpha < (alpha*alpha))
-        subpath_alpha=alpha*alpha;
-    }
+      }
+    if (last <= x1)
+      winding_number+=step;
+    else
+      if (last <= x2)
+        winding[last-x1]+=step;
   }
   /*
     Compute fill opacity.
   */
-  if (fill == MagickFalse)
-    return(0.0);
-  if (subpath_alpha >= 1.0)
-    return(1.0);
-  /*
-    Determine winding number.
-  */
-  winding_number=0;
-  p=polygon_info->edges;
-  for (j=0; j < (ssize_t) polygon_info->number_edges; j++, p++)
+  for (x=x1; x <= x2; x++)
   {
-    if ((double) y <= p->bounds.y1)
-      break;
-    if (((double) y > p->bounds.y2) || ((double) x <= p->bounds.x1))
+    winding_number+=winding[x-x1];
+    if ((fill == MagickFalse) || (fill_alpha[x-x1] >= 1.0))
       continue;
-    if ((double) x > p->bounds.x2)
+    if (fill_rule != NonZeroRule)
       {
-        winding_number+=p->direction != 0 ? 1 : -1;
-        continue;
+        if ((MagickAbsoluteValue(winding_number) & 0x01) != 0)
+          fill_alpha[x-x1]=1.0;
       }
-    i=(ssize_t) MagickMax((double) p->highwater,1.0);
-    for ( ; i < (ssize_t) (p->number_points-1); i++)
-      if ((double) y <= p->points[i].y)
-        break;
-    q=p->points+i-1;
-    if ((((q+1)->x-q->x)*(y-q->y)) <= (((q+1)->y-q->y)*(x-q->x)))
-      winding_number+=p->direction != 0 ? 1 : -1;
+    else
+      if (MagickAbsoluteValue(winding_number) != 0)
+        fill_alpha[x-x1]=1.0;
   }
-  if (fill_rule != NonZeroRule)
-    {
-      if ((MagickAbsoluteValue(winding_number) & 0x01) != 0)
-        return(1.0);
-    }
-  else
-    if (MagickAbsoluteValue(winding_number) != 0)
-      return(1.0);
-  return(subpath_alpha);
 }
 
 static MagickBooleanType DrawPolygonPrimitive(Image *image,
@@ -5124,7 +5425,10 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
     status;
 
   PolygonInfo
-    **magick_restrict polygon_info;
+    *magick_restrict polygon_info;
+
+  ScanlineInfo
+    **magick_restrict scanline_info;
 
   SegmentInfo
     bounds;
@@ -5148,21 +5452,21 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
   /*
     Compute bounding box.
   */
-  polygon_info=AcquirePolygonTLS(primitive_info,exception);
-  if (polygon_info == (PolygonInfo **) NULL)
+  polygon_info=AcquirePolygonInfo(primitive_info,exception);
+  if (polygon_info == (PolygonInfo *) NULL)
     return(MagickFalse);
   if (draw_info->debug != MagickFalse)
     (void) LogMagickEvent(DrawEvent,GetMagickModule(),"    begin draw-polygon");
   fill=(primitive_info->method == FillToBorderMethod) ||
     (primitive_info->method == FloodfillMethod) ? MagickTrue : MagickFalse;
   mid=ExpandAffine(&draw_info->affine)*draw_info->stroke_width/2.0;
-  bounds=polygon_info[0]->edges[0].bounds;
+  bounds=polygon_info->edges[0].bounds;
   artifact=GetImageArtifact(image,"draw:render-bounding-rectangles");
   if (IsStringTrue(artifact) != MagickFalse)
-    (void) DrawBoundingRectangles(image,draw_info,polygon_info[0],exception);
-  for (i=1; i < (ssize_t) polygon_info[0]->number_edges; i++)
+    (void) DrawBoundingRectangles(image,draw_info,polygon_info,exception);
+  for (i=1; i < (ssize_t) polygon_info->number_edges; i++)
   {
-    p=polygon_info[0]->edges+i;
+    p=polygon_info->edges+i;
     if (p->bounds.x1 < bounds.x1)
       bounds.x1=p->bounds.x1;
     if (p->bounds.y1 < bounds.y1)
@@ -5180,7 +5484,7 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
       (bounds.y1 >= (double) image->rows) ||
       (bounds.x2 <= 0.0) || (bounds.y2 <= 0.0))
     {
-      polygon_info=DestroyPolygonTLS(polygon_info);
+      polygon_info=DestroyPolygonInfo(polygon_info);
       return(MagickTrue);  /* virtual polygon */
     }
   bounds.x1=bounds.x1 < 0.0 ? 0.0 : bounds.x1 >= (double) image->columns-1.0 ?
@@ -5197,15 +5501,10 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
   poly_extent.y2=CastDoubleToSsizeT(floor(bounds.y2+0.5));
   number_threads=(size_t) GetMagickNumberThreads(image,image,(size_t)
     (poly_extent.y2-poly_extent.y1+1),1);
-  status=ClonePolygonEdgesTLS(polygon_info,number_threads,exception);
-  if (status == MagickFalse)
-    {
-      polygon_info=DestroyPolygonTLS(polygon_info);
-      return(status);
-    }
+  status=MagickTrue;
   image_view=AcquireAuthenticCacheView(image,exception);
   if ((primitive_info->coordinates == 1) ||
-      (polygon_info[0]->number_edges == 0))
+      (polygon_info->number_edges == 0))
     {
       /*
         Draw point.
@@ -5251,7 +5550,7 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
           status=MagickFalse;
       }
       image_view=DestroyCacheView(image_view);
-      polygon_info=DestroyPolygonTLS(polygon_info);
+      polygon_info=DestroyPolygonInfo(polygon_info);
       if (draw_info->debug != MagickFalse)
         (void) LogMagickEvent(DrawEvent,GetMagickModule(),
           "    end draw-polygon");
@@ -5260,6 +5559,14 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
   /*
     Draw polygon or line.
   */
+  scanline_info=AcquireScanlineTLS(number_threads,(size_t) (poly_extent.x2-
+    poly_extent.x1+1),polygon_info->number_edges,exception);
+  if (scanline_info == (ScanlineInfo **) NULL)
+    {
+      image_view=DestroyCacheView(image_view);
+      polygon_info=DestroyPolygonInfo(polygon_info);
+      return(MagickFalse);
+    }
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
   #pragma omp parallel for schedule(static) shared(status) \
     num_threads((int) number_threads)
@@ -5269,6 +5576,10 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
     const int
       id = GetOpenMPThreadId();
 
+    const double
+      *magick_restrict fill_alpha,
+      *magick_restrict stroke_alpha;
+
     Quantum
       *magick_restrict q;
 
@@ -5284,11 +5595,15 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
         status=MagickFalse;
         continue;
       }
+    GetScanlineAlpha(polygon_info,mid,fill,draw_info->fill_rule,
+      poly_extent.x1,poly_extent.x2,y,scanline_info[id]);
+    fill_alpha=scanline_info[id]->fill_alpha;
+    stroke_alpha=scanline_info[id]->stroke_alpha;
     for (x=poly_extent.x1; x <= poly_extent.x2; x++)
     {
       double
-        fill_alpha,
-        stroke_alpha;
+        fill_opacity,
+        stroke_opacity;
 
       PixelInfo
         fill_color,
@@ -5297,28 +5612,29 @@ static MagickBooleanType DrawPolygonPrimitive(Image *image,
       /*
         Fill and/or stroke.
       */
-      fill_alpha=GetFillAlpha(polygon_info[id],mid,fill,draw_info->fill_rule,
-        x,y,&stroke_alpha);
+      fill_opacity=fill_alpha[x-poly_extent.x1];
+      stroke_opacity=stroke_alpha[x-poly_extent.x1];
       if (draw_info->stroke_antialias == MagickFalse)
         {
-          fill_alpha=fill_alpha >= AntialiasThreshold ? 1.0 : 0.0;
-          stroke_alpha=stroke_alpha >= AntialiasThreshold ? 1.0 : 0.0;
+          fill_opacity=fill_opacity >= AntialiasThreshold ? 1.0 : 0.0;
+          stroke_opacity=stroke_opacity >= AntialiasThreshold ? 1.0 : 0.0;
         }
       GetFillColor(draw_info,x-poly_extent.x1,y-poly_extent.y1,&fill_color,
         exception);
-      CompositePixelOver(image,&fill_color,fill_alpha*fill_color.alpha,q,
+      CompositePixelOver(image,&fill_color,fill_opacity*fill_color.alpha,q,
         (double) GetPixelAlpha(image,q),q);
       GetStrokeColor(draw_info,x-poly_extent.x1,y-poly_extent.y1,&stroke_color,
         exception);
-      CompositePixelOver(image,&stroke_color,stroke_alpha*stroke_color.alpha,q,
-        (double) GetPixelAlpha(image,q),q);
+      CompositePixelOver(image,&stroke_color,stroke_opacity*stroke_color.alpha,
+        q,(double) GetPixelAlpha(image,q),q);
       q+=(ptrdiff_t) GetPixelChannels(image);
     }
     if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
       status=MagickFalse;
   }
   image_view=DestroyCacheView(image_view);
-  polygon_info=DestroyPolygonTLS(polygon_info);
+  scanline_info=DestroyScanlineTLS(scanline_info,number_threads);
+  polygon_info=DestroyPolygonInfo(polygon_info);
   if (draw_info->debug != MagickFalse)
     (void) LogMagickEvent(DrawEvent,GetMagickModule(),"    end draw-polygon");
   return(status);
@@ -6247,6 +6563,42 @@ MagickExport void GetDrawInfo(const ImageInfo *image_info,DrawInfo *draw_info)
   draw_info->signature=MagickCoreSignature;
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t D r a w P a t h S t a t i s t i c s                                 %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetDrawPathStatistics() returns the number of hits and misses of the
+%  traced path cache.
+%
+%  The format of the GetDrawPathStatistics method is:
+%
+%      void GetDrawPathStatistics(MagickSizeType *hits,MagickSizeType *misses)
+%
+%  A description of each parameter follows:
+%
+%    o hits: the number of paths copied from the cache.
+%
+%    o misses: the number of paths traced.
+%
+*/
+MagickPrivate void GetDrawPathStatistics(MagickSizeType *hits,
+  MagickSizeType *misses)
+{
+  if (path_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&path_semaphore);
+  LockSemaphoreInfo(path_semaphore);
+  *hits=path_hits;
+  *misses=path_misses;
+  UnlockSemaphoreInfo(path_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
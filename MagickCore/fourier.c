@@ -51,16 +51,21 @@
 #include "MagickCore/image-private.h"
 #include "MagickCore/list.h"
 #include "MagickCore/fourier.h"
+#include "MagickCore/fourier-private.h"
 #include "MagickCore/log.h"
 #include "MagickCore/memory_.h"
 #include "MagickCore/monitor.h"
 #include "MagickCore/monitor-private.h"
 #include "MagickCore/pixel-accessor.h"
+#include "MagickCore/policy.h"
 #include "MagickCore/property.h"
 #include "MagickCore/quantum-private.h"
 #include "MagickCore/resource_.h"
+#include "MagickCore/semaphore.h"
+#include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
 #include "MagickCore/thread-private.h"
+#include "MagickCore/utility-private.h"
 #if defined(MAGICKCORE_FFTW_DELEGATE)
 #if defined(_MSC_VER)
 #define ENABLE_FFTW_DELEGATE
@@ -87,6 +92,11 @@
 #endif
 #endif
 
+/*
+  Define declarations.
+*/
+#define MaxFourierPlanEntries  16
+
 /*
   Typedef declarations.
 */
@@ -103,6 +113,55 @@ typedef struct _FourierInfo
     width,
     height;
 } FourierInfo;
+
+#if defined(ENABLE_FFTW_DELEGATE)
+typedef struct _FourierPlanInfo
+{
+  fftw_plan
+    plan;
+
+  int
+    direction;
+
+  unsigned int
+    flags;
+
+  size_t
+    width,
+    height;
+
+  ssize_t
+    reference_count;
+
+  MagickSizeType
+    timestamp;
+} FourierPlanInfo;
+#endif
+
+/*
+  Global declarations.
+*/
+#if defined(ENABLE_FFTW_DELEGATE)
+static char
+  *wisdom_filename = (char *) NULL;
+
+static FourierPlanInfo
+  *plan_cache[MaxFourierPlanEntries];
+
+static MagickBooleanType
+  planner_instantiated = MagickFalse,
+  wisdom_changed = MagickFalse;
+
+static MagickSizeType
+  plan_epoch = 0;
+#endif
+
+static MagickSizeType
+  plan_hits = 0,
+  plan_misses = 0;
+
+static SemaphoreInfo
+  *plan_semaphore = (SemaphoreInfo *) NULL;
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -412,6 +471,239 @@ MagickExport Image *ComplexImages(const Image *images,const ComplexOperator op,
 
 #if defined(ENABLE_FFTW_DELEGATE)
 
+static FourierPlanInfo *DestroyFourierPlan(FourierPlanInfo *plan_info)
+{
+  if (plan_info->plan != (fftw_plan) NULL)
+    fftw_destroy_plan(plan_info->plan);
+  return((FourierPlanInfo *) RelinquishMagickMemory(plan_info));
+}
+
+static unsigned int GetFourierPlannerFlags(const Image *image)
+{
+  const char
+    *value;
+
+  value=GetImageArtifact(image,"fourier:planner");
+  if (value == (const char *) NULL)
+    return(FFTW_ESTIMATE);
+  if (LocaleCompare(value,"exhaustive") == 0)
+    return(FFTW_EXHAUSTIVE);
+  if (LocaleCompare(value,"measure") == 0)
+    return(FFTW_MEASURE);
+  if (LocaleCompare(value,"patient") == 0)
+    return(FFTW_PATIENT);
+  return(FFTW_ESTIMATE);
+}
+
+static void InstantiateFourierPlanner(void)
+{
+  /*
+    Called with the plan semaphore held: every FFTW planner call in this
+    module is serialized by it.
+  */
+  if (planner_instantiated != MagickFalse)
+    return;
+  wisdom_filename=GetPolicyValue("system:fftw-wisdom");
+  if ((wisdom_filename != (char *) NULL) && (*wisdom_filename != '\0'))
+    (void) fftw_import_wisdom_from_filename(wisdom_filename);
+  planner_instantiated=MagickTrue;
+}
+
+static inline MagickBooleanType IsFourierPlanMatch(
+  const FourierPlanInfo *plan_info,const int direction,const size_t width,
+  const size_t height,const unsigned int flags)
+{
+  if ((plan_info->direction != direction) || (plan_info->width != width) ||
+      (plan_info->height != height) || (plan_info->flags != flags))
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
+static FourierPlanInfo *RelinquishFourierPlan(FourierPlanInfo *plan_info)
+{
+  assert(plan_info != (FourierPlanInfo *) NULL);
+  LockSemaphoreInfo(plan_semaphore);
+  if (--plan_info->reference_count == 0)
+    plan_info=DestroyFourierPlan(plan_info);
+  UnlockSemaphoreInfo(plan_semaphore);
+  return((FourierPlanInfo *) NULL);
+}
+
+static FourierPlanInfo *AcquireFourierPlan(const Image *image,
+  const int direction,const size_t width,const size_t height,
+  double *real_pixels,fftw_complex *complex_pixels)
+{
+  double
+    *plan_real;
+
+  fftw_complex
+    *plan_complex;
+
+  FourierPlanInfo
+    *plan_info;
+
+  ssize_t
+    i,
+    j;
+
+  unsigned int
+    flags;
+
+  /*
+    A plan depends only on the direction, the size, and the planner flags.
+    It is executed on the caller's arrays with the
+    new-array interface, so every channel and image of that size shares it.
+  */
+  flags=GetFourierPlannerFlags(image);
+  if ((fftw_alignment_of(real_pixels) != 0) ||
+      (fftw_alignment_of((double *) complex_pixels) != 0))
+    flags|=FFTW_UNALIGNED;
+  if (plan_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&plan_semaphore);
+  LockSemaphoreInfo(plan_semaphore);
+  for (i=0; i < MaxFourierPlanEntries; i++)
+  {
+    plan_info=plan_cache[i];
+    if ((plan_info != (FourierPlanInfo *) NULL) &&
+        (IsFourierPlanMatch(plan_info,direction,width,height,flags) !=
+         MagickFalse))
+      {
+        plan_info->reference_count++;
+        plan_info->timestamp=(++plan_epoch);
+        plan_hits++;
+        UnlockSemaphoreInfo(plan_semaphore);
+        if (image->debug != MagickFalse)
+          (void) LogMagickEvent(TransformEvent,GetMagickModule(),
+            "fftw: reuse cached %.20gx%.20g plan",(double) width,(double)
+            height);
+        return(plan_info);
+      }
+  }
+  plan_misses++;
+  plan_info=(FourierPlanInfo *) AcquireMagickMemory(sizeof(*plan_info));
+  if (plan_info == (FourierPlanInfo *) NULL)
+    {
+      UnlockSemaphoreInfo(plan_semaphore);
+      return((FourierPlanInfo *) NULL);
+    }
+  (void) memset(plan_info,0,sizeof(*plan_info));
+  plan_info->direction=direction;
+  plan_info->width=width;
+  plan_info->height=height;
+  plan_info->flags=flags;
+  InstantiateFourierPlanner();
+  plan_real=real_pixels;
+  plan_complex=complex_pixels;
+  if ((flags & FFTW_ESTIMATE) == 0)
+    {
+      /*
+        Measuring overwrites the arrays it plans on, so plan on scratch.
+      */
+      plan_real=(double *) fftw_malloc(width*height*sizeof(*plan_real));
+      plan_complex=(fftw_complex *) fftw_malloc(width*(height/2+1)*
+        sizeof(*plan_complex));
+      if ((plan_real == (double *) NULL) ||
+          (plan_complex == (fftw_complex *) NULL))
+        {
+          if (plan_complex != (fftw_complex *) NULL)
+            fftw_free(plan_complex);
+          if (plan_real != (double *) NULL)
+            fftw_free(plan_real);
+          plan_info=DestroyFourierPlan(plan_info);
+          UnlockSemaphoreInfo(plan_semaphore);
+          return((FourierPlanInfo *) NULL);
+        }
+      wisdom_changed=MagickTrue;
+    }
+  if (direction == FFTW_FORWARD)
+    plan_info->plan=fftw_plan_dft_r2c_2d((int) width,(int) height,plan_real,
+      plan_complex,flags);
+  else
+    plan_info->plan=fftw_plan_dft_c2r_2d((int) width,(int) height,
+      plan_complex,plan_real,flags);
+  if (plan_real != real_pixels)
+    {
+      fftw_free(plan_complex);
+      fftw_free(plan_real);
+    }
+  if (plan_info->plan == (fftw_plan) NULL)
+    {
+      plan_info=DestroyFourierPlan(plan_info);
+      UnlockSemaphoreInfo(plan_semaphore);
+      return((FourierPlanInfo *) NULL);
+    }
+  if (image->debug != MagickFalse)
+    (void) LogMagickEvent(TransformEvent,GetMagickModule(),
+      "fftw: create %.20gx%.20g plan",(double) width,(double) height);
+  /*
+    Replace the least recently used plan.
+  */
+  j=0;
+  for (i=0; i < MaxFourierPlanEntries; i++)
+  {
+    if (plan_cache[i] == (FourierPlanInfo *) NULL)
+      {
+        j=i;
+        break;
+      }
+    if (plan_cache[i]->timestamp < plan_cache[j]->timestamp)
+      j=i;
+  }
+  if ((plan_cache[j] != (FourierPlanInfo *) NULL) &&
+      (--plan_cache[j]->reference_count == 0))
+    plan_cache[j]=DestroyFourierPlan(plan_cache[j]);
+  plan_info->reference_count=2;
+  plan_info->timestamp=(++plan_epoch);
+  plan_cache[j]=plan_info;
+  UnlockSemaphoreInfo(plan_semaphore);
+  return(plan_info);
+}
+
+static void ResetFourierPlanCache(void)
+{
+  ssize_t
+    i;
+
+  for (i=0; i < MaxFourierPlanEntries; i++)
+    if ((plan_cache[i] != (FourierPlanInfo *) NULL) &&
+        (--plan_cache[i]->reference_count == 0))
+      plan_cache[i]=DestroyFourierPlan(plan_cache[i]);
+  (void) memset(plan_cache,0,sizeof(plan_cache));
+  if (planner_instantiated == MagickFalse)
+    return;
+  if ((wisdom_changed != MagickFalse) &&
+      (wisdom_filename != (char *) NULL) && (*wisdom_filename != '\0'))
+    {
+      char
+        path[MagickPathExtent];
+
+      int
+        unique_file;
+
+      /*
+        Export the accumulated wisdom to a unique file; the rename keeps
+        concurrent processes from reading a partial file.  A temporary path
+        on another file system cannot be renamed, so write in place instead.
+      */
+      unique_file=AcquireUniqueFileResource(path);
+      if (unique_file == -1)
+        (void) fftw_export_wisdom_to_filename(wisdom_filename);
+      else
+        {
+          (void) close_utf8(unique_file);
+          if ((fftw_export_wisdom_to_filename(path) == 0) ||
+              (rename_utf8(path,wisdom_filename) != 0))
+            (void) fftw_export_wisdom_to_filename(wisdom_filename);
+          (void) RelinquishUniqueFileResource(path);
+        }
+    }
+  if (wisdom_filename != (char *) NULL)
+    wisdom_filename=DestroyString(wisdom_filename);
+  fftw_cleanup();
+  planner_instantiated=MagickFalse;
+  wisdom_changed=MagickFalse;
+}
+
 static MagickBooleanType RollFourier(const size_t width,const size_t height,
   const ssize_t x_offset,const ssize_t y_offset,double *roll_pixels)
 {
@@ -710,8 +1002,8 @@ static MagickBooleanType ForwardFourierTransform(FourierInfo *fourier_info,
   fftw_complex
     *forward_pixels;
 
-  fftw_plan
-    fftw_r2c_plan;
+  FourierPlanInfo
+    *plan_info;
 
   MemoryInfo
     *forward_info,
@@ -796,13 +1088,18 @@ static MagickBooleanType ForwardFourierTransform(FourierInfo *fourier_info,
       return(MagickFalse);
     }
   forward_pixels=(fftw_complex *) GetVirtualMemoryBlob(forward_info);
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp critical (MagickCore_ForwardFourierTransform)
-#endif
-  fftw_r2c_plan=fftw_plan_dft_r2c_2d((int) fourier_info->width,
-    (int) fourier_info->height,source_pixels,forward_pixels,FFTW_ESTIMATE);
-  fftw_execute_dft_r2c(fftw_r2c_plan,source_pixels,forward_pixels);
-  fftw_destroy_plan(fftw_r2c_plan);
+  plan_info=AcquireFourierPlan(image,FFTW_FORWARD,fourier_info->width,
+    fourier_info->height,source_pixels,forward_pixels);
+  if (plan_info == (FourierPlanInfo *) NULL)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      forward_info=(MemoryInfo *) RelinquishVirtualMemory(forward_info);
+      source_info=(MemoryInfo *) RelinquishVirtualMemory(source_info);
+      return(MagickFalse);
+    }
+  fftw_execute_dft_r2c(plan_info->plan,source_pixels,forward_pixels);
+  plan_info=RelinquishFourierPlan(plan_info);
   source_info=(MemoryInfo *) RelinquishVirtualMemory(source_info);
   value=GetImageArtifact(image,"fourier:normalize");
   if ((value == (const char *) NULL) || (LocaleCompare(value,"forward") == 0))
@@ -1043,7 +1340,6 @@ MagickExport Image *ForwardFourierTransformImage(const Image *image,
             }
             if (status == MagickFalse)
               fourier_image=DestroyImageList(fourier_image);
-            fftw_cleanup();
           }
       }
   }
@@ -1056,6 +1352,100 @@ MagickExport Image *ForwardFourierTransformImage(const Image *image,
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   F o u r i e r C o m p o n e n t G e n e s i s                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FourierComponentGenesis() instantiates the Fourier component.
+%
+%  The format of the FourierComponentGenesis method is:
+%
+%      MagickBooleanType FourierComponentGenesis(void)
+%
+*/
+MagickPrivate MagickBooleanType FourierComponentGenesis(void)
+{
+  if (plan_semaphore == (SemaphoreInfo *) NULL)
+    plan_semaphore=AcquireSemaphoreInfo();
+  return(MagickTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   F o u r i e r C o m p o n e n t T e r m i n u s                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  FourierComponentTerminus() destroys the Fourier component.  Cached FFTW
+%  plans are destroyed and, if any were measured, the accumulated wisdom is
+%  exported to the file named by the system:fftw-wisdom security policy.
+%
+%  The format of the FourierComponentTerminus method is:
+%
+%      void FourierComponentTerminus(void)
+%
+*/
+MagickPrivate void FourierComponentTerminus(void)
+{
+  if (plan_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&plan_semaphore);
+  LockSemaphoreInfo(plan_semaphore);
+#if defined(ENABLE_FFTW_DELEGATE)
+  ResetFourierPlanCache();
+#endif
+  UnlockSemaphoreInfo(plan_semaphore);
+  RelinquishSemaphoreInfo(&plan_semaphore);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t F o u r i e r P l a n S t a t i s t i c s                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetFourierPlanStatistics() returns the number of hits and misses of the
+%  FFTW plan cache.
+%
+%  The format of the GetFourierPlanStatistics method is:
+%
+%      void GetFourierPlanStatistics(MagickSizeType *hits,
+%        MagickSizeType *misses)
+%
+%  A description of each parameter follows:
+%
+%    o hits: the number of transforms that reused a cached plan.
+%
+%    o misses: the number of plans created.
+%
+*/
+MagickPrivate void GetFourierPlanStatistics(MagickSizeType *hits,
+  MagickSizeType *misses)
+{
+  if (plan_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&plan_semaphore);
+  LockSemaphoreInfo(plan_semaphore);
+  *hits=plan_hits;
+  *misses=plan_misses;
+  UnlockSemaphoreInfo(plan_semaphore);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %     I n v e r s e F o u r i e r T r a n s f o r m I m a g e                 %
 %                                                                             %
 %                                                                             %
@@ -1329,8 +1719,8 @@ static MagickBooleanType InverseFourierTransform(FourierInfo *fourier_info,
   double
     *source_pixels;
 
-  fftw_plan
-    fftw_c2r_plan;
+  FourierPlanInfo
+    *plan_info;
 
   MemoryInfo
     *source_info;
@@ -1385,13 +1775,17 @@ static MagickBooleanType InverseFourierTransform(FourierInfo *fourier_info,
           i++;
         }
     }
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp critical (MagickCore_InverseFourierTransform)
-#endif
-  fftw_c2r_plan=fftw_plan_dft_c2r_2d((int) fourier_info->width,
-    (int) fourier_info->height,fourier_pixels,source_pixels,FFTW_ESTIMATE);
-  fftw_execute_dft_c2r(fftw_c2r_plan,fourier_pixels,source_pixels);
-  fftw_destroy_plan(fftw_c2r_plan);
+  plan_info=AcquireFourierPlan(image,FFTW_BACKWARD,fourier_info->width,
+    fourier_info->height,source_pixels,fourier_pixels);
+  if (plan_info == (FourierPlanInfo *) NULL)
+    {
+      (void) ThrowMagickException(exception,GetMagickModule(),
+        ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
+      source_info=(MemoryInfo *) RelinquishVirtualMemory(source_info);
+      return(MagickFalse);
+    }
+  fftw_execute_dft_c2r(plan_info->plan,fourier_pixels,source_pixels);
+  plan_info=RelinquishFourierPlan(plan_info);
   i=0L;
   image_view=AcquireAuthenticCacheView(image,exception);
   for (y=0L; y < (ssize_t) fourier_info->height; y++)
@@ -1619,7 +2013,6 @@ MagickExport Image *InverseFourierTransformImage(const Image *magnitude_image,
         if (status == MagickFalse)
           fourier_image=DestroyImage(fourier_image);
       }
-    fftw_cleanup();
   }
 #endif
   return(fourier_image);
@@ -693,6 +693,7 @@ typedef struct {
 
   MagickBooleanType
     do_push,
+    is_immediate, /* Last argument is val rather than from the stack */
     is_relative;
 
   PixelChannel
@@ -1172,6 +1173,7 @@ static MagickBooleanType DumpRPN (FxInfo * pfx, FILE * fh)
     } else if (OprInPlace (pel->operator_index)) {
       fprintf (fh, "  <==> %s", NameOfUserSym (pfx, pel->element_index, UserSym));
     }
+    if (pel->is_immediate)  fprintf (fh, "  imm");
     if (pel->number_dest > 0)  fprintf (fh, "  <==dest(%i)", pel->number_dest);
     fprintf (fh, "\n");
   }
@@ -1281,6 +1283,7 @@ static MagickBooleanType AddElement (FxInfo * pfx, fxFltType val, int oprNum)
   pel->val2 = (fxFltType) 0;
   pel->operator_index = oprNum;
   pel->do_push = MagickTrue;
+  pel->is_immediate = MagickFalse;
   pel->element_index = 0;
   pel->channel_qual = NO_CHAN_QUAL;
   pel->img_attr_qual = aNull;
@@ -3345,7 +3348,7 @@ static MagickBooleanType ExecuteRPN (FxInfo * pfx, fxRtT * pfxrt, fxFltType *res
           regA = PopVal (pfx, pfxrt, i);
           break;
         case 2:
-          regB = PopVal (pfx, pfxrt, i);
+          regB = pel->is_immediate ? pel->val : PopVal (pfx, pfxrt, i);
           regA = PopVal (pfx, pfxrt, i);
           break;
         case 3:
@@ -4163,6 +4166,172 @@ static MagickBooleanType ExecuteRPN (FxInfo * pfx, fxRtT * pfxrt, fxFltType *res
   return MagickTrue;
 }
 
+static inline MagickBooleanType IsPureOpr (int op)
+{
+  /* Operators and functions whose result depends only on their arguments.
+  */
+  if (op >= oAdd && op <= oPow)
+    return (op != oLshift && op != oRshift) ? MagickTrue : MagickFalse;
+  if (op >= (int) FirstFunc && op <= fTrunc)
+    return (op != fChannel && op != fDebug && op != fEpoch &&
+            op != fMagickTime && op != fRand) ? MagickTrue : MagickFalse;
+  return MagickFalse;
+}
+
+static inline MagickBooleanType IsFoldableConstant (ElementT * pel)
+{
+  return (pel->type == etConstant && pel->operator_index == oNull &&
+          pel->do_push && !pel->is_immediate && pel->number_dest == 0) ?
+          MagickTrue : MagickFalse;
+}
+
+static inline MagickBooleanType IsSingleOperand (ElementT * pel)
+{
+  return (pel->number_args == 0 && pel->do_push && !pel->is_immediate &&
+          pel->number_dest == 0 &&
+          (pel->type != etControl || pel->operator_index == rCopyFrom)) ?
+          MagickTrue : MagickFalse;
+}
+
+static MagickBooleanType OptimizeRPN (FxInfo * pfx)
+/* Compile the translated RPN before it runs for every pixel and channel.
+   Pure operators and functions whose arguments are all constants are
+   evaluated once, by ExecuteRPN itself so the result is exact.  A constant
+   second argument of a binary operator or function becomes an immediate
+   operand of that element, saving a push and a pop, and a constant first
+   argument of + or * is commuted into one.  Jump targets are never merged,
+   and jump addresses are remapped as elements are removed.
+*/
+{
+  ElementT * Elements = pfx->Elements;
+  int usedElements = pfx->usedElements;
+  int * newAddr;
+  int i, j;
+  fxRtT fxrt;
+  Quantum pixel[MaxPixelChannels];
+  MagickBooleanType NeedStats = pfx->NeedStats;
+  MagickBooleanType NeedHsl = pfx->NeedHsl;
+  MagickBooleanType status = MagickTrue;
+
+  if (usedElements < 2) return MagickTrue;
+
+  newAddr = (int *) AcquireQuantumMemory ((size_t) usedElements+1, sizeof (*newAddr));
+  if (!newAddr) {
+    (void) ThrowMagickException (
+      pfx->exception, GetMagickModule(), ResourceLimitFatalError,
+      "OptimizeRPN", "%i",
+      usedElements);
+    return MagickFalse;
+  }
+  if (!AllocFxRt (pfx, &fxrt)) {
+    newAddr = (int *) RelinquishMagickMemory (newAddr);
+    return MagickFalse;
+  }
+  (void) memset (pixel, 0, sizeof (pixel));
+  fxrt.thisPixel = pixel;
+  pfx->NeedStats = MagickFalse;
+  pfx->NeedHsl = MagickFalse;
+
+  for (i=0; i < usedElements; i++) Elements[i].number_dest = 0;
+  for (i=0; i < usedElements; i++) {
+    ElementT * pel = &Elements[i];
+    if (pel->operator_index == rGoto || pel->operator_index == rGotoChk ||
+        pel->operator_index == rIfZeroGoto || pel->operator_index == rIfNotZeroGoto) {
+      if (pel->element_index >= 0 && pel->element_index < usedElements)
+        Elements[pel->element_index].number_dest++;
+    }
+  }
+
+  /* Single pass, compacting the elements in place; j is the next output.
+  */
+  j = 0;
+  for (i=0; i < usedElements; i++) {
+    ElementT * pel = &Elements[i];
+    int nArgs = pel->number_args;
+    int k;
+
+    newAddr[i] = j;
+    Elements[j] = *pel;
+    pel = &Elements[j];
+    if (!IsPureOpr (pel->operator_index) || !pel->do_push || pel->number_dest ||
+        nArgs < 1 || nArgs > j) {
+      j++;
+      continue;
+    }
+    for (k=j-nArgs; k < j; k++)
+      if (!IsFoldableConstant (&Elements[k])) break;
+    if (k == j) {
+      fxFltType val;
+
+      pfx->Elements = &Elements[j-nArgs];
+      pfx->usedElements = nArgs+1;
+      fxrt.usedValStack = 0;
+      if (ExecuteRPN (pfx, &fxrt, &val, (PixelChannel) 0, 0, 0)) {
+        ElementT * pelConst = &Elements[j-nArgs];
+
+        *pelConst = *pel;
+        pelConst->type = etConstant;
+        pelConst->operator_index = oNull;
+        pelConst->number_args = 0;
+        pelConst->val = val;
+        newAddr[i] = j-nArgs;
+        j -= nArgs-1;
+        pfx->Elements = Elements;
+        pfx->usedElements = usedElements;
+        continue;
+      }
+      pfx->Elements = Elements;
+      pfx->usedElements = usedElements;
+      if (pfx->exception->severity >= ErrorException) {
+        status = MagickFalse;
+        break;
+      }
+    }
+    if (nArgs == 2 && j >= 2) {
+      ElementT * pelB = &Elements[j-1];
+      ElementT * pelA = &Elements[j-2];
+      if (IsFoldableConstant (pelB)) {
+        /* Constant second argument. */
+        pel->val = pelB->val;
+        pel->is_immediate = MagickTrue;
+        Elements[j-1] = *pel;
+        newAddr[i] = j-1;
+        continue;
+      }
+      if ((pel->operator_index == oAdd || pel->operator_index == oMultiply) &&
+          IsFoldableConstant (pelA) && IsSingleOperand (pelB)) {
+        /* Constant first argument of a commutative operator. */
+        pel->val = pelA->val;
+        pel->is_immediate = MagickTrue;
+        *pelA = *pelB;
+        Elements[j-1] = *pel;
+        newAddr[i] = j-1;
+        continue;
+      }
+    }
+    j++;
+  }
+  newAddr[usedElements] = j;
+
+  if (status) {
+    for (i=0; i < j; i++) {
+      ElementT * pel = &Elements[i];
+      if (pel->operator_index == rGoto || pel->operator_index == rGotoChk ||
+          pel->operator_index == rIfZeroGoto || pel->operator_index == rIfNotZeroGoto) {
+        if (pel->element_index >= 0 && pel->element_index <= usedElements)
+          pel->element_index = newAddr[pel->element_index];
+      }
+    }
+    pfx->usedElements = j;
+  }
+
+  pfx->NeedStats = NeedStats;
+  pfx->NeedHsl = NeedHsl;
+  DestroyFxRt (&fxrt);
+  newAddr = (int *) RelinquishMagickMemory (newAddr);
+  return status;
+}
+
 /* Following is substitute for FxEvaluateChannelExpression().
 */
 MagickPrivate MagickBooleanType FxEvaluateChannelExpression (
@@ -4260,6 +4429,15 @@ static FxInfo *AcquireFxInfoPrivate (const Image * images, const char * expressi
     return NULL;
   }
 
+  if (!OptimizeRPN (pfx)) {
+    (void) DestroyRPN (pfx);
+    pfx->expression = DestroyString (pfx->expression);
+    pfx->pex = NULL;
+    (void) DeInitFx (pfx);
+    pfx = (FxInfo*) RelinquishMagickMemory(pfx);
+    return NULL;
+  }
+
   if (pfx->NeedStats && pfx->runType == rtEntireImage && !pfx->statistics) {
     if (!CollectStatistics (pfx)) {
       (void) DestroyRPN (pfx);
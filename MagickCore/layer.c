@@ -942,6 +942,84 @@ MagickExport Image *CompareImagesLayers(const Image *image,
 
 #define DEBUG_OPT_FRAME 0
 
+typedef struct _FrameBoundsInfo
+{
+  RectangleInfo
+    bounds;
+
+  MagickBooleanType
+    cleared;
+} FrameBoundsInfo;
+
+typedef struct _LayerBoundsInfo
+{
+  Image
+    **frames;
+
+  FrameBoundsInfo
+    *frame_bounds;
+
+  ExceptionInfo
+    *exception;
+} LayerBoundsInfo;
+
+static MagickBooleanType LayerBoundsTask(const ssize_t begin,const ssize_t end,
+  void *context)
+{
+  LayerBoundsInfo
+    *layer_info;
+
+  ssize_t
+    i;
+
+  layer_info=(LayerBoundsInfo *) context;
+  for (i=begin; i < end; i++)
+  {
+    FrameBoundsInfo
+      *frame_bounds;
+
+    frame_bounds=layer_info->frame_bounds+i;
+    frame_bounds->bounds=CompareImagesBounds(layer_info->frames[i-1],
+      layer_info->frames[i],CompareAnyLayer,layer_info->exception);
+    frame_bounds->cleared=IsBoundsCleared(layer_info->frames[i-1],
+      layer_info->frames[i],&frame_bounds->bounds,layer_info->exception);
+  }
+  return(MagickTrue);
+}
+
+static FrameBoundsInfo *AcquireFrameBounds(const Image *image,
+  ExceptionInfo *exception)
+{
+  FrameBoundsInfo
+    *frame_bounds;
+
+  LayerBoundsInfo
+    layer_info;
+
+  size_t
+    number_frames;
+
+  /*
+    The none-disposal bounds of each frame against its predecessor depend
+    only on the input frames, so compute them for all frames concurrently.
+  */
+  number_frames=GetImageListLength(image);
+  frame_bounds=(FrameBoundsInfo *) AcquireQuantumMemory(number_frames,
+    sizeof(*frame_bounds));
+  if (frame_bounds == (FrameBoundsInfo *) NULL)
+    return((FrameBoundsInfo *) NULL);
+  layer_info.frames=ImageListToArray(image,exception);
+  if (layer_info.frames == (Image **) NULL)
+    return((FrameBoundsInfo *) RelinquishMagickMemory(frame_bounds));
+  layer_info.frame_bounds=frame_bounds;
+  layer_info.exception=exception;
+  (void) ExecuteMagickTasks(1,(ssize_t) number_frames,1,
+    GetMagickNumberThreads(image,image,(number_frames-1)*image->rows,1),
+    LayerBoundsTask,&layer_info);
+  layer_info.frames=(Image **) RelinquishMagickMemory(layer_info.frames);
+  return(frame_bounds);
+}
+
 static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
   ExceptionInfo *exception)
 {
@@ -954,6 +1032,9 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
   ExceptionInfo
     *sans_exception;
 
+  FrameBoundsInfo
+    *frame_bounds;
+
   Image
     *prev_image,
     *dup_image,
@@ -972,7 +1053,8 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
     cleared;
 
   ssize_t
-    i;
+    i,
+    n;
 
   assert(image != (const Image *) NULL);
   assert(image->signature == MagickCoreSignature);
@@ -1018,12 +1100,20 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
       bounds=(RectangleInfo *) RelinquishMagickMemory(bounds);
       ThrowImageException(ResourceLimitError,"MemoryAllocationFailed");
     }
+  frame_bounds=AcquireFrameBounds(curr,exception);
+  if (frame_bounds == (FrameBoundsInfo *) NULL)
+    {
+      bounds=(RectangleInfo *) RelinquishMagickMemory(bounds);
+      disposals=(DisposeType *) RelinquishMagickMemory(disposals);
+      ThrowImageException(ResourceLimitError,"MemoryAllocationFailed");
+    }
   /*
     Initialise Previous Image as fully transparent
   */
   prev_image=CloneImage(curr,curr->columns,curr->rows,MagickTrue,exception);
   if (prev_image == (Image *) NULL)
     {
+      frame_bounds=(FrameBoundsInfo *) RelinquishMagickMemory(frame_bounds);
       bounds=(RectangleInfo *) RelinquishMagickMemory(bounds);
       disposals=(DisposeType *) RelinquishMagickMemory(disposals);
       return((Image *) NULL);
@@ -1054,6 +1144,7 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
     Compute the bounding box of changes for each pair of images.
   */
   i=1;
+  n=0;
   bgnd_image=(Image *) NULL;
   dup_image=(Image *) NULL;
   dup_bounds.width=0;
@@ -1069,8 +1160,9 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
     /*
       Assume none disposal is the best
     */
-    bounds[i]=CompareImagesBounds(curr->previous,curr,CompareAnyLayer,exception);
-    cleared=IsBoundsCleared(curr->previous,curr,&bounds[i],exception);
+    n++;
+    bounds[i]=frame_bounds[n].bounds;
+    cleared=frame_bounds[n].cleared;
     disposals[i-1]=NoneDispose;
 #if DEBUG_OPT_FRAME
     (void) FormatLocaleFile(stderr, "overlay: %.17gx%.17g%+.20g%+.20g%s%s\n",
@@ -1132,6 +1224,8 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
             dup_image=CloneImage(curr->previous,0,0,MagickTrue,exception);
             if (dup_image == (Image *) NULL)
               {
+                frame_bounds=(FrameBoundsInfo *)
+                  RelinquishMagickMemory(frame_bounds);
                 bounds=(RectangleInfo *) RelinquishMagickMemory(bounds);
                 disposals=(DisposeType *) RelinquishMagickMemory(disposals);
                 prev_image=DestroyImage(prev_image);
@@ -1160,6 +1254,8 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
         bgnd_image=CloneImage(curr->previous,0,0,MagickTrue,exception);
         if (bgnd_image == (Image *) NULL)
           {
+            frame_bounds=(FrameBoundsInfo *)
+              RelinquishMagickMemory(frame_bounds);
             bounds=(RectangleInfo *) RelinquishMagickMemory(bounds);
             disposals=(DisposeType *) RelinquishMagickMemory(disposals);
             prev_image=DestroyImage(prev_image);
@@ -1320,6 +1416,8 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
             prev_image=ReferenceImage(curr->previous);
             if (prev_image == (Image *) NULL)
               {
+                frame_bounds=(FrameBoundsInfo *)
+                  RelinquishMagickMemory(frame_bounds);
                 bounds=(RectangleInfo *) RelinquishMagickMemory(bounds);
                 disposals=(DisposeType *) RelinquishMagickMemory(disposals);
                 return((Image *) NULL);
@@ -1346,6 +1444,7 @@ static Image *OptimizeLayerFrames(const Image *image,const LayerMethod method,
 #endif
     i++;
   }
+  frame_bounds=(FrameBoundsInfo *) RelinquishMagickMemory(frame_bounds);
   prev_image=DestroyImage(prev_image);
   /*
     Optimize all images in sequence.
@@ -53,14 +53,17 @@
 #include "MagickCore/constitute-private.h"
 #include "MagickCore/delegate-private.h"
 #include "MagickCore/draw.h"
+#include "MagickCore/draw-private.h"
 #include "MagickCore/exception.h"
 #include "MagickCore/exception-private.h"
+#include "MagickCore/fourier-private.h"
 #include "MagickCore/locale-private.h"
 #include "MagickCore/log-private.h"
 #include "MagickCore/magic-private.h"
 #include "MagickCore/magick.h"
 #include "MagickCore/magick-private.h"
 #include "MagickCore/memory_.h"
+#include "MagickCore/memory-private.h"
 #include "MagickCore/mime-private.h"
 #include "MagickCore/monitor-private.h"
 #include "MagickCore/module.h"
@@ -73,10 +76,13 @@
 #include "MagickCore/random-private.h"
 #include "MagickCore/registry.h"
 #include "MagickCore/registry-private.h"
+#include "MagickCore/resize.h"
+#include "MagickCore/resize-private.h"
 #include "MagickCore/resource_.h"
 #include "MagickCore/resource-private.h"
 #include "MagickCore/policy.h"
 #include "MagickCore/policy-private.h"
+#include "MagickCore/profile-private.h"
 #include "MagickCore/mutex.h"
 #include "MagickCore/semaphore.h"
 #include "MagickCore/semaphore-private.h"
@@ -415,6 +421,40 @@ MagickExport MagickBooleanType GetMagickDecoderSeekableStream(
   return(MagickTrue);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t M a g i c k D e c o d e r S i z e H i n t                           %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMagickDecoderSizeHint() returns MagickTrue if the decoder can honor the
+%  decode:size hint by decoding at a reduced resolution.
+%
+%  The format of the GetMagickDecoderSizeHint method is:
+%
+%      MagickBooleanType GetMagickDecoderSizeHint(
+%        const MagickInfo *magick_info)
+%
+%  A description of each parameter follows:
+%
+%    o magick_info:  The magick info.
+%
+*/
+MagickExport MagickBooleanType GetMagickDecoderSizeHint(
+  const MagickInfo *magick_info)
+{
+  assert(magick_info != (MagickInfo *) NULL);
+  assert(magick_info->signature == MagickCoreSignature);
+  if ((magick_info->flags & CoderDecoderSizeHintFlag) == 0)
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -1591,6 +1631,10 @@ MagickExport void MagickCoreGenesis(const char *path,
   (void) XComponentGenesis();
 #endif
   (void) RegistryComponentGenesis();
+  (void) ProfileComponentGenesis();
+  (void) ResizeComponentGenesis();
+  (void) FourierComponentGenesis();
+  (void) DrawComponentGenesis();
   (void) MonitorComponentGenesis();
   magickcore_instantiated=MagickTrue;
   UnlockMagickMutex();
@@ -1645,7 +1689,12 @@ MagickExport void MagickCoreTerminus(void)
       UnlockMagickMutex();
       return;
     }
+  ThreadComponentTerminus();
   MonitorComponentTerminus();
+  DrawComponentTerminus();
+  FourierComponentTerminus();
+  ResizeComponentTerminus();
+  ProfileComponentTerminus();
   RegistryComponentTerminus();
   AnnotateComponentTerminus();
   MimeComponentTerminus();
@@ -1678,6 +1727,7 @@ MagickExport void MagickCoreTerminus(void)
   LocaleComponentTerminus();
   LogComponentTerminus();
   ExceptionComponentTerminus();
+  MemoryComponentTerminus();
   magickcore_instantiated=MagickFalse;
   UnlockMagickMutex();
   SemaphoreComponentTerminus();
@@ -52,7 +52,8 @@ typedef enum
   CoderUseExtensionFlag = 0x0100,
   CoderDecoderSeekableStreamFlag = 0x0200,
   CoderEncoderSeekableStreamFlag = 0x0400,
-  CoderExplicitAllowedFlag = 0x0800
+  CoderExplicitAllowedFlag = 0x0800,
+  CoderDecoderSizeHintFlag = 0x1000
 } MagickInfoFlag;
 
 typedef Image
@@ -127,6 +128,7 @@ extern MagickExport MagickBooleanType
   GetMagickBlobSupport(const MagickInfo *) magick_attribute((__pure__)),
   GetMagickDecoderSeekableStream(const MagickInfo *)
     magick_attribute((__pure__)),
+  GetMagickDecoderSizeHint(const MagickInfo *) magick_attribute((__pure__)),
   GetMagickDecoderThreadSupport(const MagickInfo *)
     magick_attribute((__pure__)),
   GetMagickEncoderSeekableStream(const MagickInfo *)
@@ -72,7 +72,13 @@ extern MagickPrivate MagickBooleanType
   ShredMagickMemory(void *,const size_t);
 
 extern MagickPrivate void
+  *AcquireArenaMemory(const size_t,const size_t) magick_attribute((__malloc__))
+    magick_alloc_sizes(1,2),
+  AdviseHugePageMemory(void *,const size_t),
+  MemoryComponentTerminus(void),
+  *RelinquishArenaMemory(void *),
   ResetVirtualAnonymousMemory(void),
+  SetHugePageThreshold(const MagickSizeType),
   SetMaxMemoryRequest(const MagickSizeType),
   SetMaxProfileSize(const MagickSizeType);
 
@@ -38,6 +38,7 @@ extern "C" {
   EvaluateMagickPrefix(MAGICKCORE_NAMESPACE_PREFIX,method)
 
 #define AcquireAlignedMemory  PrependMagickMethod(AcquireAlignedMemory)
+#define AcquireArenaMemory  PrependMagickMethod(AcquireArenaMemory)
 #define AcquireAuthenticCacheView  PrependMagickMethod(AcquireAuthenticCacheView)
 #define AcquireCriticalMemory  PrependMagickMethod(AcquireCriticalMemory)
 #define AcquireCustomStreamInfo  PrependMagickMethod(AcquireCustomStreamInfo)
@@ -88,6 +89,7 @@ extern "C" {
 #define AddNoiseImage  PrependMagickMethod(AddNoiseImage)
 #define AddPathToXMLTree  PrependMagickMethod(AddPathToXMLTree)
 #define AddValueToSplayTree  PrependMagickMethod(AddValueToSplayTree)
+#define AdviseHugePageMemory  PrependMagickMethod(AdviseHugePageMemory)
 #define AffineTransformImage  PrependMagickMethod(AffineTransformImage)
 #define analyzeImage  PrependMagickMethod(analyzeImage)
 #define AnimateImages  PrependMagickMethod(AnimateImages)
@@ -298,6 +300,8 @@ extern "C" {
 #define DistributePixelCacheServer  PrependMagickMethod(DistributePixelCacheServer)
 #define DrawAffineImage  PrependMagickMethod(DrawAffineImage)
 #define DrawClipPath  PrependMagickMethod(DrawClipPath)
+#define DrawComponentGenesis  PrependMagickMethod(DrawComponentGenesis)
+#define DrawComponentTerminus  PrependMagickMethod(DrawComponentTerminus)
 #define DrawGradientImage  PrependMagickMethod(DrawGradientImage)
 #define DrawImage  PrependMagickMethod(DrawImage)
 #define DrawPatternPath  PrependMagickMethod(DrawPatternPath)
@@ -316,6 +320,7 @@ extern "C" {
 #define EscapeString  PrependMagickMethod(EscapeString)
 #define EvaluateImage  PrependMagickMethod(EvaluateImage)
 #define EvaluateImages  PrependMagickMethod(EvaluateImages)
+#define ExecuteMagickTasks  PrependMagickMethod(ExecuteMagickTasks)
 #define ExceptionComponentGenesis  PrependMagickMethod(ExceptionComponentGenesis)
 #define ExceptionComponentTerminus  PrependMagickMethod(ExceptionComponentTerminus)
 #define ExcerptImage  PrependMagickMethod(ExcerptImage)
@@ -344,6 +349,8 @@ extern "C" {
 #define FormatMagickSize  PrependMagickMethod(FormatMagickSize)
 #define FormatMagickTime  PrependMagickMethod(FormatMagickTime)
 #define ForwardFourierTransformImage  PrependMagickMethod(ForwardFourierTransformImage)
+#define FourierComponentGenesis  PrependMagickMethod(FourierComponentGenesis)
+#define FourierComponentTerminus  PrependMagickMethod(FourierComponentTerminus)
 #define FrameImage  PrependMagickMethod(FrameImage)
 #define FunctionImage  PrependMagickMethod(FunctionImage)
 #define FxEvaluateChannelExpression  PrependMagickMethod(FxEvaluateChannelExpression)
@@ -405,11 +412,13 @@ extern "C" {
 #define GetDistributeCacheHostname  PrependMagickMethod(GetDistributeCacheHostname)
 #define GetDistributeCachePort  PrependMagickMethod(GetDistributeCachePort)
 #define GetDrawInfo  PrependMagickMethod(GetDrawInfo)
+#define GetDrawPathStatistics  PrependMagickMethod(GetDrawPathStatistics)
 #define GetElapsedTime  PrependMagickMethod(GetElapsedTime)
 #define GetEnvironmentValue  PrependMagickMethod(GetEnvironmentValue)
 #define GetExceptionMessage  PrependMagickMethod(GetExceptionMessage)
 #define GetExecutionPath  PrependMagickMethod(GetExecutionPath)
 #define GetFirstImageInList  PrependMagickMethod(GetFirstImageInList)
+#define GetFourierPlanStatistics  PrependMagickMethod(GetFourierPlanStatistics)
 #define GetGeometry  PrependMagickMethod(GetGeometry)
 #define GetHeadElementInLinkedList  PrependMagickMethod(GetHeadElementInLinkedList)
 #define GetImageAlphaChannel  PrependMagickMethod(GetImageAlphaChannel)
@@ -481,6 +490,7 @@ extern "C" {
 #define GetMagickBlobSupport  PrependMagickMethod(GetMagickBlobSupport)
 #define GetMagickCopyright  PrependMagickMethod(GetMagickCopyright)
 #define GetMagickDecoderSeekableStream  PrependMagickMethod(GetMagickDecoderSeekableStream)
+#define GetMagickDecoderSizeHint  PrependMagickMethod(GetMagickDecoderSizeHint)
 #define GetMagickDecoderThreadSupport  PrependMagickMethod(GetMagickDecoderThreadSupport)
 #define GetMagickDelegates  PrependMagickMethod(GetMagickDelegates)
 #define GetMagickDescription  PrependMagickMethod(GetMagickDescription)
@@ -510,6 +520,8 @@ extern "C" {
 #define GetMagickSeekableStream  PrependMagickMethod(GetMagickSeekableStream)
 #define GetMagickSignature  PrependMagickMethod(GetMagickSignature)
 #define GetMagickStealth  PrependMagickMethod(GetMagickStealth)
+#define GetMagickTaskId  PrependMagickMethod(GetMagickTaskId)
+#define GetMagickTaskThreads  PrependMagickMethod(GetMagickTaskThreads)
 #define GetMagickThreadValue  PrependMagickMethod(GetMagickThreadValue)
 #define GetMagickTime  PrependMagickMethod(GetMagickTime)
 #define GetMagickUseExtension  PrependMagickMethod(GetMagickUseExtension)
@@ -580,6 +592,7 @@ extern "C" {
 #define GetPolicyList  PrependMagickMethod(GetPolicyList)
 #define GetPolicyValue  PrependMagickMethod(GetPolicyValue)
 #define GetPreviousImageInList  PrependMagickMethod(GetPreviousImageInList)
+#define GetProfileTransformStatistics  PrependMagickMethod(GetProfileTransformStatistics)
 #define GetPseudoRandomValue  PrependMagickMethod(GetPseudoRandomValue)
 #define GetQuantizeInfo  PrependMagickMethod(GetQuantizeInfo)
 #define GetQuantumEndian  PrependMagickMethod(GetQuantumEndian)
@@ -761,6 +774,7 @@ extern "C" {
 #define MapBlob  PrependMagickMethod(MapBlob)
 #define MatrixToImage  PrependMagickMethod(MatrixToImage)
 #define MeanShiftImage  PrependMagickMethod(MeanShiftImage)
+#define MemoryComponentTerminus  PrependMagickMethod(MemoryComponentTerminus)
 #define MergeImageLayers  PrependMagickMethod(MergeImageLayers)
 #define MimeComponentGenesis  PrependMagickMethod(MimeComponentGenesis)
 #define MimeComponentTerminus  PrependMagickMethod(MimeComponentTerminus)
@@ -827,6 +841,8 @@ extern "C" {
 #define PreviewImage  PrependMagickMethod(PreviewImage)
 #define PrintStringInfo  PrependMagickMethod(PrintStringInfo)
 #define process_message  PrependMagickMethod(process_message)
+#define ProfileComponentGenesis  PrependMagickMethod(ProfileComponentGenesis)
+#define ProfileComponentTerminus  PrependMagickMethod(ProfileComponentTerminus)
 #define ProfileImage  PrependMagickMethod(ProfileImage)
 #define QuantizeImage  PrependMagickMethod(QuantizeImage)
 #define QuantizeImages  PrependMagickMethod(QuantizeImages)
@@ -1013,6 +1029,7 @@ extern "C" {
 #define RegistryComponentGenesis  PrependMagickMethod(RegistryComponentGenesis)
 #define RegistryComponentTerminus  PrependMagickMethod(RegistryComponentTerminus)
 #define RelinquishAlignedMemory  PrependMagickMethod(RelinquishAlignedMemory)
+#define RelinquishArenaMemory  PrependMagickMethod(RelinquishArenaMemory)
 #define RelinquishDistributePixelCache  PrependMagickMethod(RelinquishDistributePixelCache)
 #define RelinquishMagickMatrix  PrependMagickMethod(RelinquishMagickMatrix)
 #define RelinquishMagickMemory  PrependMagickMethod(RelinquishMagickMemory)
@@ -1103,6 +1120,7 @@ extern "C" {
 #define SetGeometryInfo  PrependMagickMethod(SetGeometryInfo)
 #define SetGeometry  PrependMagickMethod(SetGeometry)
 #define SetHeadElementInLinkedList  PrependMagickMethod(SetHeadElementInLinkedList)
+#define SetHugePageThreshold  PrependMagickMethod(SetHugePageThreshold)
 #define SetImageAlphaChannel  PrependMagickMethod(SetImageAlphaChannel)
 #define SetImageAlpha  PrependMagickMethod(SetImageAlpha)
 #define SetImageArtifact  PrependMagickMethod(SetImageArtifact)
@@ -1235,6 +1253,7 @@ extern "C" {
 #define SyncNextImageInList  PrependMagickMethod(SyncNextImageInList)
 #define TellBlob  PrependMagickMethod(TellBlob)
 #define TextureImage  PrependMagickMethod(TextureImage)
+#define ThreadComponentTerminus  PrependMagickMethod(ThreadComponentTerminus)
 #define ThrowMagickExceptionList  PrependMagickMethod(ThrowMagickExceptionList)
 #define ThrowMagickException  PrependMagickMethod(ThrowMagickException)
 #define ThumbnailImage  PrependMagickMethod(ThumbnailImage)
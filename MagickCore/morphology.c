@@ -2537,6 +2537,324 @@ static void CalcKernelMetaData(KernelInfo *kernel)
 %    o exception: return any errors or warnings in this structure.
 %
 */
+/*
+  Erode and dilate with a rectangular kernel whose elements are all set
+  reduce to a running minimum or maximum along the rows, then along the
+  columns.  MorphologyRectangle() computes these with the van Herk/Gil-Werman
+  algorithm, so the cost per pixel no longer depends on the kernel size.  It
+  returns the same results as MorphologyPrimitive().
+*/
+
+static MagickBooleanType IsRectangleKernel(const Image *image,
+  const MorphologyMethod method,const KernelInfo *kernel)
+{
+  ssize_t
+    i;
+
+  if ((method != ErodeMorphology) && (method != DilateMorphology))
+    return(MagickFalse);
+  if ((kernel->width*kernel->height) <= 9)
+    return(MagickFalse);
+  switch (GetImageVirtualPixelMethod(image))
+  {
+    case UndefinedVirtualPixelMethod:
+    case BackgroundVirtualPixelMethod:
+    case EdgeVirtualPixelMethod:
+    case MirrorVirtualPixelMethod:
+    case TileVirtualPixelMethod:
+    case TransparentVirtualPixelMethod:
+    case BlackVirtualPixelMethod:
+    case GrayVirtualPixelMethod:
+    case WhiteVirtualPixelMethod:
+      break;
+    default:
+      return(MagickFalse);
+  }
+  for (i=0; i < (ssize_t) (kernel->width*kernel->height); i++)
+  {
+    if (IsNaN(kernel->values[i]) != 0)
+      return(MagickFalse);
+    if ((method == ErodeMorphology) && (kernel->values[i] < 0.5))
+      return(MagickFalse);
+    if ((method == DilateMorphology) && (kernel->values[i] <= 0.5))
+      return(MagickFalse);
+  }
+  return(MagickTrue);
+}
+
+static MagickBooleanType MorphologyRectanglePass(const Image *image,
+  const Image *reference,Image *morphology_image,const MorphologyMethod method,
+  const size_t window,const ssize_t origin,const MagickBooleanType vertical,
+  size_t *changes,MagickOffsetType *progress,const MagickSizeType span,
+  ExceptionInfo *exception)
+{
+#define MorphologyTag  "Morphology/Image"
+
+  CacheView
+    *image_view,
+    *morphology_view,
+    *reference_view;
+
+  double
+    *buffers;
+
+  MagickBooleanType
+    status;
+
+  MemoryInfo
+    *buffer_info;
+
+  size_t
+    channels,
+    extent,
+    length,
+    lines;
+
+  ssize_t
+    line;
+
+  length=vertical != MagickFalse ? image->rows : image->columns;
+  lines=vertical != MagickFalse ? image->columns : image->rows;
+  channels=GetPixelChannels(image);
+  extent=3*(length+window-1)*channels;
+  buffer_info=AcquireVirtualMemory(GetOpenMPMaximumThreads()*extent,
+    sizeof(*buffers));
+  if (buffer_info == (MemoryInfo *) NULL)
+    ThrowBinaryException(ResourceLimitError,"MemoryAllocationFailed",
+      image->filename);
+  buffers=(double *) GetVirtualMemoryBlob(buffer_info);
+  status=MagickTrue;
+  image_view=AcquireVirtualCacheView(image,exception);
+  reference_view=AcquireVirtualCacheView(reference,exception);
+  morphology_view=AcquireAuthenticCacheView(morphology_image,exception);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static) shared(progress,status) \
+    magick_number_threads(image,morphology_image,lines,1)
+#endif
+  for (line=0; line < (ssize_t) lines; line++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    const Quantum
+      *magick_restrict p,
+      *magick_restrict r;
+
+    double
+      *magick_restrict f,
+      *magick_restrict g,
+      *magick_restrict h;
+
+    Quantum
+      *magick_restrict q;
+
+    ssize_t
+      i,
+      j,
+      n;
+
+    if (status == MagickFalse)
+      continue;
+    if (vertical != MagickFalse)
+      {
+        p=GetCacheViewVirtualPixels(image_view,line,-origin,1,length+window-1,
+          exception);
+        r=GetCacheViewVirtualPixels(reference_view,line,0,1,length,exception);
+        q=GetCacheViewAuthenticPixels(morphology_view,line,0,1,length,
+          exception);
+      }
+    else
+      {
+        p=GetCacheViewVirtualPixels(image_view,-origin,line,length+window-1,1,
+          exception);
+        r=GetCacheViewVirtualPixels(reference_view,0,line,length,1,exception);
+        q=GetCacheViewAuthenticPixels(morphology_view,0,line,length,1,
+          exception);
+      }
+    if ((p == (const Quantum *) NULL) || (r == (const Quantum *) NULL) ||
+        (q == (Quantum *) NULL))
+      {
+        status=MagickFalse;
+        continue;
+      }
+    /*
+      Minimum (or maximum) from the start of each block of window pixels (g)
+      and to the end of it (h); any window spans at most two blocks.
+    */
+    n=(ssize_t) (length+window-1);
+    f=buffers+(size_t) id*extent;
+    g=f+n*(ssize_t) channels;
+    h=g+n*(ssize_t) channels;
+    for (i=0; i < (n*(ssize_t) channels); i++)
+      f[i]=(double) p[i];
+    for (j=0; j < n; j++)
+      for (i=0; i < (ssize_t) channels; i++)
+      {
+        ssize_t
+          k = j*(ssize_t) channels+i;
+
+        if ((j % (ssize_t) window) == 0)
+          g[k]=f[k];
+        else
+          if (method == ErodeMorphology)
+            g[k]=MagickMin(g[k-(ssize_t) channels],f[k]);
+          else
+            g[k]=MagickMax(g[k-(ssize_t) channels],f[k]);
+      }
+    for (j=n-1; j >= 0; j--)
+      for (i=0; i < (ssize_t) channels; i++)
+      {
+        ssize_t
+          k = j*(ssize_t) channels+i;
+
+        if ((j == (n-1)) || ((j % (ssize_t) window) == (ssize_t) (window-1)))
+          h[k]=f[k];
+        else
+          if (method == ErodeMorphology)
+            h[k]=MagickMin(h[k+(ssize_t) channels],f[k]);
+          else
+            h[k]=MagickMax(h[k+(ssize_t) channels],f[k]);
+      }
+    for (j=0; j < (ssize_t) length; j++)
+    {
+      for (i=0; i < (ssize_t) channels; i++)
+      {
+        double
+          pixel;
+
+        PixelChannel
+          channel;
+
+        PixelTrait
+          morphology_traits,
+          traits;
+
+        ssize_t
+          k = j*(ssize_t) channels+i;
+
+        channel=GetPixelChannelChannel(image,i);
+        traits=GetPixelChannelTraits(image,channel);
+        morphology_traits=GetPixelChannelTraits(morphology_image,channel);
+        if ((traits == UndefinedPixelTrait) ||
+            (morphology_traits == UndefinedPixelTrait))
+          continue;
+        if ((traits & CopyPixelTrait) != 0)
+          {
+            SetPixelChannel(morphology_image,channel,r[i],q);
+            continue;
+          }
+        if (method == ErodeMorphology)
+          pixel=MagickMin(h[k],g[k+(ssize_t) (window-1)*(ssize_t) channels]);
+        else
+          pixel=MagickMax(MagickMax(h[k],g[k+(ssize_t) (window-1)*(ssize_t)
+            channels]),0.0);
+        SetPixelChannel(morphology_image,channel,ClampToQuantum(pixel),q);
+        if ((changes != (size_t *) NULL) &&
+            (fabs(pixel-(double) r[i]) >= MagickEpsilon))
+          changes[id]++;
+      }
+      r+=(ptrdiff_t) GetPixelChannels(reference);
+      q+=(ptrdiff_t) GetPixelChannels(morphology_image);
+    }
+    if (SyncCacheViewAuthenticPixels(morphology_view,exception) == MagickFalse)
+      status=MagickFalse;
+    if (image->progress_monitor != (MagickProgressMonitor) NULL)
+      {
+        MagickBooleanType
+          proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+        #pragma omp atomic
+#endif
+        (*progress)++;
+        proceed=SetImageProgress(image,MorphologyTag,*progress,span);
+        if (proceed == MagickFalse)
+          status=MagickFalse;
+      }
+  }
+  morphology_view=DestroyCacheView(morphology_view);
+  reference_view=DestroyCacheView(reference_view);
+  image_view=DestroyCacheView(image_view);
+  buffer_info=RelinquishVirtualMemory(buffer_info);
+  return(status);
+}
+
+static ssize_t MorphologyRectangle(const Image *image,Image *morphology_image,
+  const MorphologyMethod method,const KernelInfo *kernel,
+  ExceptionInfo *exception)
+{
+  Image
+    *pass_image;
+
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    progress;
+
+  MagickSizeType
+    span;
+
+  OffsetInfo
+    offset;
+
+  size_t
+    changed,
+    *changes;
+
+  ssize_t
+    j;
+
+  /*
+    Dilate uses the kernel reflected about its origin.
+  */
+  offset.x=kernel->x;
+  offset.y=kernel->y;
+  if (method == DilateMorphology)
+    {
+      offset.x=(ssize_t) kernel->width-kernel->x-1;
+      offset.y=(ssize_t) kernel->height-kernel->y-1;
+    }
+  changes=(size_t *) AcquireArenaMemory(GetOpenMPMaximumThreads(),
+    sizeof(*changes));
+  if (changes == (size_t *) NULL)
+    ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
+  for (j=0; j < (ssize_t) GetOpenMPMaximumThreads(); j++)
+    changes[j]=0;
+  progress=0;
+  span=(MagickSizeType) (kernel->height > 1 ? image->columns : 0)+
+    (MagickSizeType) (kernel->width > 1 ? image->rows : 0);
+  if (kernel->height == 1)
+    status=MorphologyRectanglePass(image,image,morphology_image,method,
+      kernel->width,offset.x,MagickFalse,changes,&progress,span,exception);
+  else
+    if (kernel->width == 1)
+      status=MorphologyRectanglePass(image,image,morphology_image,method,
+        kernel->height,offset.y,MagickTrue,changes,&progress,span,exception);
+    else
+      {
+        pass_image=CloneImage(morphology_image,0,0,MagickTrue,exception);
+        if (pass_image == (Image *) NULL)
+          {
+            changes=(size_t *) RelinquishArenaMemory(changes);
+            return(-1);
+          }
+        status=MorphologyRectanglePass(image,image,pass_image,method,
+          kernel->width,offset.x,MagickFalse,(size_t *) NULL,&progress,span,
+          exception);
+        if (status != MagickFalse)
+          status=MorphologyRectanglePass(pass_image,image,morphology_image,
+            method,kernel->height,offset.y,MagickTrue,changes,&progress,span,
+            exception);
+        pass_image=DestroyImage(pass_image);
+      }
+  changed=0;
+  for (j=0; j < (ssize_t) GetOpenMPMaximumThreads(); j++)
+    changed+=changes[j];
+  changes=(size_t *) RelinquishArenaMemory(changes);
+  return(status ? (ssize_t) (changed/GetImageChannels(image)) : -1);
+}
+
 static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
   const MorphologyMethod method,const KernelInfo *kernel,const double bias,
   ExceptionInfo *exception)
@@ -2577,6 +2895,9 @@ static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
   assert(kernel->signature == MagickCoreSignature);
   assert(exception != (ExceptionInfo *) NULL);
   assert(exception->signature == MagickCoreSignature);
+  if (IsRectangleKernel(image,method,kernel) != MagickFalse)
+    return(MorphologyRectangle(image,morphology_image,method,kernel,
+      exception));
   status=MagickTrue;
   progress=0;
   image_view=AcquireVirtualCacheView(image,exception);
@@ -2619,7 +2940,7 @@ static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
     }
   }
   changed=0;
-  changes=(size_t *) AcquireQuantumMemory(GetOpenMPMaximumThreads(),
+  changes=(size_t *) AcquireArenaMemory(GetOpenMPMaximumThreads(),
     sizeof(*changes));
   if (changes == (size_t *) NULL)
     ThrowFatalException(ResourceLimitFatalError,"MemoryAllocationFailed");
@@ -2776,7 +3097,7 @@ static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
       image_view=DestroyCacheView(image_view);
       for (j=0; j < (ssize_t) GetOpenMPMaximumThreads(); j++)
         changed+=changes[j];
-      changes=(size_t *) RelinquishMagickMemory(changes);
+      changes=(size_t *) RelinquishArenaMemory(changes);
       return(status ? (ssize_t) (changed/GetImageChannels(image)) : 0);
     }
   /*
@@ -3196,7 +3517,7 @@ static ssize_t MorphologyPrimitive(const Image *image,Image *morphology_image,
   image_view=DestroyCacheView(image_view);
   for (j=0; j < (ssize_t) GetOpenMPMaximumThreads(); j++)
     changed+=changes[j];
-  changes=(size_t *) RelinquishMagickMemory(changes);
+  changes=(size_t *) RelinquishArenaMemory(changes);
   return(status ? (ssize_t) (changed/GetImageChannels(image)) : -1);
 }
 
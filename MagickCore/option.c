@@ -1019,6 +1019,8 @@ static const OptionInfo
     { "-page", 1L, ImageInfoOptionFlag, MagickFalse },
     { "+paint", 0L, DeprecateOptionFlag, MagickTrue },
     { "-paint", 1L, SimpleOperatorFlag, MagickFalse },
+    { "+parallel-images", 0L, NonMagickOptionFlag, MagickFalse },
+    { "-parallel-images", 1L, NonMagickOptionFlag, MagickFalse },
     { "+path", 0L, NonMagickOptionFlag, MagickFalse },
     { "-path", 1L, NonMagickOptionFlag, MagickFalse },
     { "+pause", 0L, NonMagickOptionFlag, MagickFalse },
@@ -53,6 +53,8 @@
 #include "MagickCore/exception-private.h"
 #include "MagickCore/gem.h"
 #include "MagickCore/gem-private.h"
+#include "MagickCore/memory_.h"
+#include "MagickCore/memory-private.h"
 #include "MagickCore/monitor.h"
 #include "MagickCore/monitor-private.h"
 #include "MagickCore/option.h"
@@ -109,6 +111,100 @@
 %    o exception: return any errors or warnings in this structure.
 %
 */
+typedef struct _FloodfillInfo
+{
+  CacheView
+    *floodplane_view,
+    *image_view;
+
+  const DrawInfo
+    *draw_info;
+
+  ExceptionInfo
+    *exception;
+
+  Image
+    *floodplane_image,
+    *image;
+} FloodfillInfo;
+
+static MagickBooleanType FloodfillTask(const ssize_t begin,const ssize_t end,
+  void *context)
+{
+  CacheView
+    *floodplane_view,
+    *image_view;
+
+  const DrawInfo
+    *draw_info;
+
+  ExceptionInfo
+    *exception;
+
+  FloodfillInfo
+    *fill_info;
+
+  Image
+    *floodplane_image,
+    *image;
+
+  ssize_t
+    y;
+
+  fill_info=(FloodfillInfo *) context;
+  draw_info=fill_info->draw_info;
+  image=fill_info->image;
+  floodplane_image=fill_info->floodplane_image;
+  image_view=fill_info->image_view;
+  floodplane_view=fill_info->floodplane_view;
+  exception=fill_info->exception;
+  for (y=begin; y < end; y++)
+  {
+    const Quantum
+      *magick_restrict p;
+
+    Quantum
+      *magick_restrict q;
+
+    ssize_t
+      x;
+
+    /*
+      Tile fill color onto floodplane.
+    */
+    p=GetCacheViewVirtualPixels(floodplane_view,0,y,image->columns,1,exception);
+    q=GetCacheViewAuthenticPixels(image_view,0,y,image->columns,1,exception);
+    if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
+      return(MagickFalse);
+    for (x=0; x < (ssize_t) image->columns; x++)
+    {
+      if (GetPixelGray(floodplane_image,p) != 0)
+        {
+          PixelInfo
+            fill_color;
+
+          GetFillColor(draw_info,x,y,&fill_color,exception);
+          if ((image->channel_mask & RedChannel) != 0)
+            SetPixelRed(image,(Quantum) fill_color.red,q);
+          if ((image->channel_mask & GreenChannel) != 0)
+            SetPixelGreen(image,(Quantum) fill_color.green,q);
+          if ((image->channel_mask & BlueChannel) != 0)
+            SetPixelBlue(image,(Quantum) fill_color.blue,q);
+          if ((image->channel_mask & BlackChannel) != 0)
+            SetPixelBlack(image,(Quantum) fill_color.black,q);
+          if (((image->channel_mask & AlphaChannel) != 0) &&
+              ((image->alpha_trait & BlendPixelTrait) != 0))
+            SetPixelAlpha(image,(Quantum) fill_color.alpha,q);
+        }
+      p+=(ptrdiff_t) GetPixelChannels(floodplane_image);
+      q+=(ptrdiff_t) GetPixelChannels(image);
+    }
+    if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
+      return(MagickFalse);
+  }
+  return(MagickTrue);
+}
+
 MagickExport MagickBooleanType FloodfillPaintImage(Image *image,
   const DrawInfo *draw_info,const PixelInfo *target,const ssize_t x_offset,
   const ssize_t y_offset,const MagickBooleanType invert,
@@ -142,6 +238,9 @@ MagickExport MagickBooleanType FloodfillPaintImage(Image *image,
     *floodplane_view,
     *image_view;
 
+  FloodfillInfo
+    fill_info;
+
   Image
     *floodplane_image;
 
@@ -323,60 +422,14 @@ MagickExport MagickBooleanType FloodfillPaintImage(Image *image,
       start=x;
     } while (x <= x2);
   }
-  status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(static) shared(status) \
-    magick_number_threads(floodplane_image,image,image->rows,2)
-#endif
-  for (y=0; y < (ssize_t) image->rows; y++)
-  {
-    const Quantum
-      *magick_restrict p;
-
-    Quantum
-      *magick_restrict q;
-
-    ssize_t
-      x;
-
-    /*
-      Tile fill color onto floodplane.
-    */
-    if (status == MagickFalse)
-      continue;
-    p=GetCacheViewVirtualPixels(floodplane_view,0,y,image->columns,1,exception);
-    q=GetCacheViewAuthenticPixels(image_view,0,y,image->columns,1,exception);
-    if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
-      {
-        status=MagickFalse;
-        continue;
-      }
-    for (x=0; x < (ssize_t) image->columns; x++)
-    {
-      if (GetPixelGray(floodplane_image,p) != 0)
-        {
-          PixelInfo
-            fill_color;
-
-          GetFillColor(draw_info,x,y,&fill_color,exception);
-          if ((image->channel_mask & RedChannel) != 0)
-            SetPixelRed(image,(Quantum) fill_color.red,q);
-          if ((image->channel_mask & GreenChannel) != 0)
-            SetPixelGreen(image,(Quantum) fill_color.green,q);
-          if ((image->channel_mask & BlueChannel) != 0)
-            SetPixelBlue(image,(Quantum) fill_color.blue,q);
-          if ((image->channel_mask & BlackChannel) != 0)
-            SetPixelBlack(image,(Quantum) fill_color.black,q);
-          if (((image->channel_mask & AlphaChannel) != 0) &&
-              ((image->alpha_trait & BlendPixelTrait) != 0))
-            SetPixelAlpha(image,(Quantum) fill_color.alpha,q);
-        }
-      p+=(ptrdiff_t) GetPixelChannels(floodplane_image);
-      q+=(ptrdiff_t) GetPixelChannels(image);
-    }
-    if (SyncCacheViewAuthenticPixels(image_view,exception) == MagickFalse)
-      status=MagickFalse;
-  }
+  fill_info.draw_info=draw_info;
+  fill_info.image=image;
+  fill_info.floodplane_image=floodplane_image;
+  fill_info.image_view=image_view;
+  fill_info.floodplane_view=floodplane_view;
+  fill_info.exception=exception;
+  status=ExecuteMagickTasks(0,(ssize_t) image->rows,0,GetMagickNumberThreads(
+    floodplane_image,image,image->rows,2),FloodfillTask,&fill_info);
   floodplane_view=DestroyCacheView(floodplane_view);
   image_view=DestroyCacheView(image_view);
   segment_info=RelinquishVirtualMemory(segment_info);
@@ -669,15 +722,8 @@ MagickExport MagickBooleanType GradientImage(Image *image,
 
 static size_t **DestroyHistogramTLS(size_t **histogram)
 {
-  ssize_t
-    i;
-
   assert(histogram != (size_t **) NULL);
-  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
-    if (histogram[i] != (size_t *) NULL)
-      histogram[i]=(size_t *) RelinquishMagickMemory(histogram[i]);
-  histogram=(size_t **) RelinquishMagickMemory(histogram);
-  return(histogram);
+  return((size_t **) RelinquishArenaMemory(histogram));
 }
 
 static size_t **AcquireHistogramTLS(const size_t count)
@@ -690,13 +736,13 @@ static size_t **AcquireHistogramTLS(const size_t count)
     number_threads;
 
   number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
-  histogram=(size_t **) AcquireQuantumMemory(number_threads,sizeof(*histogram));
+  histogram=(size_t **) AcquireArenaMemory(number_threads,sizeof(*histogram));
   if (histogram == (size_t **) NULL)
     return((size_t **) NULL);
   (void) memset(histogram,0,number_threads*sizeof(*histogram));
   for (i=0; i < (ssize_t) number_threads; i++)
   {
-    histogram[i]=(size_t *) AcquireQuantumMemory(count,sizeof(**histogram));
+    histogram[i]=(size_t *) AcquireArenaMemory(count,sizeof(**histogram));
     if (histogram[i] == (size_t *) NULL)
       return(DestroyHistogramTLS(histogram));
   }
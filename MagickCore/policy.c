@@ -1535,6 +1535,19 @@ MagickExport MagickBooleanType SetMagickSecurityPolicyValue(
     }
     case SystemPolicyDomain:
     {
+      if (LocaleCompare(name,"huge-pages") == 0)
+        {
+          MagickSizeType
+            threshold;
+
+          threshold=MagickResourceInfinity;
+          if ((LocaleCompare("unlimited",value) != 0) &&
+              (IsStringFalse(value) == MagickFalse))
+            threshold=IsStringTrue(value) != MagickFalse ? 0 :
+              StringToMagickSizeType(value,100.0);
+          SetHugePageThreshold(threshold);
+          return(MagickTrue);
+        }
       if (LocaleCompare(name,"max-memory-request") == 0)
         {
           MagickSizeType
@@ -27,6 +27,9 @@ extern "C" {
 extern MagickExport MagickBooleanType
   SetImageProfilePrivate(Image *,StringInfo *,ExceptionInfo *);
 
+extern MagickPrivate MagickBooleanType
+  ProfileComponentGenesis(void);
+
 extern MagickExport StringInfo
   *AcquireProfileStringInfo(const char *,const size_t length,ExceptionInfo *),
   *BlobToProfileStringInfo(const char *,const void *blob,const size_t length,
@@ -35,6 +38,8 @@ extern MagickExport StringInfo
 extern MagickPrivate void
   AppendImageProfileProperty(Image *,const char *,const char *,const char *,
     ExceptionInfo *),
+  GetProfileTransformStatistics(MagickSizeType *,MagickSizeType *),
+  ProfileComponentTerminus(void),
   Update8BIMClipPath(const Image *,const size_t,const size_t,
     const RectangleInfo *),
   SyncImageProfiles(Image *);
@@ -62,6 +62,8 @@
 #include "MagickCore/quantum.h"
 #include "MagickCore/quantum-private.h"
 #include "MagickCore/resource_.h"
+#include "MagickCore/semaphore.h"
+#include "MagickCore/signature-private.h"
 #include "MagickCore/splay-tree.h"
 #include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
@@ -81,6 +83,67 @@
 #  include <libxml/tree.h>
 #endif
 
+/*
+  Define declarations.
+*/
+#define MaxTransformCacheEntries  16
+
+/*
+  Typedef declarations.
+*/
+#if defined(MAGICKCORE_LCMS_DELEGATE)
+typedef struct _CMSTransformInfo
+{
+  cmsHTRANSFORM
+    transform;
+
+  cmsUInt32Number
+    flags,
+    source_type,
+    target_type;
+
+  int
+    intent;
+
+  StringInfo
+    *source_digest,
+    *target_digest;
+
+  ssize_t
+    reference_count;
+
+  MagickSizeType
+    timestamp;
+} CMSTransformInfo;
+#endif
+
+/*
+  Global declarations.
+*/
+#if defined(MAGICKCORE_LCMS_DELEGATE)
+static cmsContext
+  transform_context = (cmsContext) NULL;
+
+static CMSTransformInfo
+  *transform_cache[MaxTransformCacheEntries];
+
+static MagickBooleanType
+  transform_context_instantiated = MagickFalse;
+
+static MagickSizeType
+  transform_epoch = 0;
+
+static MagickThreadKey
+  transform_exception;
+#endif
+
+static MagickSizeType
+  transform_hits = 0,
+  transform_misses = 0;
+
+static SemaphoreInfo
+  *transform_semaphore = (SemaphoreInfo *) NULL;
+
 /*
   Forward declarations
 */
@@ -89,6 +152,7 @@ static MagickBooleanType
     const MagickBooleanType,ExceptionInfo *);
 
 static void
+  ResetCMSTransformCache(void),
   WriteTo8BimProfile(Image *,const char*,const StringInfo *);
 
 /*
@@ -378,6 +442,103 @@ MagickExport char *GetNextImageProfile(const Image *image)
   return((char *) GetNextKeyInSplayTree((SplayTreeInfo *) image->profiles));
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t P r o f i l e T r a n s f o r m S t a t i s t i c s                %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetProfileTransformStatistics() returns the number of hits and misses of
+%  the color transform cache.
+%
+%  The format of the GetProfileTransformStatistics method is:
+%
+%      void GetProfileTransformStatistics(MagickSizeType *hits,
+%        MagickSizeType *misses)
+%
+%  A description of each parameter follows:
+%
+%    o hits: the number of profile transforms that reused a cached transform.
+%
+%    o misses: the number of color transforms created.
+%
+*/
+MagickPrivate void GetProfileTransformStatistics(MagickSizeType *hits,
+  MagickSizeType *misses)
+{
+  if (transform_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&transform_semaphore);
+  LockSemaphoreInfo(transform_semaphore);
+  *hits=transform_hits;
+  *misses=transform_misses;
+  UnlockSemaphoreInfo(transform_semaphore);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   P r o f i l e C o m p o n e n t G e n e s i s                            %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ProfileComponentGenesis() instantiates the profile component.
+%
+%  The format of the ProfileComponentGenesis method is:
+%
+%      MagickBooleanType ProfileComponentGenesis(void)
+%
+*/
+MagickPrivate MagickBooleanType ProfileComponentGenesis(void)
+{
+  if (transform_semaphore == (SemaphoreInfo *) NULL)
+    transform_semaphore=AcquireSemaphoreInfo();
+#if defined(MAGICKCORE_LCMS_DELEGATE)
+  if (CreateMagickThreadKey(&transform_exception,NULL) == MagickFalse)
+    return(MagickFalse);
+#endif
+  return(MagickTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   P r o f i l e C o m p o n e n t T e r m i n u s                          %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ProfileComponentTerminus() destroys the profile component.
+%
+%  The format of the ProfileComponentTerminus method is:
+%
+%      void ProfileComponentTerminus(void)
+%
+*/
+MagickPrivate void ProfileComponentTerminus(void)
+{
+  if (transform_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&transform_semaphore);
+  LockSemaphoreInfo(transform_semaphore);
+  ResetCMSTransformCache();
+  UnlockSemaphoreInfo(transform_semaphore);
+  RelinquishSemaphoreInfo(&transform_semaphore);
+#if defined(MAGICKCORE_LCMS_DELEGATE)
+  (void) DeleteMagickThreadKey(transform_exception);
+#endif
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -517,49 +678,6 @@ static void **AcquirePixelTLS(const size_t columns,const size_t channels,
   return(pixels);
 }
 
-static cmsHTRANSFORM *DestroyTransformTLS(cmsHTRANSFORM *transform)
-{
-  ssize_t
-    i;
-
-  assert(transform != (cmsHTRANSFORM *) NULL);
-  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
-    if (transform[i] != (cmsHTRANSFORM) NULL)
-      cmsDeleteTransform(transform[i]);
-  transform=(cmsHTRANSFORM *) RelinquishMagickMemory(transform);
-  return(transform);
-}
-
-static cmsHTRANSFORM *AcquireTransformTLS(const LCMSInfo *source_info,
-  const LCMSInfo *target_info,const cmsUInt32Number flags,
-  cmsContext cms_context)
-{
-  cmsHTRANSFORM
-    *transform;
-
-  size_t
-    number_threads;
-
-  ssize_t
-    i;
-
-  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
-  transform=(cmsHTRANSFORM *) AcquireQuantumMemory(number_threads,
-    sizeof(*transform));
-  if (transform == (cmsHTRANSFORM *) NULL)
-    return((cmsHTRANSFORM *) NULL);
-  (void) memset(transform,0,number_threads*sizeof(*transform));
-  for (i=0; i < (ssize_t) number_threads; i++)
-  {
-    transform[i]=cmsCreateTransformTHR(cms_context,source_info->profile,
-      source_info->type,target_info->profile,target_info->type,
-      (cmsUInt32Number) target_info->intent,flags);
-    if (transform[i] == (cmsHTRANSFORM) NULL)
-      return(DestroyTransformTLS(transform));
-  }
-  return(transform);
-}
-
 static void CMSExceptionHandler(cmsContext context,cmsUInt32Number severity,
   const char *message)
 {
@@ -573,6 +691,9 @@ static void CMSExceptionHandler(cmsContext context,cmsUInt32Number severity,
     *image;
 
   cms_exception=(CMSExceptionInfo *) cmsGetContextUserData(context);
+  if (cms_exception == (CMSExceptionInfo *) NULL)
+    cms_exception=(CMSExceptionInfo *) GetMagickThreadValue(
+      transform_exception);
   if (cms_exception == (CMSExceptionInfo *) NULL)
     return;
   exception=cms_exception->exception;
@@ -593,9 +714,212 @@ static void CMSExceptionHandler(cmsContext context,cmsUInt32Number severity,
     message != (char *) NULL ? message : "no message",severity);
 }
 
+static CMSTransformInfo *DestroyCMSTransform(CMSTransformInfo *transform_info)
+{
+  if (transform_info->transform != (cmsHTRANSFORM) NULL)
+    cmsDeleteTransform(transform_info->transform);
+  if (transform_info->source_digest != (StringInfo *) NULL)
+    transform_info->source_digest=DestroyStringInfo(
+      transform_info->source_digest);
+  if (transform_info->target_digest != (StringInfo *) NULL)
+    transform_info->target_digest=DestroyStringInfo(
+      transform_info->target_digest);
+  return((CMSTransformInfo *) RelinquishMagickMemory(transform_info));
+}
+
+static StringInfo *GetCMSProfileDigest(const StringInfo *profile)
+{
+  SignatureInfo
+    *signature_info;
+
+  StringInfo
+    *digest;
+
+  if (profile == (const StringInfo *) NULL)
+    return((StringInfo *) NULL);
+  signature_info=AcquireSignatureInfo();
+  UpdateSignature(signature_info,profile);
+  FinalizeSignature(signature_info);
+  digest=CloneStringInfo(GetSignatureDigest(signature_info));
+  signature_info=DestroySignatureInfo(signature_info);
+  return(digest);
+}
+
+static inline MagickBooleanType IsCMSDigestMatch(const StringInfo *digest,
+  const StringInfo *other)
+{
+  if ((digest == (const StringInfo *) NULL) ||
+      (other == (const StringInfo *) NULL))
+    return(digest == other ? MagickTrue : MagickFalse);
+  return(CompareStringInfo(digest,other) == 0 ? MagickTrue : MagickFalse);
+}
+
+static inline MagickBooleanType IsCMSTransformMatch(
+  const CMSTransformInfo *transform_info,const LCMSInfo *source_info,
+  const LCMSInfo *target_info,const cmsUInt32Number flags,
+  const StringInfo *source_digest,const StringInfo *target_digest)
+{
+  if ((transform_info->source_type != source_info->type) ||
+      (transform_info->target_type != target_info->type) ||
+      (transform_info->intent != target_info->intent) ||
+      (transform_info->flags != flags))
+    return(MagickFalse);
+  if (IsCMSDigestMatch(transform_info->source_digest,source_digest) ==
+      MagickFalse)
+    return(MagickFalse);
+  return(IsCMSDigestMatch(transform_info->target_digest,target_digest));
+}
+
+static CMSTransformInfo *RelinquishCMSTransform(
+  CMSTransformInfo *transform_info)
+{
+  ssize_t
+    reference_count;
+
+  assert(transform_info != (CMSTransformInfo *) NULL);
+  LockSemaphoreInfo(transform_semaphore);
+  reference_count=(--transform_info->reference_count);
+  UnlockSemaphoreInfo(transform_semaphore);
+  if (reference_count == 0)
+    transform_info=DestroyCMSTransform(transform_info);
+  return((CMSTransformInfo *) NULL);
+}
+
+static CMSTransformInfo *AcquireCMSTransform(const Image *image,
+  const LCMSInfo *source_info,const LCMSInfo *target_info,
+  const cmsUInt32Number flags,const StringInfo *source_profile,
+  const StringInfo *target_profile)
+{
+  CMSTransformInfo
+    *transform_info;
+
+  ssize_t
+    i,
+    j;
+
+  StringInfo
+    *source_digest,
+    *target_digest;
+
+  /*
+    A transform depends only on the two profiles, the pixel formats, the
+    intent, and the flags, so batches that share profiles share a transform.
+  */
+  if (transform_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&transform_semaphore);
+  source_digest=GetCMSProfileDigest(source_profile);
+  target_digest=GetCMSProfileDigest(target_profile);
+  LockSemaphoreInfo(transform_semaphore);
+  for (i=0; i < MaxTransformCacheEntries; i++)
+  {
+    transform_info=transform_cache[i];
+    if ((transform_info != (CMSTransformInfo *) NULL) &&
+        (IsCMSTransformMatch(transform_info,source_info,target_info,flags,
+         source_digest,target_digest) != MagickFalse))
+      {
+        transform_info->reference_count++;
+        transform_info->timestamp=(++transform_epoch);
+        transform_hits++;
+        UnlockSemaphoreInfo(transform_semaphore);
+        if (image->debug != MagickFalse)
+          (void) LogMagickEvent(TransformEvent,GetMagickModule(),
+            "lcms: reuse cached color transform");
+        if (source_digest != (StringInfo *) NULL)
+          source_digest=DestroyStringInfo(source_digest);
+        if (target_digest != (StringInfo *) NULL)
+          target_digest=DestroyStringInfo(target_digest);
+        return(transform_info);
+      }
+  }
+  transform_misses++;
+  if ((transform_context == (cmsContext) NULL) &&
+      (transform_context_instantiated == MagickFalse))
+    {
+      /*
+        Cached transforms outlive the call that created them, so they belong
+        to a context with no per-image exception attached; the caller sets
+        the transform_exception thread value around each use instead.
+      */
+      transform_context=cmsCreateContext(NULL,NULL);
+      if (transform_context != (cmsContext) NULL)
+        cmsSetLogErrorHandlerTHR(transform_context,CMSExceptionHandler);
+      transform_context_instantiated=MagickTrue;
+    }
+  UnlockSemaphoreInfo(transform_semaphore);
+  transform_info=(CMSTransformInfo *) AcquireMagickMemory(
+    sizeof(*transform_info));
+  if (transform_info == (CMSTransformInfo *) NULL)
+    {
+      if (source_digest != (StringInfo *) NULL)
+        source_digest=DestroyStringInfo(source_digest);
+      if (target_digest != (StringInfo *) NULL)
+        target_digest=DestroyStringInfo(target_digest);
+      return((CMSTransformInfo *) NULL);
+    }
+  (void) memset(transform_info,0,sizeof(*transform_info));
+  transform_info->source_type=source_info->type;
+  transform_info->target_type=target_info->type;
+  transform_info->intent=target_info->intent;
+  transform_info->flags=flags;
+  transform_info->source_digest=source_digest;
+  transform_info->target_digest=target_digest;
+  /*
+    Without the 1-pixel cache a single transform is safe to share across
+    threads.
+  */
+  transform_info->transform=cmsCreateTransformTHR(transform_context,
+    source_info->profile,source_info->type,target_info->profile,
+    target_info->type,(cmsUInt32Number) target_info->intent,flags |
+    cmsFLAGS_NOCACHE);
+  if (transform_info->transform == (cmsHTRANSFORM) NULL)
+    return(DestroyCMSTransform(transform_info));
+  if (image->debug != MagickFalse)
+    (void) LogMagickEvent(TransformEvent,GetMagickModule(),
+      "lcms: create color transform");
+  /*
+    Replace the least recently used transform.
+  */
+  LockSemaphoreInfo(transform_semaphore);
+  j=0;
+  for (i=0; i < MaxTransformCacheEntries; i++)
+  {
+    if (transform_cache[i] == (CMSTransformInfo *) NULL)
+      {
+        j=i;
+        break;
+      }
+    if (transform_cache[i]->timestamp < transform_cache[j]->timestamp)
+      j=i;
+  }
+  if ((transform_cache[j] != (CMSTransformInfo *) NULL) &&
+      (--transform_cache[j]->reference_count == 0))
+    transform_cache[j]=DestroyCMSTransform(transform_cache[j]);
+  transform_info->reference_count=2;
+  transform_info->timestamp=(++transform_epoch);
+  transform_cache[j]=transform_info;
+  UnlockSemaphoreInfo(transform_semaphore);
+  return(transform_info);
+}
+
+static void ResetCMSTransformCache(void)
+{
+  ssize_t
+    i;
+
+  for (i=0; i < MaxTransformCacheEntries; i++)
+    if ((transform_cache[i] != (CMSTransformInfo *) NULL) &&
+        (--transform_cache[i]->reference_count == 0))
+      transform_cache[i]=DestroyCMSTransform(transform_cache[i]);
+  (void) memset(transform_cache,0,sizeof(transform_cache));
+  if (transform_context != (cmsContext) NULL)
+    cmsDeleteContext(transform_context);
+  transform_context=(cmsContext) NULL;
+  transform_context_instantiated=MagickFalse;
+}
+
 static void TransformDoublePixels(const int id,const Image* image,
   const LCMSInfo *source_info,const LCMSInfo *target_info,
-  const cmsHTRANSFORM *transform,Quantum *q)
+  const cmsHTRANSFORM transform,Quantum *q)
 {
 #define GetLCMSPixel(source_info,pixel,index) \
   (source_info->scale[index]*(((double) QuantumScale*(double) pixel)+ \
@@ -623,7 +947,7 @@ static void TransformDoublePixels(const int id,const Image* image,
       *p++=GetLCMSPixel(source_info,GetPixelBlack(image,q),3);
     q+=(ptrdiff_t) GetPixelChannels(image);
   }
-  cmsDoTransform(transform[id],source_info->pixels[id],target_info->pixels[id],
+  cmsDoTransform(transform,source_info->pixels[id],target_info->pixels[id],
     (unsigned int) image->columns);
   p=(double *) target_info->pixels[id];
   q-=GetPixelChannels(image)*image->columns;
@@ -652,7 +976,7 @@ static void TransformDoublePixels(const int id,const Image* image,
 
 static void TransformQuantumPixels(const int id,const Image* image,
   const LCMSInfo *source_info,const LCMSInfo *target_info,
-  const cmsHTRANSFORM *transform,Quantum *q)
+  const cmsHTRANSFORM transform,Quantum *q)
 {
   Quantum
     *p;
@@ -673,7 +997,7 @@ static void TransformQuantumPixels(const int id,const Image* image,
       *p++=GetPixelBlack(image,q);
     q+=(ptrdiff_t) GetPixelChannels(image);
   }
-  cmsDoTransform(transform[id],source_info->pixels[id],target_info->pixels[id],
+  cmsDoTransform(transform,source_info->pixels[id],target_info->pixels[id],
     (unsigned int) image->columns);
   p=(Quantum *) target_info->pixels[id];
   q-=GetPixelChannels(image)*image->columns;
@@ -709,6 +1033,10 @@ static inline void SetLCMSInfoScale(LCMSInfo *info,const double scale)
   info->scale[2]=scale;
   info->scale[3]=scale;
 }
+#else
+static void ResetCMSTransformCache(void)
+{
+}
 #endif
 
 static void SetsRGBImageProfile(Image *image,ExceptionInfo *exception)
@@ -1136,8 +1464,8 @@ MagickExport MagickBooleanType ProfileImage(Image *image,const char *name,
             cmsColorSpaceSignature
               signature;
 
-            cmsHTRANSFORM
-              *magick_restrict transform;
+            CMSTransformInfo
+              *transform_info;
 
             cmsUInt32Number
               flags;
@@ -1396,9 +1724,13 @@ MagickExport MagickBooleanType ProfileImage(Image *image,const char *name,
             if (image->black_point_compensation != MagickFalse)
               flags|=cmsFLAGS_BLACKPOINTCOMPENSATION;
 #endif
-            transform=AcquireTransformTLS(&source_info,&target_info,flags,
-              cms_context);
-            if (transform == (cmsHTRANSFORM *) NULL)
+            (void) SetMagickThreadValue(transform_exception,&cms_exception);
+            transform_info=AcquireCMSTransform(image,&source_info,&target_info,
+              flags,icc_profile != (StringInfo *) NULL ? icc_profile : profile,
+              icc_profile != (StringInfo *) NULL ? profile :
+              (const StringInfo *) NULL);
+            (void) SetMagickThreadValue(transform_exception,(void *) NULL);
+            if (transform_info == (CMSTransformInfo *) NULL)
               ThrowProfileException(ImageError,"UnableToCreateColorTransform",
                 name);
             /*
@@ -1413,7 +1745,7 @@ MagickExport MagickBooleanType ProfileImage(Image *image,const char *name,
               {
                 target_info.pixels=DestroyPixelTLS(target_info.pixels);
                 source_info.pixels=DestroyPixelTLS(source_info.pixels);
-                transform=DestroyTransformTLS(transform);
+                transform_info=RelinquishCMSTransform(transform_info);
                 ThrowProfileException(ResourceLimitError,
                   "MemoryAllocationFailed",image->filename);
               }
@@ -1421,7 +1753,7 @@ MagickExport MagickBooleanType ProfileImage(Image *image,const char *name,
               {
                 target_info.pixels=DestroyPixelTLS(target_info.pixels);
                 source_info.pixels=DestroyPixelTLS(source_info.pixels);
-                transform=DestroyTransformTLS(transform);
+                transform_info=RelinquishCMSTransform(transform_info);
                 if (source_info.profile != (cmsHPROFILE) NULL)
                   (void) cmsCloseProfile(source_info.profile);
                 if (target_info.profile != (cmsHPROFILE) NULL)
@@ -1456,12 +1788,14 @@ MagickExport MagickBooleanType ProfileImage(Image *image,const char *name,
                   status=MagickFalse;
                   continue;
                 }
+              (void) SetMagickThreadValue(transform_exception,&cms_exception);
               if (highres != MagickFalse)
                 TransformDoublePixels(id,image,&source_info,&target_info,
-                  transform,q);
+                  transform_info->transform,q);
               else
                 TransformQuantumPixels(id,image,&source_info,&target_info,
-                  transform,q);
+                  transform_info->transform,q);
+              (void) SetMagickThreadValue(transform_exception,(void *) NULL);
               sync=SyncCacheViewAuthenticPixels(image_view,exception);
               if (sync == MagickFalse)
                 status=MagickFalse;
@@ -1507,7 +1841,7 @@ MagickExport MagickBooleanType ProfileImage(Image *image,const char *name,
             }
             target_info.pixels=DestroyPixelTLS(target_info.pixels);
             source_info.pixels=DestroyPixelTLS(source_info.pixels);
-            transform=DestroyTransformTLS(transform);
+            transform_info=RelinquishCMSTransform(transform_info);
             if ((status != MagickFalse) &&
                 (cmsGetDeviceClass(source_info.profile) != cmsSigLinkClass))
               status=SetImageProfilePrivate(image,profile,exception);
@@ -1441,15 +1441,8 @@ MagickExport QuantizeInfo *DestroyQuantizeInfo(QuantizeInfo *quantize_info)
 
 static DoublePixelPacket **DestroyPixelTLS(DoublePixelPacket **pixels)
 {
-  ssize_t
-    i;
-
   assert(pixels != (DoublePixelPacket **) NULL);
-  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
-    if (pixels[i] != (DoublePixelPacket *) NULL)
-      pixels[i]=(DoublePixelPacket *) RelinquishMagickMemory(pixels[i]);
-  pixels=(DoublePixelPacket **) RelinquishMagickMemory(pixels);
-  return(pixels);
+  return((DoublePixelPacket **) RelinquishArenaMemory(pixels));
 }
 
 static DoublePixelPacket **AcquirePixelTLS(const size_t count)
@@ -1464,14 +1457,14 @@ static DoublePixelPacket **AcquirePixelTLS(const size_t count)
     i;
 
   number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
-  pixels=(DoublePixelPacket **) AcquireQuantumMemory(number_threads,
+  pixels=(DoublePixelPacket **) AcquireArenaMemory(number_threads,
     sizeof(*pixels));
   if (pixels == (DoublePixelPacket **) NULL)
     return((DoublePixelPacket **) NULL);
   (void) memset(pixels,0,number_threads*sizeof(*pixels));
   for (i=0; i < (ssize_t) number_threads; i++)
   {
-    pixels[i]=(DoublePixelPacket *) AcquireQuantumMemory(count,2*
+    pixels[i]=(DoublePixelPacket *) AcquireArenaMemory(count,2*
       sizeof(**pixels));
     if (pixels[i] == (DoublePixelPacket *) NULL)
       return(DestroyPixelTLS(pixels));
@@ -52,6 +52,9 @@ extern MagickPrivate double
   GetResizeFilterSupport(const ResizeFilter *),
   GetResizeFilterWeight(const ResizeFilter *,const double);
 
+extern MagickPrivate MagickBooleanType
+  ResizeComponentGenesis(void);
+
 extern MagickPrivate ResizeFilter
   *AcquireResizeFilter(const Image *,const FilterType,const MagickBooleanType,
     ExceptionInfo *),
@@ -61,6 +64,10 @@ extern MagickPrivate ResizeWeightingFunctionType
   GetResizeFilterWeightingType(const ResizeFilter *),
   GetResizeFilterWindowWeightingType(const ResizeFilter *);
 
+extern MagickPrivate void
+  GetResizeContributionStatistics(MagickSizeType *,MagickSizeType *),
+  ResizeComponentTerminus(void);
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }
 #endif
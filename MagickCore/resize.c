@@ -86,6 +86,12 @@
 #include <lqr.h>
 #endif
 
+/*
+  Define declarations.
+*/
+#define MaxContributionCacheEntries  16
+#define MaxContributionCacheExtent  (16*1024*1024)
+
 /*
   Typedef declarations.
 */
@@ -107,6 +113,62 @@ struct _ResizeFilter
   size_t
     signature;
 };
+
+typedef struct _ContributionInfo
+{
+  double
+    weight;
+
+  ssize_t
+    pixel;
+} ContributionInfo;
+
+typedef struct _ContributionTable
+{
+  double
+    (*filter)(const double,const ResizeFilter *),
+    (*window)(const double,const ResizeFilter *),
+    filter_support,
+    window_support,
+    scale,
+    blur,
+    coefficient[7];
+
+  size_t
+    source,
+    target,
+    extent;
+
+  double
+    support;
+
+  ContributionInfo
+    *contributions;
+
+  ssize_t
+    *count,
+    *nearest,
+    stride,
+    reference_count;
+
+  MagickSizeType
+    timestamp;
+} ContributionTable;
+
+/*
+  Global declarations.
+*/
+static ContributionTable
+  *contribution_cache[MaxContributionCacheEntries];
+
+static MagickSizeType
+  contribution_epoch = 0,
+  contribution_extent = 0,
+  contribution_hits = 0,
+  contribution_misses = 0;
+
+static SemaphoreInfo
+  *contribution_semaphore = (SemaphoreInfo *) NULL;
 
 /*
   Forward declarations.
@@ -116,6 +178,9 @@ static double
   BesselOrderOne(double),
   Sinc(const double, const ResizeFilter *),
   SincFast(const double, const ResizeFilter *);
+
+static ContributionTable
+  *DestroyContributionTable(ContributionTable *);
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -1584,6 +1649,43 @@ MagickPrivate ResizeFilter *DestroyResizeFilter(ResizeFilter *resize_filter)
   return(resize_filter);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t R e s i z e C o n t r i b u t i o n S t a t i s t i c s             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetResizeContributionStatistics() returns the number of hits and misses
+%  of the resize contribution table cache.
+%
+%  The format of the GetResizeContributionStatistics method is:
+%
+%      void GetResizeContributionStatistics(MagickSizeType *hits,
+%        MagickSizeType *misses)
+%
+%  A description of each parameter follows:
+%
+%    o hits: the number of resizes that reused a cached contribution table.
+%
+%    o misses: the number of contribution tables computed.
+%
+*/
+MagickPrivate void GetResizeContributionStatistics(MagickSizeType *hits,
+  MagickSizeType *misses)
+{
+  if (contribution_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&contribution_semaphore);
+  LockSemaphoreInfo(contribution_semaphore);
+  *hits=contribution_hits;
+  *misses=contribution_misses;
+  UnlockSemaphoreInfo(contribution_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -3244,6 +3346,67 @@ MagickExport Image *ResampleImage(const Image *image,const double x_resolution,
   return(resample_image);
 }
 
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e s i z e C o m p o n e n t G e n e s i s                               %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ResizeComponentGenesis() instantiates the resize component.
+%
+%  The format of the ResizeComponentGenesis method is:
+%
+%      MagickBooleanType ResizeComponentGenesis(void)
+%
+*/
+MagickPrivate MagickBooleanType ResizeComponentGenesis(void)
+{
+  if (contribution_semaphore == (SemaphoreInfo *) NULL)
+    contribution_semaphore=AcquireSemaphoreInfo();
+  return(MagickTrue);
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   R e s i z e C o m p o n e n t T e r m i n u s                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ResizeComponentTerminus() destroys the resize component.
+%
+%  The format of the ResizeComponentTerminus method is:
+%
+%      void ResizeComponentTerminus(void)
+%
+*/
+MagickPrivate void ResizeComponentTerminus(void)
+{
+  ssize_t
+    i;
+
+  if (contribution_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&contribution_semaphore);
+  LockSemaphoreInfo(contribution_semaphore);
+  for (i=0; i < MaxContributionCacheEntries; i++)
+    if ((contribution_cache[i] != (ContributionTable *) NULL) &&
+        (--contribution_cache[i]->reference_count == 0))
+      contribution_cache[i]=DestroyContributionTable(contribution_cache[i]);
+  (void) memset(contribution_cache,0,sizeof(contribution_cache));
+  contribution_extent=0;
+  UnlockSemaphoreInfo(contribution_semaphore);
+  RelinquishSemaphoreInfo(&contribution_semaphore);
+}
+
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %                                                                             %
@@ -3283,55 +3446,328 @@ MagickExport Image *ResampleImage(const Image *image,const double x_resolution,
 %
 */
 
-typedef struct _ContributionInfo
+static ContributionTable *DestroyContributionTable(ContributionTable *table)
+{
+  if (table->contributions != (ContributionInfo *) NULL)
+    table->contributions=(ContributionInfo *) RelinquishAlignedMemory(
+      table->contributions);
+  if (table->nearest != (ssize_t *) NULL)
+    table->nearest=(ssize_t *) RelinquishMagickMemory(table->nearest);
+  if (table->count != (ssize_t *) NULL)
+    table->count=(ssize_t *) RelinquishMagickMemory(table->count);
+  return((ContributionTable *) RelinquishMagickMemory(table));
+}
+
+static inline MagickBooleanType IsContributionTableMatch(
+  const ContributionTable *table,const ResizeFilter *resize_filter,
+  const size_t source,const size_t target)
+{
+  ssize_t
+    i;
+
+  if ((table->source != source) || (table->target != target) ||
+      (table->filter != resize_filter->filter) ||
+      (table->window != resize_filter->window) ||
+      (table->filter_support != resize_filter->support) ||
+      (table->window_support != resize_filter->window_support) ||
+      (table->scale != resize_filter->scale) ||
+      (table->blur != resize_filter->blur))
+    return(MagickFalse);
+  for (i=0; i < 7; i++)
+    if (table->coefficient[i] != resize_filter->coefficient[i])
+      return(MagickFalse);
+  return(MagickTrue);
+}
+
+static ContributionTable *RelinquishContributionTable(ContributionTable *table)
+{
+  ssize_t
+    reference_count;
+
+  assert(table != (ContributionTable *) NULL);
+  if (contribution_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&contribution_semaphore);
+  LockSemaphoreInfo(contribution_semaphore);
+  reference_count=(--table->reference_count);
+  UnlockSemaphoreInfo(contribution_semaphore);
+  if (reference_count == 0)
+    table=DestroyContributionTable(table);
+  return((ContributionTable *) NULL);
+}
+
+static ContributionTable *BuildContributionTable(
+  const ResizeFilter *resize_filter,const size_t source,const size_t target,
+  const double factor)
 {
+  ContributionTable
+    *table;
+
   double
-    weight;
+    scale,
+    support;
 
   ssize_t
-    pixel;
-} ContributionInfo;
+    x;
+
+  /*
+    Compute the normalized filter weights for each target pixel.
+  */
+  table=(ContributionTable *) AcquireCriticalMemory(sizeof(*table));
+  (void) memset(table,0,sizeof(*table));
+  table->filter=resize_filter->filter;
+  table->window=resize_filter->window;
+  table->filter_support=resize_filter->support;
+  table->window_support=resize_filter->window_support;
+  table->scale=resize_filter->scale;
+  table->blur=resize_filter->blur;
+  (void) memcpy(table->coefficient,resize_filter->coefficient,
+    sizeof(table->coefficient));
+  table->source=source;
+  table->target=target;
+  table->reference_count=1;
+  scale=MagickMax(1.0/factor+MagickEpsilon,1.0);
+  support=scale*GetResizeFilterSupport(resize_filter);
+  table->support=support;
+  if (support < 0.5)
+    {
+      /*
+        Support too small even for nearest neighbour: Reduce to point sampling.
+      */
+      support=(double) 0.5;
+      scale=1.0;
+    }
+  scale=MagickSafeReciprocal(scale);
+  table->stride=(ssize_t) (2.0*support+3.0);
+  table->extent=target*((size_t) table->stride*sizeof(*table->contributions)+
+    sizeof(*table->count)+sizeof(*table->nearest));
+  table->contributions=(ContributionInfo *) MagickAssumeAligned(
+    AcquireAlignedMemory(target,table->stride*sizeof(*table->contributions)));
+  table->count=(ssize_t *) AcquireQuantumMemory(target,sizeof(*table->count));
+  table->nearest=(ssize_t *) AcquireQuantumMemory(target,
+    sizeof(*table->nearest));
+  if ((table->contributions == (ContributionInfo *) NULL) ||
+      (table->count == (ssize_t *) NULL) || (table->nearest == (ssize_t *) NULL))
+    return(DestroyContributionTable(table));
+  for (x=0; x < (ssize_t) target; x++)
+  {
+    ContributionInfo
+      *magick_restrict contribution;
+
+    double
+      bisect,
+      density;
 
-static ContributionInfo **DestroyContributionTLS(
-  ContributionInfo **contribution)
+    ssize_t
+      n,
+      start,
+      stop;
+
+    bisect=(double) (x+0.5)/factor+MagickEpsilon;
+    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
+    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) source);
+    density=0.0;
+    contribution=table->contributions+x*table->stride;
+    for (n=0; n < (stop-start); n++)
+    {
+      contribution[n].pixel=start+n;
+      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
+        ((double) (start+n)-bisect+0.5));
+      density+=contribution[n].weight;
+    }
+    table->count[x]=n;
+    table->nearest[x]=(ssize_t) (MagickMin(MagickMax(bisect,(double) start),
+      (double) stop-1.0)+0.5)-start;
+    if ((n != 0) && (density != 0.0) && (density != 1.0))
+      {
+        ssize_t
+          i;
+
+        /*
+          Normalize.
+        */
+        density=MagickSafeReciprocal(density);
+        for (i=0; i < n; i++)
+          contribution[i].weight*=density;
+      }
+  }
+  return(table);
+}
+
+static ContributionTable *AcquireContributionTable(
+  const ResizeFilter *resize_filter,const size_t source,const size_t target,
+  const double factor)
 {
+  ContributionTable
+    *table;
+
   ssize_t
-    i;
+    i,
+    j;
 
-  assert(contribution != (ContributionInfo **) NULL);
-  for (i=0; i < (ssize_t) GetMagickResourceLimit(ThreadResource); i++)
-    if (contribution[i] != (ContributionInfo *) NULL)
-      contribution[i]=(ContributionInfo *) RelinquishAlignedMemory(
-        contribution[i]);
-  contribution=(ContributionInfo **) RelinquishMagickMemory(contribution);
-  return(contribution);
+  /*
+    Contribution tables depend only on the filter and the source and target
+    extents, so batches of like-sized images share a cached table.
+  */
+  if (contribution_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&contribution_semaphore);
+  LockSemaphoreInfo(contribution_semaphore);
+  for (i=0; i < MaxContributionCacheEntries; i++)
+  {
+    table=contribution_cache[i];
+    if ((table != (ContributionTable *) NULL) &&
+        (IsContributionTableMatch(table,resize_filter,source,target) !=
+         MagickFalse))
+      {
+        table->reference_count++;
+        table->timestamp=(++contribution_epoch);
+        contribution_hits++;
+        UnlockSemaphoreInfo(contribution_semaphore);
+        return(table);
+      }
+  }
+  contribution_misses++;
+  UnlockSemaphoreInfo(contribution_semaphore);
+  table=BuildContributionTable(resize_filter,source,target,factor);
+  if ((table == (ContributionTable *) NULL) ||
+      (table->extent > MaxContributionCacheExtent))
+    return(table);
+  /*
+    Replace the least recently used tables until the new one fits.
+  */
+  LockSemaphoreInfo(contribution_semaphore);
+  j=(-1);
+  for (i=0; i < MaxContributionCacheEntries; i++)
+    if (contribution_cache[i] == (ContributionTable *) NULL)
+      {
+        j=i;
+        break;
+      }
+  while ((j < 0) ||
+         ((contribution_extent+table->extent) > MaxContributionCacheExtent))
+  {
+    ssize_t
+      k;
+
+    k=(-1);
+    for (i=0; i < MaxContributionCacheEntries; i++)
+      if ((contribution_cache[i] != (ContributionTable *) NULL) &&
+          ((k < 0) || (contribution_cache[i]->timestamp <
+           contribution_cache[k]->timestamp)))
+        k=i;
+    if (k < 0)
+      break;
+    contribution_extent-=contribution_cache[k]->extent;
+    if (--contribution_cache[k]->reference_count == 0)
+      (void) DestroyContributionTable(contribution_cache[k]);
+    contribution_cache[k]=(ContributionTable *) NULL;
+    if (j < 0)
+      j=k;
+  }
+  table->reference_count++;
+  table->timestamp=(++contribution_epoch);
+  contribution_extent+=table->extent;
+  contribution_cache[j]=table;
+  UnlockSemaphoreInfo(contribution_semaphore);
+  return(table);
 }
 
-static ContributionInfo **AcquireContributionTLS(const size_t count)
+static MagickBooleanType GetResizeChannelTraits(const Image *image,
+  const Image *resize_image,PixelTrait *traits,MagickBooleanType *blend)
 {
   ssize_t
     i;
 
-  ContributionInfo
-    **contribution;
+  *blend=MagickFalse;
+  /*
+    The unrolled accumulation applies only when every channel is resized and
+    no write mask is present.
+  */
+  if ((GetPixelChannels(image) != GetPixelChannels(resize_image)) ||
+      (GetPixelWriteMaskTraits(resize_image) != UndefinedPixelTrait))
+    return(MagickFalse);
+  for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+  {
+    PixelChannel
+      channel;
+
+    PixelTrait
+      resize_traits;
+
+    channel=GetPixelChannelChannel(image,i);
+    resize_traits=GetPixelChannelTraits(resize_image,channel);
+    if ((GetPixelChannelTraits(image,channel) == UndefinedPixelTrait) ||
+        (resize_traits == UndefinedPixelTrait) ||
+        ((resize_traits & CopyPixelTrait) != 0) ||
+        (GetPixelChannelChannel(resize_image,i) != channel))
+      return(MagickFalse);
+    traits[i]=resize_traits;
+    if ((resize_traits & BlendPixelTrait) != 0)
+      *blend=MagickTrue;
+  }
+  return(MagickTrue);
+}
 
-  size_t
-    number_threads;
-
-  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
-  contribution=(ContributionInfo **) AcquireQuantumMemory(number_threads,
-    sizeof(*contribution));
-  if (contribution == (ContributionInfo **) NULL)
-    return((ContributionInfo **) NULL);
-  (void) memset(contribution,0,number_threads*sizeof(*contribution));
-  for (i=0; i < (ssize_t) number_threads; i++)
+static inline void ResizeContributions(const Image *magick_restrict image,
+  const PixelTrait *magick_restrict traits,const MagickBooleanType blend,
+  const ContributionInfo *magick_restrict contribution,const ssize_t n,
+  const Quantum *magick_restrict p,const ssize_t stride,
+  Quantum *magick_restrict q)
+{
+  const size_t
+    channels = GetPixelChannels(image);
+
+  double
+    gamma,
+    pixel[MaxPixelChannels];
+
+  ssize_t
+    i,
+    j;
+
+  /*
+    Accumulate all channels of each contributing pixel at once.  The weights
+    and summation order match the per-channel loop, so results are identical.
+  */
+  (void) memset(pixel,0,channels*sizeof(*pixel));
+  if (blend == MagickFalse)
+    {
+      for (j=0; j < n; j++)
+      {
+        const Quantum
+          *magick_restrict r = p+j*stride*(ssize_t) channels;
+
+        double
+          weight = contribution[j].weight;
+
+        for (i=0; i < (ssize_t) channels; i++)
+          pixel[i]+=weight*(double) r[i];
+      }
+      for (i=0; i < (ssize_t) channels; i++)
+        q[i]=ClampToQuantum(pixel[i]);
+      return;
+    }
+  gamma=0.0;
+  for (j=0; j < n; j++)
   {
-    contribution[i]=(ContributionInfo *) MagickAssumeAligned(
-      AcquireAlignedMemory(count,sizeof(**contribution)));
-    if (contribution[i] == (ContributionInfo *) NULL)
-      return(DestroyContributionTLS(contribution));
+    const Quantum
+      *magick_restrict r = p+j*stride*(ssize_t) channels;
+
+    double
+      alpha,
+      weight[2];
+
+    weight[0]=contribution[j].weight;
+    alpha=contribution[j].weight*QuantumScale*(double) GetPixelAlpha(image,r);
+    weight[1]=alpha;
+    gamma+=alpha;
+    for (i=0; i < (ssize_t) channels; i++)
+      pixel[i]+=weight[(traits[i] & BlendPixelTrait) != 0 ? 1 : 0]*
+        (double) r[i];
   }
-  return(contribution);
+  gamma=MagickSafeReciprocal(gamma);
+  for (i=0; i < (ssize_t) channels; i++)
+    q[i]=ClampToQuantum((traits[i] & BlendPixelTrait) != 0 ? gamma*pixel[i] :
+      pixel[i]);
 }
 
 static MagickBooleanType HorizontalFilter(
@@ -3349,15 +3785,16 @@ static MagickBooleanType HorizontalFilter(
   ClassType
     storage_class;
 
-  ContributionInfo
-    **magick_restrict contributions;
-
-  double
-    scale,
-    support;
+  ContributionTable
+    *magick_restrict contributions;
 
   MagickBooleanType
-    status;
+    blend,
+    status,
+    unroll;
+
+  PixelTrait
+    channel_traits[MaxPixelChannels];
 
   ssize_t
     x;
@@ -3365,28 +3802,23 @@ static MagickBooleanType HorizontalFilter(
   /*
     Apply filter to resize horizontally from image to resize image.
   */
-  scale=MagickMax(1.0/x_factor+MagickEpsilon,1.0);
-  support=scale*GetResizeFilterSupport(resize_filter);
-  storage_class=support > 0.5 ? DirectClass : image->storage_class;
-  if (SetImageStorageClass(resize_image,storage_class,exception) == MagickFalse)
-    return(MagickFalse);
-  if (support < 0.5)
-    {
-      /*
-        Support too small even for nearest neighbour: Reduce to point sampling.
-      */
-      support=(double) 0.5;
-      scale=1.0;
-    }
-  contributions=AcquireContributionTLS((size_t) (2.0*support+3.0));
-  if (contributions == (ContributionInfo **) NULL)
+  contributions=AcquireContributionTable(resize_filter,image->columns,
+    resize_image->columns,x_factor);
+  if (contributions == (ContributionTable *) NULL)
     {
       (void) ThrowMagickException(exception,GetMagickModule(),
         ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
       return(MagickFalse);
     }
+  storage_class=contributions->support > 0.5 ? DirectClass :
+    image->storage_class;
+  if (SetImageStorageClass(resize_image,storage_class,exception) == MagickFalse)
+    {
+      contributions=RelinquishContributionTable(contributions);
+      return(MagickFalse);
+    }
+  unroll=GetResizeChannelTraits(image,resize_image,channel_traits,&blend);
   status=MagickTrue;
-  scale=MagickSafeReciprocal(scale);
   image_view=AcquireVirtualCacheView(image,exception);
   resize_view=AcquireAuthenticCacheView(resize_image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
@@ -3395,56 +3827,25 @@ static MagickBooleanType HorizontalFilter(
 #endif
   for (x=0; x < (ssize_t) resize_image->columns; x++)
   {
-    const int
-      id = GetOpenMPThreadId();
+    const ContributionInfo
+      *magick_restrict contribution;
 
     const Quantum
       *magick_restrict p;
 
-    ContributionInfo
-      *magick_restrict contribution;
-
-    double
-      bisect,
-      density;
-
     Quantum
       *magick_restrict q;
 
     ssize_t
       n,
-      start,
-      stop,
       y;
 
     if (status == MagickFalse)
       continue;
-    bisect=(double) (x+0.5)/x_factor+MagickEpsilon;
-    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
-    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) image->columns);
-    density=0.0;
-    contribution=contributions[id];
-    for (n=0; n < (stop-start); n++)
-    {
-      contribution[n].pixel=start+n;
-      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
-        ((double) (start+n)-bisect+0.5));
-      density+=contribution[n].weight;
-    }
+    n=contributions->count[x];
     if (n == 0)
       continue;
-    if ((density != 0.0) && (density != 1.0))
-      {
-        ssize_t
-          i;
-
-        /*
-          Normalize.
-        */
-        density=MagickSafeReciprocal(density);
-        for (i=0; i < n; i++)
-          contribution[i].weight*=density;
-      }
+    contribution=contributions->contributions+x*contributions->stride;
     p=GetCacheViewVirtualPixels(image_view,contribution[0].pixel,0,(size_t)
       (contribution[n-1].pixel-contribution[0].pixel+1),image->rows,exception);
     q=QueueCacheViewAuthenticPixels(resize_view,x,0,1,resize_image->rows,
@@ -3459,6 +3860,14 @@ static MagickBooleanType HorizontalFilter(
       ssize_t
         i;
 
+      if (unroll != MagickFalse)
+        {
+          ResizeContributions(image,channel_traits,blend,contribution,n,p+y*
+            (contribution[n-1].pixel-contribution[0].pixel+1)*(ssize_t)
+            GetPixelChannels(image),1,q);
+          q+=(ptrdiff_t) GetPixelChannels(resize_image);
+          continue;
+        }
       for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
       {
         double
@@ -3486,10 +3895,9 @@ static MagickBooleanType HorizontalFilter(
         if (((resize_traits & CopyPixelTrait) != 0) ||
             (GetPixelWriteMask(resize_image,q) <= (QuantumRange/2)))
           {
-            j=(ssize_t) (MagickMin(MagickMax(bisect,(double) start),(double)
-              stop-1.0)+0.5);
+            j=contributions->nearest[x];
             k=y*(contribution[n-1].pixel-contribution[0].pixel+1)+
-              (contribution[j-start].pixel-contribution[0].pixel);
+              (contribution[j].pixel-contribution[0].pixel);
             SetPixelChannel(resize_image,channel,
               p[k*(ssize_t) GetPixelChannels(image)+i],q);
             continue;
@@ -3546,7 +3954,7 @@ static MagickBooleanType HorizontalFilter(
   }
   resize_view=DestroyCacheView(resize_view);
   image_view=DestroyCacheView(image_view);
-  contributions=DestroyContributionTLS(contributions);
+  contributions=RelinquishContributionTable(contributions);
   return(status);
 }
 
@@ -3563,15 +3971,16 @@ static MagickBooleanType VerticalFilter(
   ClassType
     storage_class;
 
-  ContributionInfo
-    **magick_restrict contributions;
-
-  double
-    scale,
-    support;
+  ContributionTable
+    *magick_restrict contributions;
 
   MagickBooleanType
-    status;
+    blend,
+    status,
+    unroll;
+
+  PixelTrait
+    channel_traits[MaxPixelChannels];
 
   ssize_t
     y;
@@ -3579,28 +3988,23 @@ static MagickBooleanType VerticalFilter(
   /*
     Apply filter to resize vertically from image to resize image.
   */
-  scale=MagickMax(1.0/y_factor+MagickEpsilon,1.0);
-  support=scale*GetResizeFilterSupport(resize_filter);
-  storage_class=support > 0.5 ? DirectClass : image->storage_class;
-  if (SetImageStorageClass(resize_image,storage_class,exception) == MagickFalse)
-    return(MagickFalse);
-  if (support < 0.5)
-    {
-      /*
-        Support too small even for nearest neighbour: Reduce to point sampling.
-      */
-      support=(double) 0.5;
-      scale=1.0;
-    }
-  contributions=AcquireContributionTLS((size_t) (2.0*support+3.0));
-  if (contributions == (ContributionInfo **) NULL)
+  contributions=AcquireContributionTable(resize_filter,image->rows,
+    resize_image->rows,y_factor);
+  if (contributions == (ContributionTable *) NULL)
     {
       (void) ThrowMagickException(exception,GetMagickModule(),
         ResourceLimitError,"MemoryAllocationFailed","`%s'",image->filename);
       return(MagickFalse);
     }
+  storage_class=contributions->support > 0.5 ? DirectClass :
+    image->storage_class;
+  if (SetImageStorageClass(resize_image,storage_class,exception) == MagickFalse)
+    {
+      contributions=RelinquishContributionTable(contributions);
+      return(MagickFalse);
+    }
+  unroll=GetResizeChannelTraits(image,resize_image,channel_traits,&blend);
   status=MagickTrue;
-  scale=MagickSafeReciprocal(scale);
   image_view=AcquireVirtualCacheView(image,exception);
   resize_view=AcquireAuthenticCacheView(resize_image,exception);
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
@@ -3609,56 +4013,25 @@ static MagickBooleanType VerticalFilter(
 #endif
   for (y=0; y < (ssize_t) resize_image->rows; y++)
   {
-    const int
-      id = GetOpenMPThreadId();
+    const ContributionInfo
+      *magick_restrict contribution;
 
     const Quantum
       *magick_restrict p;
 
-    ContributionInfo
-      *magick_restrict contribution;
-
-    double
-      bisect,
-      density;
-
     Quantum
       *magick_restrict q;
 
     ssize_t
       n,
-      start,
-      stop,
       x;
 
     if (status == MagickFalse)
       continue;
-    bisect=(double) (y+0.5)/y_factor+MagickEpsilon;
-    start=(ssize_t) MagickMax(bisect-support+0.5,0.0);
-    stop=(ssize_t) MagickMin(bisect+support+0.5,(double) image->rows);
-    density=0.0;
-    contribution=contributions[id];
-    for (n=0; n < (stop-start); n++)
-    {
-      contribution[n].pixel=start+n;
-      contribution[n].weight=GetResizeFilterWeight(resize_filter,scale*
-        ((double) (start+n)-bisect+0.5));
-      density+=contribution[n].weight;
-    }
+    n=contributions->count[y];
     if (n == 0)
       continue;
-    if ((density != 0.0) && (density != 1.0))
-      {
-        ssize_t
-          i;
-
-        /*
-          Normalize.
-        */
-        density=MagickSafeReciprocal(density);
-        for (i=0; i < n; i++)
-          contribution[i].weight*=density;
-      }
+    contribution=contributions->contributions+y*contributions->stride;
     p=GetCacheViewVirtualPixels(image_view,0,contribution[0].pixel,
       image->columns,(size_t) (contribution[n-1].pixel-contribution[0].pixel+1),
       exception);
@@ -3674,6 +4047,13 @@ static MagickBooleanType VerticalFilter(
       ssize_t
         i;
 
+      if (unroll != MagickFalse)
+        {
+          ResizeContributions(image,channel_traits,blend,contribution,n,p+x*
+            (ssize_t) GetPixelChannels(image),(ssize_t) image->columns,q);
+          q+=(ptrdiff_t) GetPixelChannels(resize_image);
+          continue;
+        }
       for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
       {
         double
@@ -3701,9 +4081,8 @@ static MagickBooleanType VerticalFilter(
         if (((resize_traits & CopyPixelTrait) != 0) ||
             (GetPixelWriteMask(resize_image,q) <= (QuantumRange/2)))
           {
-            j=(ssize_t) (MagickMin(MagickMax(bisect,(double) start),(double)
-              stop-1.0)+0.5);
-            k=(ssize_t) ((contribution[j-start].pixel-contribution[0].pixel)*
+            j=contributions->nearest[y];
+            k=(ssize_t) ((contribution[j].pixel-contribution[0].pixel)*
               (ssize_t) image->columns+x);
             SetPixelChannel(resize_image,channel,p[k*(ssize_t)
               GetPixelChannels(image)+i],q);
@@ -3758,7 +4137,7 @@ static MagickBooleanType VerticalFilter(
   }
   resize_view=DestroyCacheView(resize_view);
   image_view=DestroyCacheView(image_view);
-  contributions=DestroyContributionTLS(contributions);
+  contributions=RelinquishContributionTable(contributions);
   return(status);
 }
 
@@ -3919,6 +4298,36 @@ MagickExport Image *ResizeImage(const Image *image,const size_t columns,
 %    o exception: return any errors or warnings in this structure.
 %
 */
+static PointInfo GetSampleOffset(const Image *image)
+{
+  const char
+    *value;
+
+  PointInfo
+    sample_offset;
+
+  /*
+    Set the sampling offset, default is in the mid-point of sample regions.
+  */
+  sample_offset.x=0.5-MagickEpsilon;
+  sample_offset.y=sample_offset.x;
+  value=GetImageArtifact(image,"sample:offset");
+  if (value != (char *) NULL)
+    {
+      GeometryInfo
+        geometry_info;
+
+      MagickStatusType
+        flags;
+
+      flags=ParseGeometry(value,&geometry_info);
+      sample_offset.x=sample_offset.y=geometry_info.rho/100.0-MagickEpsilon;
+      if ((flags & SigmaValue) != 0)
+        sample_offset.y=geometry_info.sigma/100.0-MagickEpsilon;
+    }
+  return(sample_offset);
+}
+
 MagickExport Image *SampleImage(const Image *image,const size_t columns,
   const size_t rows,ExceptionInfo *exception)
 {
@@ -3959,31 +4368,7 @@ MagickExport Image *SampleImage(const Image *image,const size_t columns,
   sample_image=CloneImage(image,columns,rows,MagickTrue,exception);
   if (sample_image == (Image *) NULL)
     return((Image *) NULL);
-  /*
-    Set the sampling offset, default is in the mid-point of sample regions.
-  */
-  sample_offset.x=0.5-MagickEpsilon;
-  sample_offset.y=sample_offset.x;
-  {
-    const char
-      *value;
-
-    value=GetImageArtifact(image,"sample:offset");
-    if (value != (char *) NULL)
-      {
-        GeometryInfo
-          geometry_info;
-
-        MagickStatusType
-          flags;
-
-        (void) ParseGeometry(value,&geometry_info);
-        flags=ParseGeometry(value,&geometry_info);
-        sample_offset.x=sample_offset.y=geometry_info.rho/100.0-MagickEpsilon;
-        if ((flags & SigmaValue) != 0)
-          sample_offset.y=geometry_info.sigma/100.0-MagickEpsilon;
-      }
-  }
+  sample_offset=GetSampleOffset(image);
   /*
     Sample each row.
   */
@@ -4593,6 +4978,171 @@ static void url_encode(const char *uri,char *encode_uri)
   *p='\0';
 }
 
+static Image *SampleBoxImage(const Image *image,const size_t columns,
+  const size_t rows,ExceptionInfo *exception)
+{
+#define ThumbnailImageTag  "Thumbnail/Image"
+
+  CacheView
+    *image_view,
+    *sample_view;
+
+  Image
+    *sample_image;
+
+  MagickBooleanType
+    status;
+
+  MagickOffsetType
+    progress;
+
+  PointInfo
+    sample_offset;
+
+  ssize_t
+    *x_offset,
+    x,
+    y;
+
+  /*
+    Point sample the image on a grid twice the target size and box filter each
+    2x2 cell in the same pass.  This is equivalent to a SampleImage() followed
+    by a box-filtered ResizeImage() without the intermediate sampled image.
+  */
+  sample_image=CloneImage(image,columns,rows,MagickTrue,exception);
+  if (sample_image == (Image *) NULL)
+    return((Image *) NULL);
+  if (SetImageStorageClass(sample_image,DirectClass,exception) == MagickFalse)
+    return(DestroyImage(sample_image));
+  sample_offset=GetSampleOffset(image);
+  x_offset=(ssize_t *) AcquireQuantumMemory(2*columns,sizeof(*x_offset));
+  if (x_offset == (ssize_t *) NULL)
+    {
+      sample_image=DestroyImage(sample_image);
+      ThrowImageException(ResourceLimitError,"MemoryAllocationFailed");
+    }
+  for (x=0; x < (ssize_t) (2*columns); x++)
+    x_offset[x]=(ssize_t) ((((double) x+sample_offset.x)*image->columns)/
+      (2.0*columns));
+  status=MagickTrue;
+  progress=0;
+  image_view=AcquireVirtualCacheView(image,exception);
+  sample_view=AcquireAuthenticCacheView(sample_image,exception);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static) shared(progress,status) \
+    magick_number_threads(image,sample_image,sample_image->rows,1)
+#endif
+  for (y=0; y < (ssize_t) sample_image->rows; y++)
+  {
+    const Quantum
+      *magick_restrict p;
+
+    Quantum
+      *magick_restrict q;
+
+    ssize_t
+      y_offset[2];
+
+    if (status == MagickFalse)
+      continue;
+    y_offset[0]=(ssize_t) ((((double) 2*y+sample_offset.y)*image->rows)/
+      (2.0*rows));
+    y_offset[1]=(ssize_t) ((((double) 2*y+1.0+sample_offset.y)*image->rows)/
+      (2.0*rows));
+    p=GetCacheViewVirtualPixels(image_view,0,y_offset[0],image->columns,
+      (size_t) (y_offset[1]-y_offset[0]+1),exception);
+    q=QueueCacheViewAuthenticPixels(sample_view,0,y,sample_image->columns,1,
+      exception);
+    if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
+      {
+        status=MagickFalse;
+        continue;
+      }
+    for (x=0; x < (ssize_t) sample_image->columns; x++)
+    {
+      const Quantum
+        *magick_restrict r[4];
+
+      ssize_t
+        i,
+        j;
+
+      for (j=0; j < 4; j++)
+        r[j]=p+((j >> 1)*(y_offset[1]-y_offset[0])*(ssize_t) image->columns+
+          x_offset[2*x+(j & 0x01)])*(ssize_t) GetPixelChannels(image);
+      for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
+      {
+        double
+          alpha,
+          gamma,
+          pixel;
+
+        PixelChannel
+          channel;
+
+        PixelTrait
+          sample_traits,
+          traits;
+
+        channel=GetPixelChannelChannel(image,i);
+        traits=GetPixelChannelTraits(image,channel);
+        sample_traits=GetPixelChannelTraits(sample_image,channel);
+        if ((traits == UndefinedPixelTrait) ||
+            (sample_traits == UndefinedPixelTrait))
+          continue;
+        if (((sample_traits & CopyPixelTrait) != 0) ||
+            (GetPixelWriteMask(sample_image,q) <= (QuantumRange/2)))
+          {
+            SetPixelChannel(sample_image,channel,r[3][i],q);
+            continue;
+          }
+        pixel=0.0;
+        if ((sample_traits & BlendPixelTrait) == 0)
+          {
+            for (j=0; j < 4; j++)
+              pixel+=(double) r[j][i];
+            SetPixelChannel(sample_image,channel,ClampToQuantum(0.25*pixel),
+              q);
+            continue;
+          }
+        gamma=0.0;
+        for (j=0; j < 4; j++)
+        {
+          alpha=QuantumScale*(double) GetPixelAlpha(image,r[j]);
+          pixel+=alpha*(double) r[j][i];
+          gamma+=alpha;
+        }
+        gamma=MagickSafeReciprocal(gamma);
+        SetPixelChannel(sample_image,channel,ClampToQuantum(gamma*pixel),q);
+      }
+      q+=(ptrdiff_t) GetPixelChannels(sample_image);
+    }
+    if (SyncCacheViewAuthenticPixels(sample_view,exception) == MagickFalse)
+      status=MagickFalse;
+    if (image->progress_monitor != (MagickProgressMonitor) NULL)
+      {
+        MagickBooleanType
+          proceed;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+        #pragma omp atomic
+#endif
+        progress++;
+        proceed=SetImageProgress(image,ThumbnailImageTag,progress,
+          sample_image->rows);
+        if (proceed == MagickFalse)
+          status=MagickFalse;
+      }
+  }
+  sample_view=DestroyCacheView(sample_view);
+  image_view=DestroyCacheView(image_view);
+  x_offset=(ssize_t *) RelinquishMagickMemory(x_offset);
+  sample_image->type=image->type;
+  if (status == MagickFalse)
+    sample_image=DestroyImage(sample_image);
+  return(sample_image);
+}
+
 MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
   const size_t rows,ExceptionInfo *exception)
 {
@@ -4634,16 +5184,11 @@ MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
       y_factor=(ssize_t) (image->rows*MagickSafeReciprocal((double) rows));
       if ((x_factor > 4) && (y_factor > 4))
         {
-          thumbnail_image=SampleImage(clone_image,4*columns,4*rows,exception);
-          if (thumbnail_image != (Image *) NULL)
-            {
-              clone_image=DestroyImage(clone_image);
-              clone_image=thumbnail_image;
-            }
-        }
-      if ((x_factor > 2) && (y_factor > 2))
-        {
-          thumbnail_image=ResizeImage(clone_image,2*columns,2*rows,BoxFilter,
+          /*
+            Sample and box filter in one pass to avoid a 4x intermediate.
+            The final resize below still runs as its own pass.
+          */
+          thumbnail_image=SampleBoxImage(clone_image,2*columns,2*rows,
             exception);
           if (thumbnail_image != (Image *) NULL)
             {
@@ -4651,6 +5196,17 @@ MagickExport Image *ThumbnailImage(const Image *image,const size_t columns,
               clone_image=thumbnail_image;
             }
         }
+      else
+        if ((x_factor > 2) && (y_factor > 2))
+          {
+            thumbnail_image=ResizeImage(clone_image,2*columns,2*rows,
+              BoxFilter,exception);
+            if (thumbnail_image != (Image *) NULL)
+              {
+                clone_image=DestroyImage(clone_image);
+                clone_image=thumbnail_image;
+              }
+          }
       thumbnail_image=ResizeImage(clone_image,columns,rows,image->filter ==
         UndefinedFilter ? LanczosSharpFilter : image->filter,exception);
       clone_image=DestroyImage(clone_image);
@@ -42,8 +42,10 @@
 #include "MagickCore/studio.h"
 #include "MagickCore/cache.h"
 #include "MagickCore/configure.h"
+#include "MagickCore/draw-private.h"
 #include "MagickCore/exception.h"
 #include "MagickCore/exception-private.h"
+#include "MagickCore/fourier-private.h"
 #include "MagickCore/linked-list.h"
 #include "MagickCore/log.h"
 #include "MagickCore/image.h"
@@ -52,8 +54,11 @@
 #include "MagickCore/nt-base-private.h"
 #include "MagickCore/option.h"
 #include "MagickCore/policy.h"
+#include "MagickCore/profile-private.h"
 #include "MagickCore/random_.h"
 #include "MagickCore/registry.h"
+#include "MagickCore/resize.h"
+#include "MagickCore/resize-private.h"
 #include "MagickCore/resource_.h"
 #include "MagickCore/resource-private.h"
 #include "MagickCore/semaphore.h"
@@ -926,10 +931,27 @@ MagickExport MagickBooleanType ListMagickResourceInfo(FILE *file,
     time_limit[MagickFormatExtent],
     width_limit[MagickFormatExtent];
 
+  MagickSizeType
+    contribution_hits,
+    contribution_misses,
+    path_hits,
+    path_misses,
+    plan_hits,
+    plan_misses,
+    transform_hits,
+    transform_misses;
+
   magick_unreferenced(exception);
 
   if (file == (const FILE *) NULL)
     file=stdout;
+  /*
+    The caches have their own locks; do not hold the resource lock for them.
+  */
+  GetResizeContributionStatistics(&contribution_hits,&contribution_misses);
+  GetProfileTransformStatistics(&transform_hits,&transform_misses);
+  GetFourierPlanStatistics(&plan_hits,&plan_misses);
+  GetDrawPathStatistics(&path_hits,&path_misses);
   if (resource_semaphore[FileResource] == (SemaphoreInfo *) NULL)
     ActivateSemaphoreInfo(&resource_semaphore[FileResource]);
   LockSemaphoreInfo(resource_semaphore[FileResource]);
@@ -969,6 +991,15 @@ MagickExport MagickBooleanType ListMagickResourceInfo(FILE *file,
   (void) FormatLocaleFile(file,"  Throttle: %.17g\n",(double)
     ((MagickOffsetType) resource_info.throttle_limit));
   (void) FormatLocaleFile(file,"  Time: %s\n",time_limit);
+  (void) FormatLocaleFile(file,"Resource caches:\n");
+  (void) FormatLocaleFile(file,"  Resize contributions: %.20g hits, "
+    "%.20g misses\n",(double) contribution_hits,(double) contribution_misses);
+  (void) FormatLocaleFile(file,"  Color transforms: %.20g hits, "
+    "%.20g misses\n",(double) transform_hits,(double) transform_misses);
+  (void) FormatLocaleFile(file,"  Fourier plans: %.20g hits, %.20g misses\n",
+    (double) plan_hits,(double) plan_misses);
+  (void) FormatLocaleFile(file,"  Vector paths: %.20g hits, %.20g misses\n",
+    (double) path_hits,(double) path_misses);
   (void) fflush(file);
   UnlockSemaphoreInfo(resource_semaphore[FileResource]);
   return(MagickTrue);
@@ -72,6 +72,7 @@
 #include "MagickCore/magic.h"
 #include "MagickCore/magick.h"
 #include "MagickCore/memory_.h"
+#include "MagickCore/memory-private.h"
 #include "MagickCore/module.h"
 #include "MagickCore/monitor.h"
 #include "MagickCore/monitor-private.h"
@@ -91,6 +92,7 @@
 #include "MagickCore/statistic.h"
 #include "MagickCore/statistic-private.h"
 #include "MagickCore/string_.h"
+#include "MagickCore/string-private.h"
 #include "MagickCore/thread-private.h"
 #include "MagickCore/timer.h"
 #include "MagickCore/utility.h"
@@ -142,20 +144,9 @@ typedef struct _PixelChannels
 static PixelChannels **DestroyPixelTLS(const Image *images,
   PixelChannels **pixels)
 {
-  ssize_t
-    i;
-
-  size_t
-    rows;
-
+  magick_unreferenced(images);
   assert(pixels != (PixelChannels **) NULL);
-  rows=MagickMax(GetImageListLength(images),(size_t)
-    GetMagickResourceLimit(ThreadResource));
-  for (i=0; i < (ssize_t) rows; i++)
-    if (pixels[i] != (PixelChannels *) NULL)
-      pixels[i]=(PixelChannels *) RelinquishMagickMemory(pixels[i]);
-  pixels=(PixelChannels **) RelinquishMagickMemory(pixels);
-  return(pixels);
+  return((PixelChannels **) RelinquishArenaMemory(pixels));
 }
 
 static PixelChannels **AcquirePixelTLS(const Image *images)
@@ -176,7 +167,7 @@ static PixelChannels **AcquirePixelTLS(const Image *images)
 
   number_images=GetImageListLength(images);
   rows=MagickMax(number_images,(size_t) GetMagickResourceLimit(ThreadResource));
-  pixels=(PixelChannels **) AcquireQuantumMemory(rows,sizeof(*pixels));
+  pixels=(PixelChannels **) AcquireArenaMemory(rows,sizeof(*pixels));
   if (pixels == (PixelChannels **) NULL)
     return((PixelChannels **) NULL);
   (void) memset(pixels,0,rows*sizeof(*pixels));
@@ -188,7 +179,7 @@ static PixelChannels **AcquirePixelTLS(const Image *images)
     ssize_t
       j;
 
-    pixels[i]=(PixelChannels *) AcquireQuantumMemory(columns,sizeof(**pixels));
+    pixels[i]=(PixelChannels *) AcquireArenaMemory(columns,sizeof(**pixels));
     if (pixels[i] == (PixelChannels *) NULL)
       return(DestroyPixelTLS(images,pixels));
     for (j=0; j < (ssize_t) columns; j++)
@@ -2600,7 +2591,11 @@ MagickExport Image *PolynomialImage(const Image *images,
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
 %
 %  StatisticImage() makes each pixel the min / max / median / mode / etc. of
-%  the neighborhood of the specified width and height.
+%  the neighborhood of the specified width and height.  The median, mode, and
+%  nonpeak statistics slide a 16-bit histogram along each row, and the min,
+%  max, gradient, and contrast statistics slide the column extrema, so their
+%  cost grows with the neighborhood height rather than its area.  Define
+%  statistic:percentile to select a percentile other than the median.
 %
 %  The format of the StatisticImage method is:
 %
@@ -2621,31 +2616,31 @@ MagickExport Image *PolynomialImage(const Image *images,
 %
 */
 
-typedef struct _SkipNode
+#define HistogramBuckets  256
+#define HistogramColors  65536
+
+typedef struct _PixelList
 {
   size_t
-    next[9],
-    count,
-    signature;
-} SkipNode;
+    length,
+    below,
+    maximum;
 
-typedef struct _SkipList
-{
   ssize_t
-    level;
+    position;
 
-  SkipNode
-    *nodes;
-} SkipList;
-
-typedef struct _PixelList
-{
   size_t
-    length,
-    seed;
+    *buckets,
+    *counts,
+    *frequencies;
 
-  SkipList
-    skip_list;
+  double
+    *maxima,
+    *minima;
+
+  ssize_t
+    *maxima_queue,
+    *minima_queue;
 
   size_t
     signature;
@@ -2655,9 +2650,23 @@ static PixelList *DestroyPixelList(PixelList *pixel_list)
 {
   if (pixel_list == (PixelList *) NULL)
     return((PixelList *) NULL);
-  if (pixel_list->skip_list.nodes != (SkipNode *) NULL)
-    pixel_list->skip_list.nodes=(SkipNode *) RelinquishAlignedMemory(
-      pixel_list->skip_list.nodes);
+  if (pixel_list->minima_queue != (ssize_t *) NULL)
+    pixel_list->minima_queue=(ssize_t *) RelinquishMagickMemory(
+      pixel_list->minima_queue);
+  if (pixel_list->maxima_queue != (ssize_t *) NULL)
+    pixel_list->maxima_queue=(ssize_t *) RelinquishMagickMemory(
+      pixel_list->maxima_queue);
+  if (pixel_list->minima != (double *) NULL)
+    pixel_list->minima=(double *) RelinquishMagickMemory(pixel_list->minima);
+  if (pixel_list->maxima != (double *) NULL)
+    pixel_list->maxima=(double *) RelinquishMagickMemory(pixel_list->maxima);
+  if (pixel_list->frequencies != (size_t *) NULL)
+    pixel_list->frequencies=(size_t *) RelinquishMagickMemory(
+      pixel_list->frequencies);
+  if (pixel_list->counts != (size_t *) NULL)
+    pixel_list->counts=(size_t *) RelinquishAlignedMemory(pixel_list->counts);
+  if (pixel_list->buckets != (size_t *) NULL)
+    pixel_list->buckets=(size_t *) RelinquishMagickMemory(pixel_list->buckets);
   pixel_list=(PixelList *) RelinquishMagickMemory(pixel_list);
   return(pixel_list);
 }
@@ -2675,7 +2684,8 @@ static PixelList **DestroyPixelListTLS(PixelList **pixel_list)
   return(pixel_list);
 }
 
-static PixelList *AcquirePixelList(const size_t width,const size_t height)
+static PixelList *AcquirePixelList(const StatisticType type,
+  const size_t columns,const size_t width,const size_t height)
 {
   PixelList
     *pixel_list;
@@ -2685,18 +2695,68 @@ static PixelList *AcquirePixelList(const size_t width,const size_t height)
     return(pixel_list);
   (void) memset((void *) pixel_list,0,sizeof(*pixel_list));
   pixel_list->length=width*height;
-  pixel_list->skip_list.nodes=(SkipNode *) AcquireAlignedMemory(65537UL,
-    sizeof(*pixel_list->skip_list.nodes));
-  if (pixel_list->skip_list.nodes == (SkipNode *) NULL)
-    return(DestroyPixelList(pixel_list));
-  (void) memset(pixel_list->skip_list.nodes,0,65537UL*
-    sizeof(*pixel_list->skip_list.nodes));
+  switch (type)
+  {
+    case MedianStatistic:
+    case ModeStatistic:
+    case NonpeakStatistic:
+    {
+      /*
+        A two-level histogram: 256 buckets of 256 colors each.
+      */
+      pixel_list->buckets=(size_t *) AcquireQuantumMemory(HistogramBuckets,
+        sizeof(*pixel_list->buckets));
+      pixel_list->counts=(size_t *) AcquireAlignedMemory(HistogramColors,
+        sizeof(*pixel_list->counts));
+      if ((pixel_list->buckets == (size_t *) NULL) ||
+          (pixel_list->counts == (size_t *) NULL))
+        return(DestroyPixelList(pixel_list));
+      (void) memset(pixel_list->buckets,0,HistogramBuckets*
+        sizeof(*pixel_list->buckets));
+      (void) memset(pixel_list->counts,0,HistogramColors*
+        sizeof(*pixel_list->counts));
+      if (type != ModeStatistic)
+        break;
+      pixel_list->frequencies=(size_t *) AcquireQuantumMemory(
+        pixel_list->length+1,sizeof(*pixel_list->frequencies));
+      if (pixel_list->frequencies == (size_t *) NULL)
+        return(DestroyPixelList(pixel_list));
+      (void) memset(pixel_list->frequencies,0,(pixel_list->length+1)*
+        sizeof(*pixel_list->frequencies));
+      break;
+    }
+    case ContrastStatistic:
+    case GradientStatistic:
+    case MaximumStatistic:
+    case MinimumStatistic:
+    {
+      /*
+        Column extrema and the monotonic queues that slide across them.
+      */
+      pixel_list->maxima=(double *) AcquireQuantumMemory(columns+width,
+        sizeof(*pixel_list->maxima));
+      pixel_list->minima=(double *) AcquireQuantumMemory(columns+width,
+        sizeof(*pixel_list->minima));
+      pixel_list->maxima_queue=(ssize_t *) AcquireQuantumMemory(columns+width,
+        sizeof(*pixel_list->maxima_queue));
+      pixel_list->minima_queue=(ssize_t *) AcquireQuantumMemory(columns+width,
+        sizeof(*pixel_list->minima_queue));
+      if ((pixel_list->maxima == (double *) NULL) ||
+          (pixel_list->minima == (double *) NULL) ||
+          (pixel_list->maxima_queue == (ssize_t *) NULL) ||
+          (pixel_list->minima_queue == (ssize_t *) NULL))
+        return(DestroyPixelList(pixel_list));
+      break;
+    }
+    default:
+      break;
+  }
   pixel_list->signature=MagickCoreSignature;
   return(pixel_list);
 }
 
-static PixelList **AcquirePixelListTLS(const size_t width,
-  const size_t height)
+static PixelList **AcquirePixelListTLS(const StatisticType type,
+  const size_t columns,const size_t width,const size_t height)
 {
   PixelList
     **pixel_list;
@@ -2715,163 +2775,139 @@ static PixelList **AcquirePixelListTLS(const size_t width,
   (void) memset(pixel_list,0,number_threads*sizeof(*pixel_list));
   for (i=0; i < (ssize_t) number_threads; i++)
   {
-    pixel_list[i]=AcquirePixelList(width,height);
+    pixel_list[i]=AcquirePixelList(type,columns,width,height);
     if (pixel_list[i] == (PixelList *) NULL)
       return(DestroyPixelListTLS(pixel_list));
   }
   return(pixel_list);
 }
 
-static void AddNodePixelList(PixelList *pixel_list,const size_t color)
+static inline ssize_t GetNextPixelList(const PixelList *pixel_list,
+  const ssize_t color)
 {
-  SkipList
-    *p;
-
   ssize_t
-    level;
-
-  size_t
-    search,
-    update[9];
+    bucket,
+    i;
 
   /*
-    Initialize the node.
+    Return the smallest color in the list greater than the given color.
   */
-  p=(&pixel_list->skip_list);
-  p->nodes[color].signature=pixel_list->signature;
-  p->nodes[color].count=1;
+  for (i=color+1; (i % HistogramBuckets) != 0; i++)
+    if (pixel_list->counts[i] != 0)
+      return(i);
+  for (bucket=i/HistogramBuckets; bucket < HistogramBuckets; bucket++)
+    if (pixel_list->buckets[bucket] != 0)
+      {
+        for (i=bucket*HistogramBuckets; pixel_list->counts[i] == 0; i++) ;
+        return(i);
+      }
+  return(HistogramColors);
+}
+
+static inline ssize_t GetPreviousPixelList(const PixelList *pixel_list,
+  const ssize_t color)
+{
+  ssize_t
+    bucket,
+    i;
+
   /*
-    Determine where it belongs in the list.
+    Return the largest color in the list less than the given color.
   */
-  search=65536UL;
-  (void) memset(update,0,sizeof(update));
-  for (level=p->level; level >= 0; level--)
-  {
-    while (p->nodes[search].next[level] < color)
-      search=p->nodes[search].next[level];
-    update[level]=search;
-  }
+  if (color <= 0)
+    return(-1);
+  for (i=color-1; (i % HistogramBuckets) != (HistogramBuckets-1); i--)
+    if (pixel_list->counts[i] != 0)
+      return(i);
+    else
+      if (i == 0)
+        return(-1);
+  for (bucket=i/HistogramBuckets; bucket >= 0; bucket--)
+    if (pixel_list->buckets[bucket] != 0)
+      {
+        for (i=bucket*HistogramBuckets+HistogramBuckets-1;
+             pixel_list->counts[i] == 0; i--) ;
+        return(i);
+      }
+  return(-1);
+}
+
+static inline ssize_t GetRankPixelList(PixelList *pixel_list,
+  const size_t rank)
+{
   /*
-    Generate a pseudo-random level for this node.
+    Return the first color whose cumulative count exceeds the rank.  The
+    position is carried from one neighborhood to the next, so it typically
+    moves just a few colors per pixel.
   */
-  for (level=0; ; level++)
+  while (pixel_list->below > rank)
   {
-    pixel_list->seed=(pixel_list->seed*42893621L)+1L;
-    if ((pixel_list->seed & 0x300) != 0x300)
-      break;
+    pixel_list->position=GetPreviousPixelList(pixel_list,pixel_list->position);
+    pixel_list->below-=pixel_list->counts[pixel_list->position];
   }
-  if (level > 8)
-    level=8;
-  if (level > (p->level+2))
-    level=p->level+2;
-  /*
-    If we're raising the list's level, link back to the root node.
-  */
-  while (level > p->level)
+  while ((pixel_list->below+pixel_list->counts[pixel_list->position]) <= rank)
   {
-    p->level++;
-    update[p->level]=65536UL;
+    pixel_list->below+=pixel_list->counts[pixel_list->position];
+    pixel_list->position=GetNextPixelList(pixel_list,pixel_list->position);
   }
-  /*
-    Link the node into the skip-list.
-  */
-  do
-  {
-    p->nodes[color].next[level]=p->nodes[update[level]].next[level];
-    p->nodes[update[level]].next[level]=color;
-  } while (level-- > 0);
+  return(pixel_list->position);
 }
 
-static inline void GetMedianPixelList(PixelList *pixel_list,Quantum *pixel)
+static inline void GetMedianPixelList(PixelList *pixel_list,const size_t rank,
+  Quantum *pixel)
 {
-  SkipList
-    *p;
-
-  size_t
-    color;
-
-  ssize_t
-    count;
-
-  /*
-    Find the median value for each of the color.
-  */
-  p=(&pixel_list->skip_list);
-  color=65536L;
-  count=0;
-  do
-  {
-    color=p->nodes[color].next[0];
-    count+=(ssize_t) p->nodes[color].count;
-  } while (count <= (ssize_t) (pixel_list->length >> 1));
-  *pixel=ScaleShortToQuantum((unsigned short) color);
+  *pixel=ScaleShortToQuantum((unsigned short) GetRankPixelList(pixel_list,
+    rank));
 }
 
 static inline void GetModePixelList(PixelList *pixel_list,Quantum *pixel)
 {
-  SkipList
-    *p;
-
-  size_t
-    color,
-    max_count,
-    mode;
-
   ssize_t
-    count;
+    bucket,
+    color;
 
   /*
-    Make each pixel the 'predominant color' of the specified neighborhood.
+    Make each pixel the 'predominant color' of the specified neighborhood:
+    the smallest color with the largest count.  Buckets with fewer members
+    than the largest count cannot hold it.
   */
-  p=(&pixel_list->skip_list);
-  color=65536L;
-  mode=color;
-  max_count=p->nodes[mode].count;
-  count=0;
-  do
+  color=0;
+  for (bucket=0; bucket < HistogramBuckets; bucket++)
   {
-    color=p->nodes[color].next[0];
-    if (p->nodes[color].count > max_count)
+    ssize_t
+      i;
+
+    if (pixel_list->buckets[bucket] < pixel_list->maximum)
+      continue;
+    for (i=0; i < HistogramBuckets; i++)
+      if (pixel_list->counts[bucket*HistogramBuckets+i] == pixel_list->maximum)
+        break;
+    if (i < HistogramBuckets)
       {
-        mode=color;
-        max_count=p->nodes[mode].count;
+        color=bucket*HistogramBuckets+i;
+        break;
       }
-    count+=(ssize_t) p->nodes[color].count;
-  } while (count < (ssize_t) pixel_list->length);
-  *pixel=ScaleShortToQuantum((unsigned short) mode);
+  }
+  *pixel=ScaleShortToQuantum((unsigned short) color);
 }
 
 static inline void GetNonpeakPixelList(PixelList *pixel_list,Quantum *pixel)
 {
-  SkipList
-    *p;
-
-  size_t
+  ssize_t
     color,
     next,
     previous;
 
-  ssize_t
-    count;
-
   /*
     Finds the non peak value for each of the colors.
   */
-  p=(&pixel_list->skip_list);
-  color=65536L;
-  next=p->nodes[color].next[0];
-  count=0;
-  do
-  {
-    previous=color;
-    color=next;
-    next=p->nodes[color].next[0];
-    count+=(ssize_t) p->nodes[color].count;
-  } while (count <= (ssize_t) (pixel_list->length >> 1));
-  if ((previous == 65536UL) && (next != 65536UL))
+  color=GetRankPixelList(pixel_list,pixel_list->length >> 1);
+  previous=GetPreviousPixelList(pixel_list,color);
+  next=GetNextPixelList(pixel_list,color);
+  if ((previous < 0) && (next != HistogramColors))
     color=next;
   else
-    if ((previous != 65536UL) && (next == 65536UL))
+    if ((previous >= 0) && (next == HistogramColors))
       color=previous;
   *pixel=ScaleShortToQuantum((unsigned short) color);
 }
@@ -2879,41 +2915,56 @@ static inline void GetNonpeakPixelList(PixelList *pixel_list,Quantum *pixel)
 static inline void InsertPixelList(const Quantum pixel,PixelList *pixel_list)
 {
   size_t
-    signature;
+    count;
 
   unsigned short
     index;
 
   index=ScaleQuantumToShort(pixel);
-  signature=pixel_list->skip_list.nodes[index].signature;
-  if (signature == pixel_list->signature)
-    {
-      pixel_list->skip_list.nodes[index].count++;
-      return;
-    }
-  AddNodePixelList(pixel_list,index);
+  count=pixel_list->counts[index]++;
+  pixel_list->buckets[index/HistogramBuckets]++;
+  if ((ssize_t) index < pixel_list->position)
+    pixel_list->below++;
+  if (pixel_list->frequencies == (size_t *) NULL)
+    return;
+  /*
+    Track the largest count by the number of colors at each count.
+  */
+  pixel_list->frequencies[count]--;
+  pixel_list->frequencies[count+1]++;
+  if ((count+1) > pixel_list->maximum)
+    pixel_list->maximum=count+1;
 }
 
-static void ResetPixelList(PixelList *pixel_list)
+static inline void RemovePixelList(const Quantum pixel,PixelList *pixel_list)
 {
-  int
-    level;
+  size_t
+    count;
 
-  SkipNode
-    *root;
+  unsigned short
+    index;
 
-  SkipList
-    *p;
+  index=ScaleQuantumToShort(pixel);
+  count=pixel_list->counts[index]--;
+  pixel_list->buckets[index/HistogramBuckets]--;
+  if ((ssize_t) index < pixel_list->position)
+    pixel_list->below--;
+  if (pixel_list->frequencies == (size_t *) NULL)
+    return;
+  pixel_list->frequencies[count]--;
+  pixel_list->frequencies[count-1]++;
+  if ((count == pixel_list->maximum) && (pixel_list->frequencies[count] == 0))
+    pixel_list->maximum=count-1;
+}
 
+static void ResetPixelList(PixelList *pixel_list)
+{
   /*
-    Reset the skip-list.
+    Reset the rank search; the histogram is emptied by its last removals.
   */
-  p=(&pixel_list->skip_list);
-  root=p->nodes+65536UL;
-  p->level=0;
-  for (level=0; level < 9; level++)
-    root->next[level]=65536UL;
-  pixel_list->seed=pixel_list->signature++;
+  pixel_list->position=0;
+  pixel_list->below=0;
+  pixel_list->maximum=0;
 }
 
 MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
@@ -2925,6 +2976,9 @@ MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
     *image_view,
     *statistic_view;
 
+  const char
+    *artifact;
+
   Image
     *statistic_image;
 
@@ -2937,8 +2991,15 @@ MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
   PixelList
     **magick_restrict pixel_list;
 
+  size_t
+    neighbor_height,
+    neighbor_width,
+    rank;
+
   ssize_t
     center,
+    number_channels,
+    stride,
     y;
 
   /*
@@ -2960,18 +3021,35 @@ MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
       statistic_image=DestroyImage(statistic_image);
       return((Image *) NULL);
     }
-  pixel_list=AcquirePixelListTLS(MagickMax(width,1),MagickMax(height,1));
+  neighbor_width=MagickMax(width,1);
+  neighbor_height=MagickMax(height,1);
+  pixel_list=AcquirePixelListTLS(type,image->columns,neighbor_width,
+    neighbor_height);
   if (pixel_list == (PixelList **) NULL)
     {
       statistic_image=DestroyImage(statistic_image);
       ThrowImageException(ResourceLimitError,"MemoryAllocationFailed");
     }
+  rank=(neighbor_width*neighbor_height) >> 1;
+  artifact=GetImageArtifact(image,"statistic:percentile");
+  if ((type == MedianStatistic) && (artifact != (const char *) NULL))
+    {
+      double
+        percentile;
+
+      percentile=MagickMin(MagickMax(StringToDouble(artifact,(char **) NULL),
+        0.0),100.0);
+      rank=(size_t) (percentile*(neighbor_width*neighbor_height)/100.0);
+      if (rank >= (neighbor_width*neighbor_height))
+        rank=neighbor_width*neighbor_height-1;
+    }
   /*
     Make each pixel the min / max / median / mode / etc. of the neighborhood.
   */
-  center=(ssize_t) GetPixelChannels(image)*((ssize_t) image->columns+
-    MagickMax((ssize_t) width,1L))*(MagickMax((ssize_t) height,1)/2L)+(ssize_t)
-    GetPixelChannels(image)*(MagickMax((ssize_t) width,1L)/2L);
+  number_channels=(ssize_t) GetPixelChannels(image);
+  stride=(ssize_t) (image->columns+neighbor_width);
+  center=number_channels*stride*((ssize_t) neighbor_height/2L)+number_channels*
+    ((ssize_t) neighbor_width/2L);
   status=MagickTrue;
   progress=0;
   image_view=AcquireVirtualCacheView(image,exception);
@@ -2992,146 +3070,269 @@ MagickExport Image *StatisticImage(const Image *image,const StatisticType type,
       *magick_restrict q;
 
     ssize_t
-      x;
+      i;
 
     if (status == MagickFalse)
       continue;
-    p=GetCacheViewVirtualPixels(image_view,-((ssize_t) MagickMax(width,1)/2L),y-
-      (ssize_t) (MagickMax(height,1)/2L),image->columns+MagickMax(width,1),
-      MagickMax(height,1),exception);
-    q=QueueCacheViewAuthenticPixels(statistic_view,0,y,statistic_image->columns,      1,exception);
+    p=GetCacheViewVirtualPixels(image_view,-((ssize_t) neighbor_width/2L),y-
+      (ssize_t) (neighbor_height/2L),(size_t) stride,neighbor_height,exception);
+    q=QueueCacheViewAuthenticPixels(statistic_view,0,y,statistic_image->columns,
+      1,exception);
     if ((p == (const Quantum *) NULL) || (q == (Quantum *) NULL))
       {
         status=MagickFalse;
         continue;
       }
-    for (x=0; x < (ssize_t) statistic_image->columns; x++)
+    for (i=0; i < number_channels; i++)
     {
-      ssize_t
-        i;
+      PixelList
+        *magick_restrict list;
 
-      for (i=0; i < (ssize_t) GetPixelChannels(image); i++)
-      {
-        double
-          area,
-          maximum,
-          minimum,
-          sum,
-          sum_squared;
+      Quantum
+        *magick_restrict r;
 
-        Quantum
-          pixel;
-
-        const Quantum
-          *magick_restrict pixels;
-
-        ssize_t
-          u;
-
-        ssize_t
-          v;
+      ssize_t
+        u,
+        v,
+        x;
 
-        PixelChannel channel = GetPixelChannelChannel(image,i);
-        PixelTrait traits = GetPixelChannelTraits(image,channel);
-        PixelTrait statistic_traits=GetPixelChannelTraits(statistic_image,
-          channel);
-        if (((traits & UpdatePixelTrait) == 0) ||
-            ((statistic_traits & UpdatePixelTrait) == 0))
-          continue;
-        if (((statistic_traits & CopyPixelTrait) != 0) ||
-            (GetPixelWriteMask(image,p) <= (QuantumRange/2)))
+      PixelChannel channel = GetPixelChannelChannel(image,i);
+      PixelTrait traits = GetPixelChannelTraits(image,channel);
+      PixelTrait statistic_traits=GetPixelChannelTraits(statistic_image,
+        channel);
+      if (((traits & UpdatePixelTrait) == 0) ||
+          ((statistic_traits & UpdatePixelTrait) == 0))
+        continue;
+      r=q;
+      if ((statistic_traits & CopyPixelTrait) != 0)
+        {
+          for (x=0; x < (ssize_t) statistic_image->columns; x++)
           {
-            SetPixelChannel(statistic_image,channel,p[center+i],q);
-            continue;
+            SetPixelChannel(statistic_image,channel,p[center+number_channels*x+
+              i],r);
+            r+=(ptrdiff_t) GetPixelChannels(statistic_image);
           }
-        pixels=p;
-        area=0.0;
-        minimum=pixels[i];
-        maximum=pixels[i];
-        sum=0.0;
-        sum_squared=0.0;
-        ResetPixelList(pixel_list[id]);
-        for (v=0; v < (ssize_t) MagickMax(height,1); v++)
+          continue;
+        }
+      list=pixel_list[id];
+      switch (type)
+      {
+        case MedianStatistic:
+        case ModeStatistic:
+        case NonpeakStatistic:
         {
-          for (u=0; u < (ssize_t) MagickMax(width,1); u++)
+          /*
+            Slide a histogram of the neighborhood along the row: each step
+            removes the leaving column and inserts the entering one.
+          */
+          ResetPixelList(list);
+          for (v=0; v < (ssize_t) neighbor_height; v++)
+            for (u=0; u < (ssize_t) neighbor_width; u++)
+              InsertPixelList(p[number_channels*(v*stride+u)+i],list);
+          for (x=0; x < (ssize_t) statistic_image->columns; x++)
           {
-            if ((type == MedianStatistic) || (type == ModeStatistic) ||
-                (type == NonpeakStatistic))
+            Quantum
+              pixel;
+
+            if (x != 0)
+              for (v=0; v < (ssize_t) neighbor_height; v++)
               {
-                InsertPixelList(pixels[i],pixel_list[id]);
-                pixels+=(ptrdiff_t) GetPixelChannels(image);
-                continue;
+                const Quantum
+                  *magick_restrict pixels;
+
+                pixels=p+number_channels*(v*stride+x)+i;
+                RemovePixelList(pixels[-number_channels],list);
+                InsertPixelList(pixels[number_channels*((ssize_t)
+                  neighbor_width-1)],list);
               }
-            area++;
-            if ((double) pixels[i] < minimum)
-              minimum=(double) pixels[i];
-            if ((double) pixels[i] > maximum)
-              maximum=(double) pixels[i];
-            sum+=(double) pixels[i];
-            sum_squared+=(double) pixels[i]*(double) pixels[i];
-            pixels+=(ptrdiff_t) GetPixelChannels(image);
+            if (GetPixelWriteMask(image,p+number_channels*x) <= (QuantumRange/2))
+              pixel=p[center+number_channels*x+i];
+            else
+              switch (type)
+              {
+                case MedianStatistic:
+                default:
+                {
+                  GetMedianPixelList(list,rank,&pixel);
+                  break;
+                }
+                case ModeStatistic:
+                {
+                  GetModePixelList(list,&pixel);
+                  break;
+                }
+                case NonpeakStatistic:
+                {
+                  GetNonpeakPixelList(list,&pixel);
+                  break;
+                }
+              }
+            SetPixelChannel(statistic_image,channel,pixel,r);
+            r+=(ptrdiff_t) GetPixelChannels(statistic_image);
           }
-          pixels+=(ptrdiff_t) GetPixelChannels(image)*image->columns;
+          for (v=0; v < (ssize_t) neighbor_height; v++)
+            for (u=0; u < (ssize_t) neighbor_width; u++)
+              RemovePixelList(p[number_channels*(v*stride+(ssize_t)
+                statistic_image->columns-1+u)+i],list);
+          break;
         }
-        switch (type)
+        case ContrastStatistic:
+        case GradientStatistic:
+        case MaximumStatistic:
+        case MinimumStatistic:
         {
-          case ContrastStatistic:
-          {
-            pixel=ClampToQuantum(MagickAbsoluteValue((maximum-minimum)*
-              MagickSafeReciprocal(maximum+minimum)));
-            break;
-          }
-          case GradientStatistic:
-          {
-            pixel=ClampToQuantum(MagickAbsoluteValue(maximum-minimum));
-            break;
-          }
-          case MaximumStatistic:
-          {
-            pixel=ClampToQuantum(maximum);
-            break;
-          }
-          case MeanStatistic:
-          default:
-          {
-            pixel=ClampToQuantum(sum/area);
-            break;
-          }
-          case MedianStatistic:
-          {
-            GetMedianPixelList(pixel_list[id],&pixel);
-            break;
-          }
-          case MinimumStatistic:
-          {
-            pixel=ClampToQuantum(minimum);
-            break;
-          }
-          case ModeStatistic:
-          {
-            GetModePixelList(pixel_list[id],&pixel);
-            break;
-          }
-          case NonpeakStatistic:
-          {
-            GetNonpeakPixelList(pixel_list[id],&pixel);
-            break;
-          }
-          case RootMeanSquareStatistic:
+          ssize_t
+            j,
+            maxima_head,
+            maxima_tail,
+            minima_head,
+            minima_tail;
+
+          /*
+            Reduce each column of the neighborhood to its extrema, then slide
+            a monotonic queue of column extrema along the row.
+          */
+          maxima_head=0;
+          maxima_tail=0;
+          minima_head=0;
+          minima_tail=0;
+          for (j=0; j < (stride-1); j++)
           {
-            pixel=ClampToQuantum(sqrt(sum_squared/area));
-            break;
+            const Quantum
+              *magick_restrict pixels;
+
+            double
+              maximum,
+              minimum;
+
+            Quantum
+              pixel;
+
+            pixels=p+number_channels*j+i;
+            maximum=(double) (*pixels);
+            minimum=(double) (*pixels);
+            for (v=1; v < (ssize_t) neighbor_height; v++)
+            {
+              pixels+=(ptrdiff_t) number_channels*stride;
+              if ((double) (*pixels) < minimum)
+                minimum=(double) (*pixels);
+              if ((double) (*pixels) > maximum)
+                maximum=(double) (*pixels);
+            }
+            list->maxima[j]=maximum;
+            list->minima[j]=minimum;
+            while ((maxima_tail > maxima_head) &&
+                   (list->maxima[list->maxima_queue[maxima_tail-1]] <= maximum))
+              maxima_tail--;
+            list->maxima_queue[maxima_tail++]=j;
+            while ((minima_tail > minima_head) &&
+                   (list->minima[list->minima_queue[minima_tail-1]] >= minimum))
+              minima_tail--;
+            list->minima_queue[minima_tail++]=j;
+            x=j-(ssize_t) neighbor_width+1;
+            if (x < 0)
+              continue;
+            while (list->maxima_queue[maxima_head] < x)
+              maxima_head++;
+            while (list->minima_queue[minima_head] < x)
+              minima_head++;
+            maximum=list->maxima[list->maxima_queue[maxima_head]];
+            minimum=list->minima[list->minima_queue[minima_head]];
+            if (GetPixelWriteMask(image,p+number_channels*x) <= (QuantumRange/2))
+              pixel=p[center+number_channels*x+i];
+            else
+              switch (type)
+              {
+                case ContrastStatistic:
+                {
+                  pixel=ClampToQuantum(MagickAbsoluteValue((maximum-minimum)*
+                    MagickSafeReciprocal(maximum+minimum)));
+                  break;
+                }
+                case GradientStatistic:
+                {
+                  pixel=ClampToQuantum(MagickAbsoluteValue(maximum-minimum));
+                  break;
+                }
+                case MaximumStatistic:
+                {
+                  pixel=ClampToQuantum(maximum);
+                  break;
+                }
+                case MinimumStatistic:
+                default:
+                {
+                  pixel=ClampToQuantum(minimum);
+                  break;
+                }
+              }
+            SetPixelChannel(statistic_image,channel,pixel,r);
+            r+=(ptrdiff_t) GetPixelChannels(statistic_image);
           }
-          case StandardDeviationStatistic:
+          break;
+        }
+        default:
+        {
+          for (x=0; x < (ssize_t) statistic_image->columns; x++)
           {
-            pixel=ClampToQuantum(sqrt(sum_squared/area-(sum/area*sum/area)));
-            break;
+            const Quantum
+              *magick_restrict pixels;
+
+            double
+              area,
+              sum,
+              sum_squared;
+
+            Quantum
+              pixel;
+
+            pixels=p+number_channels*x;
+            if (GetPixelWriteMask(image,pixels) <= (QuantumRange/2))
+              {
+                SetPixelChannel(statistic_image,channel,pixels[center+i],r);
+                r+=(ptrdiff_t) GetPixelChannels(statistic_image);
+                continue;
+              }
+            area=0.0;
+            sum=0.0;
+            sum_squared=0.0;
+            for (v=0; v < (ssize_t) neighbor_height; v++)
+            {
+              for (u=0; u < (ssize_t) neighbor_width; u++)
+              {
+                area++;
+                sum+=(double) pixels[i];
+                sum_squared+=(double) pixels[i]*(double) pixels[i];
+                pixels+=(ptrdiff_t) number_channels;
+              }
+              pixels+=(ptrdiff_t) number_channels*(ssize_t) image->columns;
+            }
+            switch (type)
+            {
+              case MeanStatistic:
+              default:
+              {
+                pixel=ClampToQuantum(sum/area);
+                break;
+              }
+              case RootMeanSquareStatistic:
+              {
+                pixel=ClampToQuantum(sqrt(sum_squared/area));
+                break;
+              }
+              case StandardDeviationStatistic:
+              {
+                pixel=ClampToQuantum(sqrt(sum_squared/area-(sum/area*sum/
+                  area)));
+                break;
+              }
+            }
+            SetPixelChannel(statistic_image,channel,pixel,r);
+            r+=(ptrdiff_t) GetPixelChannels(statistic_image);
           }
+          break;
         }
-        SetPixelChannel(statistic_image,channel,pixel,q);
       }
-      p+=(ptrdiff_t) GetPixelChannels(image);
-      q+=(ptrdiff_t) GetPixelChannels(statistic_image);
     }
     if (SyncCacheViewAuthenticPixels(statistic_view,exception) == MagickFalse)
       status=MagickFalse;
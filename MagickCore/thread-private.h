@@ -27,6 +27,22 @@
 extern "C" {
 #endif
 
+typedef MagickBooleanType
+  (*MagickTaskHandler)(const ssize_t,const ssize_t,void *);
+
+extern MagickPrivate int
+  GetMagickTaskId(void);
+
+extern MagickPrivate size_t
+  GetMagickTaskThreads(void);
+
+extern MagickPrivate MagickBooleanType
+  ExecuteMagickTasks(const ssize_t,const ssize_t,const size_t,const int,
+    MagickTaskHandler,void *);
+
+extern MagickPrivate void
+  ThreadComponentTerminus(void);
+
 #define magick_number_threads(source,destination,chunk,factor) \
   num_threads(GetMagickNumberThreads((source),(destination),(chunk),(factor)))
 #if defined(__clang__) || (__GNUC__ > 3) || ((__GNUC__ == 3) && (__GNUC_MINOR__ > 10))
@@ -151,6 +167,19 @@ static inline MagickBooleanType IsMagickThreadEqual(const MagickThreadType id)
 /*
   Lightweight OpenMP methods.
 */
+static inline int GetOpenMPMaxActiveLevels(void)
+{
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+#if defined(MAGICKCORE_WINDOWS_SUPPORT) && !defined(__MINGW32__)
+  return(omp_get_nested());
+#else
+  return(omp_get_max_active_levels() > 1 ? 1 : 0);
+#endif
+#else
+  return(0);
+#endif
+}
+
 static inline size_t GetOpenMPMaximumThreads(void)
 {
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
@@ -169,6 +198,20 @@ static inline int GetOpenMPThreadId(void)
 #endif
 }
 
+static inline int GetMagickTaskThreadId(void)
+{
+  int
+    id;
+
+  /*
+    Inside an ExecuteMagickTasks() handler the task slot is the thread id.
+  */
+  id=GetMagickTaskId();
+  if (id >= 0)
+    return(id);
+  return(GetOpenMPThreadId());
+}
+
 #if defined(MAGICKCORE_OPENMP_SUPPORT)
 static inline void SetOpenMPMaximumThreads(const int threads)
 {
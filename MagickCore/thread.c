@@ -40,9 +40,17 @@
 */
 #include "MagickCore/studio.h"
 #include "MagickCore/memory_.h"
+#include "MagickCore/memory-private.h"
+#include "MagickCore/semaphore.h"
 #include "MagickCore/thread_.h"
 #include "MagickCore/thread-private.h"
 
+/*
+  Define declarations.
+*/
+#define GetTaskRange(task,id) \
+  ((TaskRange *) ((task)->ranges+(size_t) (id)*(task)->extent))
+
 /*
   Typedef declarations.
 */
@@ -55,6 +63,96 @@ typedef struct _MagickThreadValue
     **values,
     (*destructor)(void *);
 } MagickThreadValue;
+
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+typedef struct _TaskRange
+{
+  pthread_mutex_t
+    mutex;
+
+  ssize_t
+    begin,
+    end;
+} TaskRange;
+
+typedef struct _TaskInfo
+{
+  MagickTaskHandler
+    handler;
+
+  void
+    *context;
+
+  size_t
+    grain,
+    extent;
+
+  unsigned char
+    *ranges;
+
+  int
+    number_threads,
+    claimed,
+    active;
+
+  volatile MagickBooleanType
+    status;
+
+  struct _TaskInfo
+    *next;
+} TaskInfo;
+
+typedef struct _TaskPool
+{
+  pthread_mutex_t
+    mutex;
+
+  pthread_cond_t
+    work,
+    idle;
+
+  pthread_t
+    *threads;
+
+  size_t
+    number_threads;
+
+  TaskInfo
+    *tasks;
+
+  MagickBooleanType
+    terminate;
+} TaskPool;
+
+typedef struct _TaskSlot
+{
+  int
+    id,
+    level;
+} TaskSlot;
+#endif
+
+/*
+  Global declarations.
+*/
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+static MagickBooleanType
+  task_instantiate = MagickFalse;
+
+static pthread_key_t
+  task_key;
+
+static TaskPool
+  *task_pool = (TaskPool *) NULL;
+#endif
+
+static SemaphoreInfo
+  *task_semaphore = (SemaphoreInfo *) NULL;
+
+#if !defined(MAGICKCORE_OPENMP_SUPPORT)
+static size_t
+  task_threads = 0;
+#endif
 
 /*
 %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -169,6 +267,397 @@ MagickExport MagickBooleanType DeleteMagickThreadKey(MagickThreadKey key)
 %                                                                             %
 %                                                                             %
 %                                                                             %
++   E x e c u t e M a g i c k T a s k s                                       %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ExecuteMagickTasks() calls handler over the rows [first,last) in ranges of
+%  at most grain rows, on up to number_threads threads of a persistent worker
+%  pool.  The rows are first split evenly between the task slots, as a static
+%  OpenMP schedule would; a slot that runs out of rows steals the back half of
+%  another slot's remaining rows, so content-dependent loops stay balanced.
+%  The calling thread always works on its own task, and idle workers join the
+%  task with the fewest workers, so concurrent callers share the pool fairly.
+%
+%  Within the handler, GetMagickTaskThreadId() returns the task slot, which is
+%  always less than GetMagickTaskThreads(), so cache views index their pixel
+%  cache nexus by task slot.  The handler returns MagickFalse to stop the task
+%  early.  Without thread support the handler is called once, on the calling
+%  thread, for all rows.
+%
+%  The format of the ExecuteMagickTasks method is:
+%
+%      MagickBooleanType ExecuteMagickTasks(const ssize_t first,
+%        const ssize_t last,const size_t grain,const int number_threads,
+%        MagickTaskHandler handler,void *context)
+%
+%  A description of each parameter follows:
+%
+%    o first, last: the rows to process, last is excluded.
+%
+%    o grain: the maximum rows per handler call, 0 picks one.
+%
+%    o number_threads: the maximum number of threads, typically the value
+%      returned by GetMagickNumberThreads().
+%
+%    o handler: the handler, called as handler(begin,end,context).
+%
+%    o context: the handler context.
+%
+*/
+
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+static void RunMagickTask(TaskInfo *task,const int id)
+{
+  TaskRange
+    *range;
+
+  TaskSlot
+    *previous,
+    slot;
+
+  previous=(TaskSlot *) pthread_getspecific(task_key);
+  slot.id=id;
+  slot.level=0;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  slot.level=omp_get_level();
+#endif
+  (void) pthread_setspecific(task_key,&slot);
+  range=GetTaskRange(task,id);
+  while (task->status != MagickFalse)
+  {
+    ssize_t
+      begin,
+      end;
+
+    (void) pthread_mutex_lock(&range->mutex);
+    begin=range->begin;
+    end=MagickMin(begin+(ssize_t) task->grain,range->end);
+    range->begin=end;
+    (void) pthread_mutex_unlock(&range->mutex);
+    if (begin >= end)
+      {
+        int
+          i;
+
+        /*
+          Our rows are done, steal the back half of another slot's rows.
+        */
+        for (i=1; i < task->number_threads; i++)
+        {
+          TaskRange
+            *victim;
+
+          victim=GetTaskRange(task,(id+i) % task->number_threads);
+          (void) pthread_mutex_lock(&victim->mutex);
+          begin=victim->begin+(victim->end-victim->begin)/2;
+          end=victim->end;
+          victim->end=begin;
+          (void) pthread_mutex_unlock(&victim->mutex);
+          if (begin < end)
+            break;
+        }
+        if (begin >= end)
+          break;
+        (void) pthread_mutex_lock(&range->mutex);
+        range->begin=begin;
+        range->end=end;
+        (void) pthread_mutex_unlock(&range->mutex);
+        continue;
+      }
+    if (task->handler(begin,end,task->context) == MagickFalse)
+      task->status=MagickFalse;
+  }
+  (void) pthread_setspecific(task_key,previous);
+}
+
+static void *MagickTaskWorker(void *context)
+{
+  TaskPool
+    *pool;
+
+  pool=(TaskPool *) context;
+  (void) pthread_mutex_lock(&pool->mutex);
+  while (pool->terminate == MagickFalse)
+  {
+    int
+      id;
+
+    TaskInfo
+      *p,
+      *task;
+
+    /*
+      Join the task with the fewest workers.
+    */
+    task=(TaskInfo *) NULL;
+    for (p=pool->tasks; p != (TaskInfo *) NULL; p=p->next)
+      if ((p->claimed < p->number_threads) &&
+          ((task == (TaskInfo *) NULL) || (p->claimed < task->claimed)))
+        task=p;
+    if (task == (TaskInfo *) NULL)
+      {
+        (void) pthread_cond_wait(&pool->work,&pool->mutex);
+        continue;
+      }
+    id=task->claimed++;
+    task->active++;
+    (void) pthread_mutex_unlock(&pool->mutex);
+    RunMagickTask(task,id);
+    (void) pthread_mutex_lock(&pool->mutex);
+    if (--task->active == 0)
+      (void) pthread_cond_broadcast(&pool->idle);
+  }
+  (void) pthread_mutex_unlock(&pool->mutex);
+  return((void *) NULL);
+}
+
+static void ResetMagickTaskPool(void)
+{
+  /*
+    The workers do not survive fork(); the child starts a new pool.
+  */
+  task_instantiate=MagickFalse;
+  task_pool=(TaskPool *) NULL;
+  task_semaphore=(SemaphoreInfo *) NULL;
+}
+
+static TaskPool *AcquireMagickTaskPool(void)
+{
+  size_t
+    i,
+    number_threads;
+
+  TaskPool
+    *pool;
+
+  if (task_instantiate != MagickFalse)
+    return(task_pool);
+  if (task_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&task_semaphore);
+  LockSemaphoreInfo(task_semaphore);
+  if (task_instantiate != MagickFalse)
+    {
+      UnlockSemaphoreInfo(task_semaphore);
+      return(task_pool);
+    }
+  if (pthread_key_create(&task_key,(void (*)(void *)) NULL) != 0)
+    {
+      UnlockSemaphoreInfo(task_semaphore);
+      return((TaskPool *) NULL);
+    }
+  pool=(TaskPool *) AcquireCriticalMemory(sizeof(*pool));
+  (void) memset(pool,0,sizeof(*pool));
+  (void) pthread_mutex_init(&pool->mutex,(const pthread_mutexattr_t *) NULL);
+  (void) pthread_cond_init(&pool->work,(const pthread_condattr_t *) NULL);
+  (void) pthread_cond_init(&pool->idle,(const pthread_condattr_t *) NULL);
+  number_threads=GetMagickTaskThreads();
+  if (number_threads > 1)
+    pool->threads=(pthread_t *) AcquireQuantumMemory(number_threads-1,
+      sizeof(*pool->threads));
+  if (pool->threads != (pthread_t *) NULL)
+    for (i=0; i < (number_threads-1); i++)
+    {
+      if (pthread_create(&pool->threads[i],(const pthread_attr_t *) NULL,
+            MagickTaskWorker,pool) != 0)
+        break;
+      pool->number_threads++;
+    }
+  (void) pthread_atfork((void (*)(void)) NULL,(void (*)(void)) NULL,
+    ResetMagickTaskPool);
+  task_pool=pool;
+  task_instantiate=MagickTrue;
+  UnlockSemaphoreInfo(task_semaphore);
+  return(task_pool);
+}
+#endif
+
+MagickPrivate MagickBooleanType ExecuteMagickTasks(const ssize_t first,
+  const ssize_t last,const size_t grain,const int number_threads,
+  MagickTaskHandler handler,void *context)
+{
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  int
+    i;
+
+  TaskInfo
+    task;
+
+  TaskPool
+    *pool;
+
+  if (first >= last)
+    return(MagickTrue);
+  pool=AcquireMagickTaskPool();
+  if (pool == (TaskPool *) NULL)
+    return(handler(first,last,context));
+  (void) memset(&task,0,sizeof(task));
+  task.handler=handler;
+  task.context=context;
+  task.number_threads=(int) MagickMin((size_t) MagickMax(number_threads,1),
+    MagickMin(pool->number_threads+1,(size_t) (last-first)));
+  task.grain=grain;
+  if (task.grain == 0)
+    task.grain=(size_t) MagickMax((last-first)/(8*task.number_threads),1);
+  task.extent=CACHE_ALIGNED(sizeof(TaskRange));
+  task.ranges=(unsigned char *) AcquireAlignedMemory((size_t)
+    task.number_threads,task.extent);
+  if (task.ranges == (unsigned char *) NULL)
+    return(handler(first,last,context));
+  for (i=0; i < task.number_threads; i++)
+  {
+    TaskRange
+      *range;
+
+    range=GetTaskRange(&task,i);
+    (void) pthread_mutex_init(&range->mutex,(const pthread_mutexattr_t *)
+      NULL);
+    range->begin=first+(ssize_t) ((MagickOffsetType) (last-first)*i/
+      task.number_threads);
+    range->end=first+(ssize_t) ((MagickOffsetType) (last-first)*(i+1)/
+      task.number_threads);
+  }
+  task.claimed=1;
+  task.active=1;
+  task.status=MagickTrue;
+  if (task.number_threads > 1)
+    {
+      (void) pthread_mutex_lock(&pool->mutex);
+      task.next=pool->tasks;
+      pool->tasks=(&task);
+      (void) pthread_cond_broadcast(&pool->work);
+      (void) pthread_mutex_unlock(&pool->mutex);
+    }
+  RunMagickTask(&task,0);
+  if (task.number_threads > 1)
+    {
+      TaskInfo
+        **p;
+
+      /*
+        No more workers may join; wait for those that did.
+      */
+      (void) pthread_mutex_lock(&pool->mutex);
+      for (p=(&pool->tasks); *p != (TaskInfo *) NULL; p=(&(*p)->next))
+        if (*p == &task)
+          {
+            *p=task.next;
+            break;
+          }
+      task.active--;
+      while (task.active != 0)
+        (void) pthread_cond_wait(&pool->idle,&pool->mutex);
+      (void) pthread_mutex_unlock(&pool->mutex);
+    }
+  for (i=0; i < task.number_threads; i++)
+    (void) pthread_mutex_destroy(&GetTaskRange(&task,i)->mutex);
+  task.ranges=(unsigned char *) RelinquishAlignedMemory(task.ranges);
+  return(task.status);
+#else
+  magick_unreferenced(grain);
+  magick_unreferenced(number_threads);
+  if (first >= last)
+    return(MagickTrue);
+  return(handler(first,last,context));
+#endif
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t M a g i c k T a s k I d                                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMagickTaskId() returns the task slot of the calling thread while it runs
+%  an ExecuteMagickTasks() handler, otherwise -1.  An OpenMP team started from
+%  within the handler keeps its own OpenMP thread numbers.
+%
+%  The format of the GetMagickTaskId method is:
+%
+%      int GetMagickTaskId(void)
+%
+*/
+MagickPrivate int GetMagickTaskId(void)
+{
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  const TaskSlot
+    *slot;
+
+  if (task_instantiate == MagickFalse)
+    return(-1);
+  slot=(const TaskSlot *) pthread_getspecific(task_key);
+  if (slot == (const TaskSlot *) NULL)
+    return(-1);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  if (omp_get_level() != slot->level)
+    return(-1);
+#endif
+  return(slot->id);
+#else
+  return(-1);
+#endif
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   G e t M a g i c k T a s k T h r e a d s                                   %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  GetMagickTaskThreads() returns the maximum number of threads available to
+%  ExecuteMagickTasks(): the OpenMP maximum when built with OpenMP, otherwise
+%  the number of online processors.
+%
+%  The format of the GetMagickTaskThreads method is:
+%
+%      size_t GetMagickTaskThreads(void)
+%
+*/
+MagickPrivate size_t GetMagickTaskThreads(void)
+{
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  return((size_t) omp_get_max_threads());
+#else
+  if (task_threads == 0)
+    {
+      size_t
+        number_threads;
+
+      number_threads=1;
+#if defined(MAGICKCORE_THREAD_SUPPORT) && defined(MAGICKCORE_HAVE_SYSCONF) && \
+    defined(_SC_NPROCESSORS_ONLN)
+      {
+        long
+          processors;
+
+        processors=sysconf(_SC_NPROCESSORS_ONLN);
+        if (processors > 0)
+          number_threads=(size_t) processors;
+      }
+#endif
+      task_threads=number_threads;
+    }
+  return(task_threads);
+#endif
+}
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
 %   G e t M a g i c k T h r e a d V a l u e                                   %
 %                                                                             %
 %                                                                             %
@@ -248,3 +737,58 @@ MagickExport MagickBooleanType SetMagickThreadValue(MagickThreadKey key,
   return(MagickTrue);
 #endif
 }
+
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
++   T h r e a d C o m p o n e n t T e r m i n u s                             %
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%  ThreadComponentTerminus() stops the task worker pool.
+%
+%  The format of the ThreadComponentTerminus method is:
+%
+%      void ThreadComponentTerminus(void)
+%
+*/
+MagickPrivate void ThreadComponentTerminus(void)
+{
+#if defined(MAGICKCORE_THREAD_SUPPORT)
+  TaskPool
+    *pool;
+
+  size_t
+    i;
+
+  if (task_semaphore == (SemaphoreInfo *) NULL)
+    ActivateSemaphoreInfo(&task_semaphore);
+  LockSemaphoreInfo(task_semaphore);
+  pool=task_pool;
+  if (pool != (TaskPool *) NULL)
+    {
+      (void) pthread_mutex_lock(&pool->mutex);
+      pool->terminate=MagickTrue;
+      (void) pthread_cond_broadcast(&pool->work);
+      (void) pthread_mutex_unlock(&pool->mutex);
+      for (i=0; i < pool->number_threads; i++)
+        (void) pthread_join(pool->threads[i],(void **) NULL);
+      (void) pthread_cond_destroy(&pool->idle);
+      (void) pthread_cond_destroy(&pool->work);
+      (void) pthread_mutex_destroy(&pool->mutex);
+      if (pool->threads != (pthread_t *) NULL)
+        pool->threads=(pthread_t *) RelinquishMagickMemory(pool->threads);
+      pool=(TaskPool *) RelinquishMagickMemory(pool);
+      task_pool=(TaskPool *) NULL;
+    }
+  if (task_instantiate != MagickFalse)
+    (void) pthread_key_delete(task_key);
+  task_instantiate=MagickFalse;
+  UnlockSemaphoreInfo(task_semaphore);
+  RelinquishSemaphoreInfo(&task_semaphore);
+#endif
+}
@@ -116,6 +116,28 @@
 %
 */
 
+typedef MagickBooleanType
+  (*CCMetricMethod)(const Image *,CCObjectInfo *,const ssize_t,const ssize_t,
+    ExceptionInfo *);
+
+typedef struct _CCMetricInfo
+{
+  CCMetricMethod
+    method;
+
+  const Image
+    *component_image;
+
+  CCObjectInfo
+    *object;
+
+  ssize_t
+    metric_index;
+
+  ExceptionInfo
+    *exception;
+} CCMetricInfo;
+
 static int CCObjectInfoCompare(const void *x,const void *y)
 {
   CCObjectInfo
@@ -147,640 +169,664 @@ static int CCObjectInfoCompare(const void *x,const void *y)
   return((int) (q->area-(ssize_t) p->area));
 }
 
-static void PerimeterThreshold(const Image *component_image,
-  CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
+static MagickBooleanType CCMetricTask(const ssize_t begin,const ssize_t end,
+  void *context)
 {
+  CCMetricInfo
+    *metric_info;
+
   MagickBooleanType
     status;
 
   ssize_t
     i;
 
+  metric_info=(CCMetricInfo *) context;
   status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(dynamic) shared(status) \
-    magick_number_threads(component_image,component_image,component_image->colors,1)
-#endif
-  for (i=0; i < (ssize_t) component_image->colors; i++)
-  {
-    CacheView
-      *component_view;
+  for (i=begin; (i < end) && (status != MagickFalse); i++)
+    status=metric_info->method(metric_info->component_image,
+      metric_info->object,i,metric_info->metric_index,metric_info->exception);
+  return(status);
+}
 
-    RectangleInfo
-      bounding_box;
+static void ExecuteCCMetricTasks(const Image *component_image,
+  CCObjectInfo *object,const ssize_t metric_index,CCMetricMethod method,
+  ExceptionInfo *exception)
+{
+  CCMetricInfo
+    metric_info;
 
-    size_t
-      pattern[4] = { 1, 0, 0, 0 };
+  /*
+    Object sizes vary widely; rather than the dynamic schedule handing out
+    one object at a time, each thread starts on its own share and steals from
+    busy threads once done.
+  */
+  metric_info.method=method;
+  metric_info.component_image=component_image;
+  metric_info.object=object;
+  metric_info.metric_index=metric_index;
+  metric_info.exception=exception;
+  (void) ExecuteMagickTasks(0,(ssize_t) component_image->colors,1,
+    GetMagickNumberThreads(component_image,component_image,
+    component_image->colors,1),CCMetricTask,&metric_info);
+}
+
+static MagickBooleanType PerimeterMetric(const Image *component_image,
+  CCObjectInfo *object,const ssize_t i,const ssize_t metric_index,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *component_view;
+
+  MagickBooleanType
+    status;
+
+  RectangleInfo
+    bounding_box;
+
+  size_t
+    pattern[4] = { 1, 0, 0, 0 };
+
+  ssize_t
+    y;
+
+  /*
+    Compute perimeter of the object.
+  */
+  status=MagickTrue;
+  component_view=AcquireAuthenticCacheView(component_image,exception);
+  bounding_box=object[i].bounding_box;
+  for (y=(-1); y < (ssize_t) bounding_box.height; y++)
+  {
+    const Quantum
+      *magick_restrict p;
 
     ssize_t
-      y;
+      x;
 
-    /*
-      Compute perimeter of each object.
-    */
-    if (status == MagickFalse)
-      continue;
-    component_view=AcquireAuthenticCacheView(component_image,exception);
-    bounding_box=object[i].bounding_box;
-    for (y=(-1); y < (ssize_t) bounding_box.height; y++)
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x-1,
+      bounding_box.y+y,bounding_box.width+2,2,exception);
+    if (p == (const Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=(-1); x < (ssize_t) bounding_box.width; x++)
     {
-      const Quantum
-        *magick_restrict p;
+      Quantum
+        pixels[4];
+
+      size_t
+        foreground;
 
       ssize_t
-        x;
+        v;
 
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x-1,
-        bounding_box.y+y,bounding_box.width+2,2,exception);
-      if (p == (const Quantum *) NULL)
-        {
-          status=MagickFalse;
-          break;
-        }
-      for (x=(-1); x < (ssize_t) bounding_box.width; x++)
+      /*
+        An Algorithm for Calculating Objects’ Shape Features in Binary
+        Images, Lifeng He, Yuyan Chao.
+      */
+      foreground=0;
+      for (v=0; v < 2; v++)
       {
-        Quantum
-          pixels[4];
-
-        size_t
-          foreground;
-
         ssize_t
-          v;
+          u;
 
-        /*
-          An Algorithm for Calculating Objects’ Shape Features in Binary
-          Images, Lifeng He, Yuyan Chao.
-        */
-        foreground=0;
-        for (v=0; v < 2; v++)
+        for (u=0; u < 2; u++)
         {
           ssize_t
-            u;
-
-          for (u=0; u < 2; u++)
+            offset;
+
+          offset=v*((ssize_t) bounding_box.width+2)*
+            (ssize_t) GetPixelChannels(component_image)+u*
+            (ssize_t) GetPixelChannels(component_image);
+          pixels[2*v+u]=GetPixelIndex(component_image,p+offset);
+          if ((ssize_t) pixels[2*v+u] == i)
+            foreground++;
+        }
+      }
+      if (foreground == 1)
+        pattern[1]++;
+      else
+        if (foreground == 2)
           {
-            ssize_t
-              offset;
-
-            offset=v*((ssize_t) bounding_box.width+2)*
-              (ssize_t) GetPixelChannels(component_image)+u*
-              (ssize_t) GetPixelChannels(component_image);
-            pixels[2*v+u]=GetPixelIndex(component_image,p+offset);
-            if ((ssize_t) pixels[2*v+u] == i)
-              foreground++;
+            if ((((ssize_t) pixels[0] == i) && ((ssize_t) pixels[3] == i)) ||
+                (((ssize_t) pixels[1] == i) && ((ssize_t) pixels[2] == i)))
+              pattern[0]++;  /* diagonal */
+            else
+              pattern[2]++;
           }
-        }
-        if (foreground == 1)
-          pattern[1]++;
         else
-          if (foreground == 2)
-            {
-              if ((((ssize_t) pixels[0] == i) && ((ssize_t) pixels[3] == i)) ||
-                  (((ssize_t) pixels[1] == i) && ((ssize_t) pixels[2] == i)))
-                pattern[0]++;  /* diagonal */
-              else
-                pattern[2]++;
-            }
-          else
-            if (foreground == 3)
-              pattern[3]++;
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
-      }
+          if (foreground == 3)
+            pattern[3]++;
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
     }
-    component_view=DestroyCacheView(component_view);
-    object[i].metric[metric_index]=ceil(MagickSQ1_2*pattern[1]+1.0*pattern[2]+
-      MagickSQ1_2*pattern[3]+MagickSQ2*pattern[0]-0.5);
   }
+  component_view=DestroyCacheView(component_view);
+  object[i].metric[metric_index]=ceil(MagickSQ1_2*pattern[1]+1.0*pattern[2]+
+    MagickSQ1_2*pattern[3]+MagickSQ2*pattern[0]-0.5);
+  return(status);
 }
 
-static void CircularityThreshold(const Image *component_image,
+static void PerimeterThreshold(const Image *component_image,
   CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
 {
+  ExecuteCCMetricTasks(component_image,object,metric_index,
+    PerimeterMetric,exception);
+}
+
+static MagickBooleanType CircularityMetric(const Image *component_image,
+  CCObjectInfo *object,const ssize_t i,const ssize_t metric_index,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *component_view;
+
   MagickBooleanType
     status;
 
+  RectangleInfo
+    bounding_box;
+
+  size_t
+    pattern[4] = { 1, 0, 0, 0 };
+
   ssize_t
-    i;
+    y;
 
+  /*
+    Compute perimeter of the object.
+  */
   status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(dynamic) shared(status) \
-    magick_number_threads(component_image,component_image,component_image->colors,1)
-#endif
-  for (i=0; i < (ssize_t) component_image->colors; i++)
+  component_view=AcquireAuthenticCacheView(component_image,exception);
+  bounding_box=object[i].bounding_box;
+  for (y=(-1); y < (ssize_t) bounding_box.height; y++)
   {
-    CacheView
-      *component_view;
-
-    RectangleInfo
-      bounding_box;
-
-    size_t
-      pattern[4] = { 1, 0, 0, 0 };
+    const Quantum
+      *magick_restrict p;
 
     ssize_t
-      y;
+      x;
 
-    /*
-      Compute perimeter of each object.
-    */
-    if (status == MagickFalse)
-      continue;
-    component_view=AcquireAuthenticCacheView(component_image,exception);
-    bounding_box=object[i].bounding_box;
-    for (y=(-1); y < (ssize_t) bounding_box.height; y++)
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x-1,
+      bounding_box.y+y,bounding_box.width+2,2,exception);
+    if (p == (const Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=(-1); x < (ssize_t) bounding_box.width; x++)
     {
-      const Quantum
-        *magick_restrict p;
+      Quantum
+        pixels[4];
 
       ssize_t
-        x;
+        v;
 
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x-1,
-        bounding_box.y+y,bounding_box.width+2,2,exception);
-      if (p == (const Quantum *) NULL)
-        {
-          status=MagickFalse;
-          break;
-        }
-      for (x=(-1); x < (ssize_t) bounding_box.width; x++)
-      {
-        Quantum
-          pixels[4];
+      size_t
+        foreground;
 
+      /*
+        An Algorithm for Calculating Objects’ Shape Features in Binary
+        Images, Lifeng He, Yuyan Chao.
+      */
+      foreground=0;
+      for (v=0; v < 2; v++)
+      {
         ssize_t
-          v;
+          u;
 
-        size_t
-          foreground;
-
-        /*
-          An Algorithm for Calculating Objects’ Shape Features in Binary
-          Images, Lifeng He, Yuyan Chao.
-        */
-        foreground=0;
-        for (v=0; v < 2; v++)
+        for (u=0; u < 2; u++)
         {
           ssize_t
-            u;
-
-          for (u=0; u < 2; u++)
+            offset;
+
+          offset=v*((ssize_t) bounding_box.width+2)*
+            (ssize_t) GetPixelChannels(component_image)+u*
+            (ssize_t) GetPixelChannels(component_image);
+          pixels[2*v+u]=GetPixelIndex(component_image,p+offset);
+          if ((ssize_t) pixels[2*v+u] == i)
+            foreground++;
+        }
+      }
+      if (foreground == 1)
+        pattern[1]++;
+      else
+        if (foreground == 2)
           {
-            ssize_t
-              offset;
-
-            offset=v*((ssize_t) bounding_box.width+2)*
-              (ssize_t) GetPixelChannels(component_image)+u*
-              (ssize_t) GetPixelChannels(component_image);
-            pixels[2*v+u]=GetPixelIndex(component_image,p+offset);
-            if ((ssize_t) pixels[2*v+u] == i)
-              foreground++;
+            if ((((ssize_t) pixels[0] == i) && ((ssize_t) pixels[3] == i)) ||
+                (((ssize_t) pixels[1] == i) && ((ssize_t) pixels[2] == i)))
+              pattern[0]++;  /* diagonal */
+            else
+              pattern[2]++;
           }
-        }
-        if (foreground == 1)
-          pattern[1]++;
         else
-          if (foreground == 2)
-            {
-              if ((((ssize_t) pixels[0] == i) && ((ssize_t) pixels[3] == i)) ||
-                  (((ssize_t) pixels[1] == i) && ((ssize_t) pixels[2] == i)))
-                pattern[0]++;  /* diagonal */
-              else
-                pattern[2]++;
-            }
-          else
-            if (foreground == 3)
-              pattern[3]++;
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
-      }
+          if (foreground == 3)
+            pattern[3]++;
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
     }
-    component_view=DestroyCacheView(component_view);
-    object[i].metric[metric_index]=ceil(MagickSQ1_2*pattern[1]+1.0*pattern[2]+
-      MagickSQ1_2*pattern[3]+MagickSQ2*pattern[0]-0.5);
-    object[i].metric[metric_index]=4.0*MagickPI*object[i].area/
-      (object[i].metric[metric_index]*object[i].metric[metric_index]);
   }
+  component_view=DestroyCacheView(component_view);
+  object[i].metric[metric_index]=ceil(MagickSQ1_2*pattern[1]+1.0*pattern[2]+
+    MagickSQ1_2*pattern[3]+MagickSQ2*pattern[0]-0.5);
+  object[i].metric[metric_index]=4.0*MagickPI*object[i].area/
+    (object[i].metric[metric_index]*object[i].metric[metric_index]);
+  return(status);
 }
 
-static void MajorAxisThreshold(const Image *component_image,
+static void CircularityThreshold(const Image *component_image,
   CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
 {
-  MagickBooleanType
-    status;
+  ExecuteCCMetricTasks(component_image,object,metric_index,
+    CircularityMetric,exception);
+}
 
-  ssize_t
-    i;
+static MagickBooleanType MajorAxisMetric(const Image *component_image,
+  CCObjectInfo *object,const ssize_t i,const ssize_t metric_index,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *component_view;
 
-  status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(dynamic) shared(status) \
-    magick_number_threads(component_image,component_image,component_image->colors,1)
-#endif
-  for (i=0; i < (ssize_t) component_image->colors; i++)
-  {
-    CacheView
-      *component_view;
+  MagickBooleanType
+    status;
 
-    double
-      M00 = 0.0,
-      M01 = 0.0,
-      M02 = 0.0,
-      M10 = 0.0,
-      M11 = 0.0,
-      M20 = 0.0;
+  double
+    M00 = 0.0,
+    M01 = 0.0,
+    M02 = 0.0,
+    M10 = 0.0,
+    M11 = 0.0,
+    M20 = 0.0;
 
-    PointInfo
-      centroid = { 0.0, 0.0 };
+  PointInfo
+    centroid = { 0.0, 0.0 };
 
-    RectangleInfo
-      bounding_box;
+  RectangleInfo
+    bounding_box;
 
-    const Quantum
-      *magick_restrict p;
+  const Quantum
+    *magick_restrict p;
 
-    ssize_t
-      x;
+  ssize_t
+    x;
 
-    ssize_t
-      y;
+  ssize_t
+    y;
 
-    /*
-      Compute ellipse major axis of each object.
-    */
-    if (status == MagickFalse)
-      continue;
-    component_view=AcquireAuthenticCacheView(component_image,exception);
-    bounding_box=object[i].bounding_box;
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+  /*
+    Compute ellipse major axis of the object.
+  */
+  status=MagickTrue;
+  component_view=AcquireAuthenticCacheView(component_image,exception);
+  bounding_box=object[i].bounding_box;
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M00++;
+          M10+=x;
+          M01+=y;
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
+    }
+  }
+  centroid.x=M10*MagickSafeReciprocal(M00);
+  centroid.y=M01*MagickSafeReciprocal(M00);
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    if (status == MagickFalse)
+      continue;
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
       {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M00++;
-            M10+=x;
-            M01+=y;
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
+        status=MagickFalse;
+        break;
       }
-    }
-    centroid.x=M10*MagickSafeReciprocal(M00);
-    centroid.y=M01*MagickSafeReciprocal(M00);
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      if (status == MagickFalse)
-        continue;
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M11+=(x-centroid.x)*(y-centroid.y);
+          M20+=(x-centroid.x)*(x-centroid.x);
+          M02+=(y-centroid.y)*(y-centroid.y);
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
-      {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M11+=(x-centroid.x)*(y-centroid.y);
-            M20+=(x-centroid.x)*(x-centroid.x);
-            M02+=(y-centroid.y)*(y-centroid.y);
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
-      }
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
     }
-    component_view=DestroyCacheView(component_view);
-    object[i].metric[metric_index]=sqrt((2.0*MagickSafeReciprocal(M00))*
-      ((M20+M02)+sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
   }
+  component_view=DestroyCacheView(component_view);
+  object[i].metric[metric_index]=sqrt((2.0*MagickSafeReciprocal(M00))*
+    ((M20+M02)+sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
+  return(status);
 }
 
-static void MinorAxisThreshold(const Image *component_image,
+static void MajorAxisThreshold(const Image *component_image,
   CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
 {
-  MagickBooleanType
-    status;
+  ExecuteCCMetricTasks(component_image,object,metric_index,
+    MajorAxisMetric,exception);
+}
 
-  ssize_t
-    i;
+static MagickBooleanType MinorAxisMetric(const Image *component_image,
+  CCObjectInfo *object,const ssize_t i,const ssize_t metric_index,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *component_view;
 
-  status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(dynamic) shared(status) \
-    magick_number_threads(component_image,component_image,component_image->colors,1)
-#endif
-  for (i=0; i < (ssize_t) component_image->colors; i++)
-  {
-    CacheView
-      *component_view;
+  MagickBooleanType
+    status;
 
-    double
-      M00 = 0.0,
-      M01 = 0.0,
-      M02 = 0.0,
-      M10 = 0.0,
-      M11 = 0.0,
-      M20 = 0.0;
+  double
+    M00 = 0.0,
+    M01 = 0.0,
+    M02 = 0.0,
+    M10 = 0.0,
+    M11 = 0.0,
+    M20 = 0.0;
 
-    PointInfo
-      centroid = { 0.0, 0.0 };
+  PointInfo
+    centroid = { 0.0, 0.0 };
 
-    RectangleInfo
-      bounding_box;
+  RectangleInfo
+    bounding_box;
 
-    const Quantum
-      *magick_restrict p;
+  const Quantum
+    *magick_restrict p;
 
-    ssize_t
-      x;
+  ssize_t
+    x;
 
-    ssize_t
-      y;
+  ssize_t
+    y;
 
-    /*
-      Compute ellipse major axis of each object.
-    */
-    if (status == MagickFalse)
-      continue;
-    component_view=AcquireAuthenticCacheView(component_image,exception);
-    bounding_box=object[i].bounding_box;
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+  /*
+    Compute ellipse major axis of the object.
+  */
+  status=MagickTrue;
+  component_view=AcquireAuthenticCacheView(component_image,exception);
+  bounding_box=object[i].bounding_box;
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M00++;
+          M10+=x;
+          M01+=y;
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
+    }
+  }
+  centroid.x=M10*MagickSafeReciprocal(M00);
+  centroid.y=M01*MagickSafeReciprocal(M00);
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    if (status == MagickFalse)
+      continue;
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
       {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M00++;
-            M10+=x;
-            M01+=y;
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
+        status=MagickFalse;
+        break;
       }
-    }
-    centroid.x=M10*MagickSafeReciprocal(M00);
-    centroid.y=M01*MagickSafeReciprocal(M00);
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      if (status == MagickFalse)
-        continue;
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M11+=(x-centroid.x)*(y-centroid.y);
+          M20+=(x-centroid.x)*(x-centroid.x);
+          M02+=(y-centroid.y)*(y-centroid.y);
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
-      {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M11+=(x-centroid.x)*(y-centroid.y);
-            M20+=(x-centroid.x)*(x-centroid.x);
-            M02+=(y-centroid.y)*(y-centroid.y);
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
-      }
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
     }
-    component_view=DestroyCacheView(component_view);
-    object[i].metric[metric_index]=sqrt((2.0*MagickSafeReciprocal(M00))*
-      ((M20+M02)-sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
   }
+  component_view=DestroyCacheView(component_view);
+  object[i].metric[metric_index]=sqrt((2.0*MagickSafeReciprocal(M00))*
+    ((M20+M02)-sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
+  return(status);
 }
 
-static void EccentricityThreshold(const Image *component_image,
+static void MinorAxisThreshold(const Image *component_image,
   CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
 {
-  MagickBooleanType
-    status;
+  ExecuteCCMetricTasks(component_image,object,metric_index,
+    MinorAxisMetric,exception);
+}
 
-  ssize_t
-    i;
+static MagickBooleanType EccentricityMetric(const Image *component_image,
+  CCObjectInfo *object,const ssize_t i,const ssize_t metric_index,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *component_view;
 
-  status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(dynamic) shared(status) \
-    magick_number_threads(component_image,component_image,component_image->colors,1)
-#endif
-  for (i=0; i < (ssize_t) component_image->colors; i++)
-  {
-    CacheView
-      *component_view;
+  MagickBooleanType
+    status;
 
-    double
-      M00 = 0.0,
-      M01 = 0.0,
-      M02 = 0.0,
-      M10 = 0.0,
-      M11 = 0.0,
-      M20 = 0.0;
+  double
+    M00 = 0.0,
+    M01 = 0.0,
+    M02 = 0.0,
+    M10 = 0.0,
+    M11 = 0.0,
+    M20 = 0.0;
 
-    PointInfo
-      centroid = { 0.0, 0.0 },
-      ellipse_axis = { 0.0, 0.0 };
+  PointInfo
+    centroid = { 0.0, 0.0 },
+    ellipse_axis = { 0.0, 0.0 };
 
-    RectangleInfo
-      bounding_box;
+  RectangleInfo
+    bounding_box;
 
-    const Quantum
-      *magick_restrict p;
+  const Quantum
+    *magick_restrict p;
 
-    ssize_t
-      x;
+  ssize_t
+    x;
 
-    ssize_t
-      y;
+  ssize_t
+    y;
 
-    /*
-      Compute eccentricity of each object.
-    */
-    if (status == MagickFalse)
-      continue;
-    component_view=AcquireAuthenticCacheView(component_image,exception);
-    bounding_box=object[i].bounding_box;
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+  /*
+    Compute eccentricity of the object.
+  */
+  status=MagickTrue;
+  component_view=AcquireAuthenticCacheView(component_image,exception);
+  bounding_box=object[i].bounding_box;
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M00++;
+          M10+=x;
+          M01+=y;
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
+    }
+  }
+  centroid.x=M10*MagickSafeReciprocal(M00);
+  centroid.y=M01*MagickSafeReciprocal(M00);
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    if (status == MagickFalse)
+      continue;
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
       {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M00++;
-            M10+=x;
-            M01+=y;
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
+        status=MagickFalse;
+        break;
       }
-    }
-    centroid.x=M10*MagickSafeReciprocal(M00);
-    centroid.y=M01*MagickSafeReciprocal(M00);
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      if (status == MagickFalse)
-        continue;
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M11+=(x-centroid.x)*(y-centroid.y);
+          M20+=(x-centroid.x)*(x-centroid.x);
+          M02+=(y-centroid.y)*(y-centroid.y);
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
-      {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M11+=(x-centroid.x)*(y-centroid.y);
-            M20+=(x-centroid.x)*(x-centroid.x);
-            M02+=(y-centroid.y)*(y-centroid.y);
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
-      }
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
     }
-    component_view=DestroyCacheView(component_view);
-    ellipse_axis.x=sqrt((2.0*MagickSafeReciprocal(M00))*((M20+M02)+
-      sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
-    ellipse_axis.y=sqrt((2.0*MagickSafeReciprocal(M00))*((M20+M02)-
-      sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
-    object[i].metric[metric_index]=sqrt(1.0-(ellipse_axis.y*ellipse_axis.y*
-      MagickSafeReciprocal(ellipse_axis.x*ellipse_axis.x)));
   }
+  component_view=DestroyCacheView(component_view);
+  ellipse_axis.x=sqrt((2.0*MagickSafeReciprocal(M00))*((M20+M02)+
+    sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
+  ellipse_axis.y=sqrt((2.0*MagickSafeReciprocal(M00))*((M20+M02)-
+    sqrt(4.0*M11*M11+(M20-M02)*(M20-M02))));
+  object[i].metric[metric_index]=sqrt(1.0-(ellipse_axis.y*ellipse_axis.y*
+    MagickSafeReciprocal(ellipse_axis.x*ellipse_axis.x)));
+  return(status);
 }
 
-static void AngleThreshold(const Image *component_image,
+static void EccentricityThreshold(const Image *component_image,
   CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
 {
-  MagickBooleanType
-    status;
+  ExecuteCCMetricTasks(component_image,object,metric_index,
+    EccentricityMetric,exception);
+}
 
-  ssize_t
-    i;
+static MagickBooleanType AngleMetric(const Image *component_image,
+  CCObjectInfo *object,const ssize_t i,const ssize_t metric_index,
+  ExceptionInfo *exception)
+{
+  CacheView
+    *component_view;
 
-  status=MagickTrue;
-#if defined(MAGICKCORE_OPENMP_SUPPORT)
-  #pragma omp parallel for schedule(dynamic) shared(status) \
-    magick_number_threads(component_image,component_image,component_image->colors,1)
-#endif
-  for (i=0; i < (ssize_t) component_image->colors; i++)
-  {
-    CacheView
-      *component_view;
+  MagickBooleanType
+    status;
 
-    double
-      M00 = 0.0,
-      M01 = 0.0,
-      M02 = 0.0,
-      M10 = 0.0,
-      M11 = 0.0,
-      M20 = 0.0;
+  double
+    M00 = 0.0,
+    M01 = 0.0,
+    M02 = 0.0,
+    M10 = 0.0,
+    M11 = 0.0,
+    M20 = 0.0;
 
-    PointInfo
-      centroid = { 0.0, 0.0 };
+  PointInfo
+    centroid = { 0.0, 0.0 };
 
-    RectangleInfo
-      bounding_box;
+  RectangleInfo
+    bounding_box;
 
-    const Quantum
-      *magick_restrict p;
+  const Quantum
+    *magick_restrict p;
 
-    ssize_t
-      x;
+  ssize_t
+    x;
 
-    ssize_t
-      y;
+  ssize_t
+    y;
 
-    /*
-      Compute ellipse angle of each object.
-    */
-    if (status == MagickFalse)
-      continue;
-    component_view=AcquireAuthenticCacheView(component_image,exception);
-    bounding_box=object[i].bounding_box;
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+  /*
+    Compute ellipse angle of the object.
+  */
+  status=MagickTrue;
+  component_view=AcquireAuthenticCacheView(component_image,exception);
+  bounding_box=object[i].bounding_box;
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
+      {
+        status=MagickFalse;
+        break;
+      }
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M00++;
+          M10+=x;
+          M01+=y;
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
+    }
+  }
+  centroid.x=M10*MagickSafeReciprocal(M00);
+  centroid.y=M01*MagickSafeReciprocal(M00);
+  for (y=0; y < (ssize_t) bounding_box.height; y++)
+  {
+    if (status == MagickFalse)
+      continue;
+    p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
+      bounding_box.y+y,bounding_box.width,1,exception);
+    if (p == (const Quantum *) NULL)
       {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M00++;
-            M10+=x;
-            M01+=y;
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
+        status=MagickFalse;
+        break;
       }
-    }
-    centroid.x=M10*MagickSafeReciprocal(M00);
-    centroid.y=M01*MagickSafeReciprocal(M00);
-    for (y=0; y < (ssize_t) bounding_box.height; y++)
+    for (x=0; x < (ssize_t) bounding_box.width; x++)
     {
-      if (status == MagickFalse)
-        continue;
-      p=GetCacheViewVirtualPixels(component_view,bounding_box.x,
-        bounding_box.y+y,bounding_box.width,1,exception);
-      if (p == (const Quantum *) NULL)
+      if ((ssize_t) GetPixelIndex(component_image,p) == i)
         {
-          status=MagickFalse;
-          break;
+          M11+=(x-centroid.x)*(y-centroid.y);
+          M20+=(x-centroid.x)*(x-centroid.x);
+          M02+=(y-centroid.y)*(y-centroid.y);
         }
-      for (x=0; x < (ssize_t) bounding_box.width; x++)
+      p+=(ptrdiff_t) GetPixelChannels(component_image);
+    }
+  }
+  component_view=DestroyCacheView(component_view);
+  object[i].metric[metric_index]=RadiansToDegrees(1.0/2.0*atan(2.0*M11*
+    MagickSafeReciprocal(M20-M02)));
+  if (fabs(M11) < 0.0)
       {
-        if ((ssize_t) GetPixelIndex(component_image,p) == i)
-          {
-            M11+=(x-centroid.x)*(y-centroid.y);
-            M20+=(x-centroid.x)*(x-centroid.x);
-            M02+=(y-centroid.y)*(y-centroid.y);
-          }
-        p+=(ptrdiff_t) GetPixelChannels(component_image);
+        if ((fabs(M20-M02) >= 0.0) && ((M20-M02) < 0.0))
+          object[i].metric[metric_index]+=90.0;
       }
-    }
-    component_view=DestroyCacheView(component_view);
-    object[i].metric[metric_index]=RadiansToDegrees(1.0/2.0*atan(2.0*M11*
-      MagickSafeReciprocal(M20-M02)));
-    if (fabs(M11) < 0.0)
+    else
+      if (M11 < 0.0)
         {
-          if ((fabs(M20-M02) >= 0.0) && ((M20-M02) < 0.0))
-            object[i].metric[metric_index]+=90.0;
+          if (fabs(M20-M02) >= 0.0)
+            {
+              if ((M20-M02) < 0.0)
+                object[i].metric[metric_index]+=90.0;
+              else
+                object[i].metric[metric_index]+=180.0;
+            }
         }
       else
-        if (M11 < 0.0)
-          {
-            if (fabs(M20-M02) >= 0.0)
-              {
-                if ((M20-M02) < 0.0)
-                  object[i].metric[metric_index]+=90.0;
-                else
-                  object[i].metric[metric_index]+=180.0;
-              }
-          }
-        else
-          if ((fabs(M20-M02) >= 0.0) && ((M20-M02) < 0.0))
-            object[i].metric[metric_index]+=90.0;
-  }
+        if ((fabs(M20-M02) >= 0.0) && ((M20-M02) < 0.0))
+          object[i].metric[metric_index]+=90.0;
+  return(status);
+}
+
+static void AngleThreshold(const Image *component_image,
+  CCObjectInfo *object,const ssize_t metric_index,ExceptionInfo *exception)
+{
+  ExecuteCCMetricTasks(component_image,object,metric_index,
+    AngleMetric,exception);
 }
 
 MagickExport Image *ConnectedComponentsImage(const Image *image,
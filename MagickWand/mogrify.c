@@ -3638,6 +3638,8 @@ static MagickBooleanType MogrifyUsage(void)
       "  -monitor             monitor progress\n"
       "  -orient type         image orientation\n"
       "  -page geometry       size and location of an image canvas (setting)\n"
+      "  -parallel-images value\n"
+      "                       number of files to mogrify concurrently\n"
       "  -path path           write images to this path on disk\n"
       "  -ping                efficiently determine image attributes\n"
       "  -pointsize value     font point size\n"
@@ -3712,6 +3714,233 @@ static MagickBooleanType MogrifyUsage(void)
   return(MagickTrue);
 }
 
+typedef struct _MogrifyJob
+{
+  char
+    *format,
+    *path;
+
+  ImageInfo
+    *image_info;
+
+  MagickBooleanType
+    global_colormap;
+
+  ssize_t
+    first,
+    last;
+} MogrifyJob;
+
+static MogrifyJob *DestroyMogrifyJobs(MogrifyJob *jobs,
+  const size_t number_jobs)
+{
+  ssize_t
+    i;
+
+  for (i=0; i < (ssize_t) number_jobs; i++)
+  {
+    if (jobs[i].format != (char *) NULL)
+      jobs[i].format=DestroyString(jobs[i].format);
+    if (jobs[i].path != (char *) NULL)
+      jobs[i].path=DestroyString(jobs[i].path);
+    if (jobs[i].image_info != (ImageInfo *) NULL)
+      jobs[i].image_info=DestroyImageInfo(jobs[i].image_info);
+  }
+  return((MogrifyJob *) RelinquishMagickMemory(jobs));
+}
+
+static void SetMogrifyImageFilename(const char *filename,const char *format,
+  const char *path,Image *images)
+{
+  char
+    tail[MagickPathExtent];
+
+  /*
+    Name the transmogrified image after its format and output path.
+  */
+  if (format != (char *) NULL)
+    GetPathComponent(images->magick_filename,BasePathSansCompressExtension,
+      images->filename);
+  if (path != (char *) NULL)
+    {
+      GetPathComponent(filename,TailPath,tail);
+      (void) FormatLocaleString(images->filename,MagickPathExtent,"%s%c%s",
+        path,*DirectorySeparator,tail);
+    }
+  if (format != (char *) NULL)
+    AppendImageFormat(format,images->filename);
+}
+
+static MagickBooleanType WriteMogrifyImages(ImageInfo *image_info,
+  Image *images,const char *filename,const char *format,
+  const MagickBooleanType global_colormap,struct stat *properties,
+  ExceptionInfo *exception)
+{
+  char
+    backup_filename[MagickPathExtent],
+    magic[MagickPathExtent];
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    i;
+
+  if (global_colormap != MagickFalse)
+    {
+      QuantizeInfo
+        *quantize_info;
+
+      quantize_info=AcquireQuantizeInfo(image_info);
+      (void) RemapImages(quantize_info,images,(Image *) NULL,exception);
+      quantize_info=DestroyQuantizeInfo(quantize_info);
+    }
+  *backup_filename='\0';
+  *magic='\0';
+  GetPathComponent(filename,MagickPath,magic);
+  if (*magic != '\0')
+    {
+      char
+        name[MagickPathExtent];
+
+      if (format != (char *) NULL)
+        (void) CopyMagickString(magic,format,MagickPathExtent);
+      (void) FormatLocaleString(name,MagickPathExtent,"%s:%s",magic,
+        images->filename);
+      (void) CopyMagickString(images->filename,name,MagickPathExtent);
+    }
+  if ((LocaleCompare(images->filename,"-") != 0) &&
+      (IsPathWritable(images->filename) != MagickFalse))
+    {
+      /*
+        Rename image file as backup.
+      */
+      (void) CopyMagickString(backup_filename,images->filename,
+        MagickPathExtent);
+      for (i=0; i < 6; i++)
+      {
+        (void) ConcatenateMagickString(backup_filename,"~",MagickPathExtent);
+        if (IsPathAccessible(backup_filename) == MagickFalse)
+          break;
+      }
+      if ((IsPathAccessible(backup_filename) != MagickFalse) ||
+          (rename_utf8(images->filename,backup_filename) != 0))
+        *backup_filename='\0';
+    }
+  /*
+    Write transmogrified image to disk.
+  */
+  image_info->synchronize=MagickTrue;
+  status=WriteImages(image_info,images,images->filename,exception);
+  if (status != MagickFalse)
+    {
+      if (IsStringTrue(GetImageOption(image_info,"preserve-timestamp")) !=
+          MagickFalse)
+        (void) set_file_timestamp(images->filename,properties);
+      if (*backup_filename != '\0')
+        (void) remove_utf8(backup_filename);
+    }
+  else
+    if (*backup_filename != '\0')
+      (void) rename_utf8(backup_filename,images->filename);
+  return(status);
+}
+
+static MagickBooleanType MogrifyImageFile(MogrifyJob *job,char **argv,
+  ExceptionInfo *exception)
+{
+  Image
+    *images;
+
+  ImageInfo
+    *image_info;
+
+  MagickStatusType
+    status;
+
+  struct stat
+    properties;
+
+  /*
+    Read, transmogrify, and write one file of a -parallel-images batch.
+  */
+  image_info=job->image_info;
+  images=ReadImages(image_info,argv[job->last],exception);
+  if (images == (Image *) NULL)
+    return(MagickFalse);
+  status=exception->severity < ErrorException ? MagickTrue : MagickFalse;
+  properties=(*GetBlobProperties(images));
+  SetMogrifyImageFilename(argv[job->last],job->format,job->path,images);
+  (void) SyncImagesSettings(image_info,images,exception);
+  status&=(MagickStatusType) MogrifyImages(image_info,MagickTrue,(int)
+    (job->last-job->first+1),(const char **) (argv+job->first),&images,
+    exception);
+  if (images == (Image *) NULL)
+    return(MagickFalse);
+  (void) SyncImagesSettings(image_info,images,exception);
+  status&=(MagickStatusType) WriteMogrifyImages(image_info,images,
+    argv[job->last],job->format,job->global_colormap,&properties,exception);
+  images=DestroyImageList(images);
+  return(status != 0 ? MagickTrue : MagickFalse);
+}
+
+static MagickBooleanType MogrifyImageFiles(MogrifyJob *jobs,
+  const size_t number_jobs,const size_t parallel_images,char **argv,
+  ExceptionInfo *exception)
+{
+  int
+    max_active_levels;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    number_threads;
+
+  ssize_t
+    i;
+
+  /*
+    Schedule whole files across threads; each file is processed by a single
+    thread so thousands of small images scale with the number of cores.
+    Pixel caches share the process-wide memory, map, and disk limits and
+    spill to disk once the batch exceeds its memory budget.
+  */
+  number_threads=MagickMin(MagickMin(parallel_images,number_jobs),(size_t)
+    GetMagickResourceLimit(ThreadResource));
+  if (number_threads == 0)
+    number_threads=1;
+  max_active_levels=GetOpenMPMaxActiveLevels();
+  SetOpenMPMaxActiveLevels(0);
+  status=MagickTrue;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(dynamic,1) shared(status) \
+    num_threads((int) number_threads)
+#endif
+  for (i=0; i < (ssize_t) number_jobs; i++)
+  {
+    ExceptionInfo
+      *sans_exception;
+
+    MagickBooleanType
+      proceed;
+
+    sans_exception=AcquireExceptionInfo();
+    proceed=MogrifyImageFile(jobs+i,argv,sans_exception);
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+    #pragma omp critical (MagickWand_MogrifyImageFiles)
+#endif
+    {
+      if (proceed == MagickFalse)
+        status=MagickFalse;
+      InheritException(exception,sans_exception);
+    }
+    sans_exception=DestroyExceptionInfo(sans_exception);
+  }
+  SetOpenMPMaxActiveLevels(max_active_levels);
+  return(status);
+}
+
 WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
   int argc,char **argv,char **wand_unused(metadata),ExceptionInfo *exception)
 {
@@ -3721,6 +3950,8 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
     format=DestroyString(format); \
   if (path != (char *) NULL) \
     path=DestroyString(path); \
+  if (jobs != (MogrifyJob *) NULL) \
+    jobs=DestroyMogrifyJobs(jobs,number_jobs); \
   DestroyImageStack(); \
   for (i=0; i < (ssize_t) argc; i++) \
     argv[i]=DestroyString(argv[i]); \
@@ -3760,11 +3991,20 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
   MagickBooleanType
     fire,
     pend,
-    respect_parentheses;
+    respect_parentheses,
+    size_hint;
 
   MagickStatusType
     status;
 
+  MogrifyJob
+    *jobs;
+
+  size_t
+    extent,
+    number_jobs,
+    parallel_images;
+
   ssize_t
     i;
 
@@ -3802,12 +4042,17 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
   format=(char *) NULL;
   path=(char *) NULL;
   global_colormap=MagickFalse;
+  jobs=(MogrifyJob *) NULL;
+  extent=0;
+  number_jobs=0;
+  parallel_images=0;
   k=0;
   j=1;
   NewImageStack();
   option=(char *) NULL;
   pend=MagickFalse;
   respect_parentheses=MagickFalse;
+  size_hint=MagickTrue;
   status=MagickTrue;
   /*
     Parse command line.
@@ -3840,9 +4085,7 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
     if (IsCommandOption(option) == MagickFalse)
       {
         char
-          backup_filename[MagickPathExtent],
-          *filename,
-          magic[MagickPathExtent];
+          *filename;
 
         Image
           *images;
@@ -3857,92 +4100,60 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
         filename=argv[i];
         if ((LocaleCompare(filename,"--") == 0) && (i < ((ssize_t) argc-1)))
           filename=argv[++i];
+        if ((parallel_images > 1) && (k == 0) &&
+            (LocaleCompare(filename,"-") != 0))
+          {
+            /*
+              Defer the file to a batch processed concurrently below.
+            */
+            if (number_jobs == extent)
+              {
+                MogrifyJob
+                  *resize_jobs;
+
+                /*
+                  ResizeQuantumMemory() would free the old jobs on failure but
+                  leak their contents; keep them for DestroyMogrify() instead.
+                */
+                extent=MagickMax(2*extent,256);
+                resize_jobs=(MogrifyJob *) AcquireQuantumMemory(extent,
+                  sizeof(*jobs));
+                if (resize_jobs == (MogrifyJob *) NULL)
+                  ThrowMogrifyException(ResourceLimitError,
+                    "MemoryAllocationFailed",(char *) NULL);
+                if (jobs != (MogrifyJob *) NULL)
+                  {
+                    (void) memcpy(resize_jobs,jobs,number_jobs*sizeof(*jobs));
+                    jobs=(MogrifyJob *) RelinquishMagickMemory(jobs);
+                  }
+                jobs=resize_jobs;
+              }
+            jobs[number_jobs].format=(char *) NULL;
+            if (format != (char *) NULL)
+              jobs[number_jobs].format=ConstantString(format);
+            jobs[number_jobs].path=(char *) NULL;
+            if (path != (char *) NULL)
+              jobs[number_jobs].path=ConstantString(path);
+            jobs[number_jobs].image_info=CloneImageInfo(image_info);
+            jobs[number_jobs].global_colormap=global_colormap;
+            jobs[number_jobs].first=j;
+            jobs[number_jobs].last=i;
+            number_jobs++;
+            continue;
+          }
         images=ReadImages(image_info,filename,exception);
         status&=(MagickStatusType) (images != (Image *) NULL) &&
           (exception->severity < ErrorException);
         if (images == (Image *) NULL)
           continue;
         properties=(*GetBlobProperties(images));
-        if (format != (char *) NULL)
-          GetPathComponent(images->magick_filename,
-            BasePathSansCompressExtension,images->filename);
-        if (path != (char *) NULL)
-          {
-            GetPathComponent(option,TailPath,filename);
-            (void) FormatLocaleString(images->filename,MagickPathExtent,
-              "%s%c%s",path,*DirectorySeparator,filename);
-          }
-        if (format != (char *) NULL)
-          AppendImageFormat(format,images->filename);
+        SetMogrifyImageFilename(filename,format,path,images);
         AppendImageStack(images);
         FinalizeImageSettings(image_info,image,MagickFalse);
         if (image == (Image *) NULL)
           continue;
-        if (global_colormap != MagickFalse)
-          {
-            QuantizeInfo
-              *quantize_info;
-
-            quantize_info=AcquireQuantizeInfo(image_info);
-            (void) RemapImages(quantize_info,images,(Image *) NULL,exception);
-            quantize_info=DestroyQuantizeInfo(quantize_info);
-          }
-        *backup_filename='\0';
-        *magic='\0';
-        GetPathComponent(filename,MagickPath,magic);
-        if (*magic != '\0')
-          {
-            char
-              name[MagickPathExtent];
-
-            if (format != (char *) NULL)
-              (void) CopyMagickString(magic,format,MagickPathExtent);
-            (void) FormatLocaleString(name,MagickPathExtent,"%s:%s",magic,
-              image->filename);
-            (void) CopyMagickString(image->filename,name,MagickPathExtent);
-          }
-        if ((LocaleCompare(image->filename,"-") != 0) &&
-            (IsPathWritable(image->filename) != MagickFalse))
-          {
-            /*
-              Rename image file as backup.
-            */
-            (void) CopyMagickString(backup_filename,image->filename,
-              MagickPathExtent);
-            for (j=0; j < 6; j++)
-            {
-              (void) ConcatenateMagickString(backup_filename,"~",
-                MagickPathExtent);
-              if (IsPathAccessible(backup_filename) == MagickFalse)
-                break;
-            }
-            if ((IsPathAccessible(backup_filename) != MagickFalse) ||
-                (rename_utf8(image->filename,backup_filename) != 0))
-              *backup_filename='\0';
-          }
-        /*
-          Write transmogrified image to disk.
-        */
-        image_info->synchronize=MagickTrue;
-        status&=(MagickStatusType) WriteImages(image_info,image,image->filename,
-          exception);
-        if (status != MagickFalse)
-          {
-            {
-              MagickBooleanType
-                preserve_timestamp;
-
-              preserve_timestamp=IsStringTrue(GetImageOption(image_info,
-                "preserve-timestamp"));
-              if (preserve_timestamp != MagickFalse)
-                (void) set_file_timestamp(image->filename,&properties);
-            }
-            if (*backup_filename != '\0')
-              (void) remove_utf8(backup_filename);
-          }
-        else
-          if (*backup_filename != '\0')
-            (void) rename_utf8(backup_filename,image->filename);
+        status&=(MagickStatusType) WriteMogrifyImages(image_info,image,
+          filename,format,global_colormap,&properties,exception);
         RemoveAllImageStack();
         continue;
       }
@@ -5645,6 +5856,19 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
               ThrowMogrifyInvalidArgumentException(option,argv[i]);
             break;
           }
+        if (LocaleCompare("parallel-images",option+1) == 0)
+          {
+            parallel_images=0;
+            if (*option == '+')
+              break;
+            i++;
+            if (i == (ssize_t) argc)
+              ThrowMogrifyException(OptionError,"MissingArgument",option);
+            if (IsGeometry(argv[i]) == MagickFalse)
+              ThrowMogrifyInvalidArgumentException(option,argv[i]);
+            parallel_images=StringToUnsignedLong(argv[i]);
+            break;
+          }
         if (LocaleCompare("path",option+1) == 0)
           {
             (void) CloneString(&path,(char *) NULL);
@@ -6358,6 +6582,15 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
               ThrowMogrifyException(OptionError,"MissingArgument",option);
             if (IsGeometry(argv[i]) == MagickFalse)
               ThrowMogrifyInvalidArgumentException(option,argv[i]);
+            if ((size_hint != MagickFalse) &&
+                (GetImageOption(image_info,"decode:size") == (char *) NULL))
+              {
+                /*
+                  Thumbnail is the first operator: let decoders shrink on load.
+                */
+                (void) SetImageOption(image_info,"decode:size",argv[i]);
+                size_hint=MagickFalse;
+              }
             break;
           }
         if (LocaleCompare("transparent",option+1) == 0)
@@ -6587,7 +6820,13 @@ WandExport MagickBooleanType MogrifyImageCommand(ImageInfo *image_info,
       FireOptionFlag) == 0 ?  MagickFalse : MagickTrue;
     if (fire != MagickFalse)
       FireImageStack(MagickFalse,MagickTrue,MagickTrue);
+    if ((GetCommandOptionFlags(MagickCommandOptions,MagickFalse,option) &
+         (SimpleOperatorFlag | ListOperatorFlag)) != 0)
+      size_hint=MagickFalse;
   }
+  if (number_jobs != 0)
+    status&=(MagickStatusType) MogrifyImageFiles(jobs,number_jobs,
+      parallel_images,argv,exception);
   if (k != 0)
     ThrowMogrifyException(OptionError,"UnbalancedParenthesis",argv[i]);
   if (i != (ssize_t) argc)
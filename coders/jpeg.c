@@ -415,6 +415,8 @@ static MagickBooleanType IsUltraHDRJPEGReadOptionsCompatible(
 {
   if (GetImageOption(image_info,"jpeg:size") != (const char *) NULL)
     return(MagickFalse);
+  if (GetImageOption(image_info,"decode:size") != (const char *) NULL)
+    return(MagickFalse);
   if (GetImageOption(image_info,"jpeg:colors") != (const char *) NULL)
     return(MagickFalse);
   if (GetImageOption(image_info,"jpeg:block-smoothing") != (const char *) NULL)
@@ -1689,6 +1691,8 @@ static Image *ReadOneJPEGImage(const ImageInfo *image_info,
     }
   number_pixels=(MagickSizeType) image->columns*image->rows;
   option=GetImageOption(image_info,"jpeg:size");
+  if (option == (const char *) NULL)
+    option=GetImageOption(image_info,"decode:size");
   if ((option != (const char *) NULL) &&
       (jpeg_info->out_color_space != JCS_YCbCr))
     {
@@ -1698,6 +1702,9 @@ static Image *ReadOneJPEGImage(const ImageInfo *image_info,
       GeometryInfo
         geometry_info;
 
+      MagickBooleanType
+        size_hint;
+
       MagickStatusType
         flags;
 
@@ -1716,8 +1723,20 @@ static Image *ReadOneJPEGImage(const ImageInfo *image_info,
       if ((geometry_info.sigma != 0.0) &&
           (scale_factor > (jpeg_info->output_height/geometry_info.sigma)))
         scale_factor=jpeg_info->output_height/geometry_info.sigma;
+      size_hint=GetImageOption(image_info,"jpeg:size") == (const char *) NULL ?
+        MagickTrue : MagickFalse;
+      if ((size_hint != MagickFalse) && (scale_factor < 1.0))
+        scale_factor=1.0;
 #if defined(LIBJPEG_TURBO_VERSION_NUMBER) || (JPEG_LIB_VERSION >= 70)
       jpeg_info->scale_num=(unsigned int) (8.0/scale_factor+0.5);
+      if (size_hint != MagickFalse)
+        {
+          /*
+            A decode size hint never yields an image smaller than the hint.
+          */
+          jpeg_info->scale_num=(unsigned int) ceil(8.0/scale_factor-
+            MagickEpsilon);
+        }
       if (jpeg_info->scale_num > 16U)
         jpeg_info->scale_num=16U;
       if (jpeg_info->scale_num < 1U)
@@ -2264,6 +2283,7 @@ ModuleExport size_t RegisterJPEGImage(void)
 #endif
   entry->magick=(IsImageFormatHandler *) IsJPEG;
   entry->flags|=CoderDecoderSeekableStreamFlag;
+  entry->flags|=CoderDecoderSizeHintFlag;
   entry->flags^=CoderAdjoinFlag;
   entry->flags^=CoderUseExtensionFlag;
   if (*version != '\0')
@@ -2280,6 +2300,7 @@ ModuleExport size_t RegisterJPEGImage(void)
 #endif
   entry->magick=(IsImageFormatHandler *) IsJPEG;
   entry->flags|=CoderDecoderSeekableStreamFlag;
+  entry->flags|=CoderDecoderSizeHintFlag;
   entry->flags^=CoderAdjoinFlag;
   if (*version != '\0')
     entry->version=ConstantString(version);
@@ -2294,6 +2315,7 @@ ModuleExport size_t RegisterJPEGImage(void)
   entry->encoder=(EncodeImageHandler *) WriteJPEGImage;
 #endif
   entry->flags|=CoderDecoderSeekableStreamFlag;
+  entry->flags|=CoderDecoderSizeHintFlag;
   entry->flags^=CoderAdjoinFlag;
   entry->flags^=CoderUseExtensionFlag;
   if (*version != '\0')
@@ -2337,6 +2359,7 @@ ModuleExport size_t RegisterJPEGImage(void)
   entry->encoder=(EncodeImageHandler *) WriteJPEGImage;
 #endif
   entry->flags|=CoderDecoderSeekableStreamFlag;
+  entry->flags|=CoderDecoderSizeHintFlag;
   entry->flags^=CoderAdjoinFlag;
   entry->flags^=CoderUseExtensionFlag;
   if (*version != '\0')
@@ -71,10 +71,12 @@
 #include "MagickCore/profile-private.h"
 #include "MagickCore/property.h"
 #include "MagickCore/quantum-private.h"
+#include "MagickCore/resource_.h"
 #include "MagickCore/static.h"
 #include "MagickCore/statistic.h"
 #include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
+#include "MagickCore/thread-private.h"
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
 #include "bzlib.h"
 #endif
@@ -85,6 +87,40 @@
 #include "zlib.h"
 #endif
 
+/*
+  Define declarations.
+*/
+#define BZipMaxExtent(x)  ((x)+((x)/100)+600)
+#define LZMAMaxExtent(x)  ((x)+((x)/3)+128)
+#define ZipMaxExtent(x)  ((x)+(((x)+7) >> 3)+(((x)+63) >> 6)+11)
+
+/*
+  Typedef declarations.
+*/
+typedef struct _MIFFRowGroupInfo
+{
+  CompressionType
+    compression;
+
+  MagickOffsetType
+    offset;
+
+  MemoryInfo
+    *pixel_info;
+
+  size_t
+    batch,
+    extent,
+    *lengths,
+    number_groups,
+    quality,
+    rows;
+
+  unsigned char
+    **groups,
+    *pixels;
+} MIFFRowGroupInfo;
+
 /*
   Forward declarations.
 */
@@ -401,20 +437,448 @@ static void RelinquishZIPMemory(voidpf context,voidpf memory)
 }
 #endif
 
+static MIFFRowGroupInfo *DestroyMIFFRowGroupInfo(MIFFRowGroupInfo *group_info)
+{
+  ssize_t
+    i;
+
+  if (group_info->groups != (unsigned char **) NULL)
+    {
+      for (i=0; i < (ssize_t) group_info->number_groups; i++)
+        if (group_info->groups[i] != (unsigned char *) NULL)
+          group_info->groups[i]=(unsigned char *) RelinquishMagickMemory(
+            group_info->groups[i]);
+      group_info->groups=(unsigned char **) RelinquishMagickMemory(
+        group_info->groups);
+    }
+  if (group_info->lengths != (size_t *) NULL)
+    group_info->lengths=(size_t *) RelinquishMagickMemory(group_info->lengths);
+  if (group_info->pixel_info != (MemoryInfo *) NULL)
+    group_info->pixel_info=RelinquishVirtualMemory(group_info->pixel_info);
+  group_info=(MIFFRowGroupInfo *) RelinquishMagickMemory(group_info);
+  return(group_info);
+}
+
+static MIFFRowGroupInfo *AcquireMIFFRowGroupInfo(const Image *image,
+  const CompressionType compression,const size_t rows,const size_t extent)
+{
+  MIFFRowGroupInfo
+    *group_info;
+
+  size_t
+    number_threads;
+
+  /*
+    Row groups are compressed independently, so each one is a complete
+    Zip, BZip, or LZMA stream of at most rows*extent bytes.
+  */
+  if ((rows == 0) || (extent == 0) || (extent > ((size_t) UINT_MAX/2)))
+    return((MIFFRowGroupInfo *) NULL);
+  group_info=(MIFFRowGroupInfo *) AcquireCriticalMemory(sizeof(*group_info));
+  (void) memset(group_info,0,sizeof(*group_info));
+  group_info->compression=compression;
+  group_info->offset=(-1);
+  group_info->quality=image->quality;
+  group_info->extent=extent;
+  group_info->rows=MagickMin(MagickMin(rows,image->rows),((size_t) UINT_MAX/
+    2)/extent);
+  group_info->number_groups=(image->rows+group_info->rows-1)/group_info->rows;
+  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
+  group_info->batch=MagickMin(MagickMax(number_threads,1),
+    group_info->number_groups);
+  group_info->groups=(unsigned char **) AcquireQuantumMemory(
+    group_info->number_groups,sizeof(*group_info->groups));
+  group_info->lengths=(size_t *) AcquireQuantumMemory(
+    group_info->number_groups,sizeof(*group_info->lengths));
+  group_info->pixel_info=AcquireVirtualMemory(group_info->batch*
+    group_info->rows,extent);
+  if ((group_info->groups == (unsigned char **) NULL) ||
+      (group_info->lengths == (size_t *) NULL) ||
+      (group_info->pixel_info == (MemoryInfo *) NULL))
+    return(DestroyMIFFRowGroupInfo(group_info));
+  (void) memset(group_info->groups,0,group_info->number_groups*
+    sizeof(*group_info->groups));
+  (void) memset(group_info->lengths,0,group_info->number_groups*
+    sizeof(*group_info->lengths));
+  group_info->pixels=(unsigned char *) GetVirtualMemoryBlob(
+    group_info->pixel_info);
+  return(group_info);
+}
+
+static inline size_t GetMIFFRowGroupExtent(
+  const MIFFRowGroupInfo *group_info,const size_t length)
+{
+  /*
+    The most a row group of length bytes can compress to.
+  */
+  switch (group_info->compression)
+  {
+    case BZipCompression: return(BZipMaxExtent(length));
+    case LZMACompression: return(LZMAMaxExtent(length));
+    default: return(ZipMaxExtent(length));
+  }
+}
+
+static inline size_t GetMIFFRowGroupLength(const Image *image,
+  const MIFFRowGroupInfo *group_info,const size_t group)
+{
+  return(MagickMin(group_info->rows,image->rows-group*group_info->rows)*
+    group_info->extent);
+}
+
+static MagickBooleanType CompressMIFFRowGroups(const Image *image,
+  MIFFRowGroupInfo *group_info,const size_t first_group,
+  const size_t number_groups)
+{
+  MagickBooleanType
+    status;
+
+  ssize_t
+    i;
+
+  /*
+    Compress a batch of row groups concurrently.
+  */
+  status=MagickTrue;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(dynamic) shared(status) \
+    num_threads((int) group_info->batch)
+#endif
+  for (i=0; i < (ssize_t) number_groups; i++)
+  {
+    int
+      level;
+
+    size_t
+      extent,
+      group,
+      length;
+
+    unsigned char
+      *compressed,
+      *pixels;
+
+    if (status == MagickFalse)
+      continue;
+    group=first_group+(size_t) i;
+    length=GetMIFFRowGroupLength(image,group_info,group);
+    pixels=group_info->pixels+(size_t) i*group_info->rows*group_info->extent;
+    extent=GetMIFFRowGroupExtent(group_info,length);
+    compressed=(unsigned char *) AcquireQuantumMemory(extent,
+      sizeof(*compressed));
+    if (compressed == (unsigned char *) NULL)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    level=(int) (group_info->quality == UndefinedCompressionQuality ? 7 :
+      MagickMin(group_info->quality/10,9));
+    switch (group_info->compression)
+    {
+#if defined(MAGICKCORE_BZLIB_DELEGATE)
+      case BZipCompression:
+      {
+        unsigned int
+          compressed_length;
+
+        compressed_length=(unsigned int) extent;
+        if (BZ2_bzBuffToBuffCompress((char *) compressed,&compressed_length,
+              (char *) pixels,(unsigned int) length,MagickMax(level,1),0,0) != BZ_OK)
+          status=MagickFalse;
+        extent=(size_t) compressed_length;
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_LZMA_DELEGATE)
+      case LZMACompression:
+      {
+        size_t
+          compressed_length;
+
+        compressed_length=0;
+        if (lzma_easy_buffer_encode((uint32_t) MagickMin(
+              group_info->quality/10,9),
+              LZMA_CHECK_SHA256,(const lzma_allocator *) NULL,pixels,length,
+              compressed,&compressed_length,extent) != LZMA_OK)
+          status=MagickFalse;
+        extent=compressed_length;
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+      case LZWCompression:
+      case ZipCompression:
+      {
+        uLongf
+          compressed_length;
+
+        compressed_length=(uLongf) extent;
+        if (compress2(compressed,&compressed_length,pixels,(uLong) length,
+              level) != Z_OK)
+          status=MagickFalse;
+        extent=(size_t) compressed_length;
+        break;
+      }
+#endif
+      default:
+      {
+        status=MagickFalse;
+        break;
+      }
+    }
+    if ((status != MagickFalse) && (group_info->offset < 0))
+      {
+        /*
+          Groups held until the whole image is compressed keep only their
+          compressed bytes.
+        */
+        compressed=(unsigned char *) ResizeQuantumMemory(compressed,
+          MagickMax(extent,1),sizeof(*compressed));
+        if (compressed == (unsigned char *) NULL)
+          status=MagickFalse;
+      }
+    group_info->groups[group]=compressed;
+    group_info->lengths[group]=extent;
+  }
+  return(status);
+}
+
+static MagickBooleanType WriteMIFFRowGroupIndex(Image *image,
+  const MIFFRowGroupInfo *group_info)
+{
+  ssize_t
+    i;
+
+  /*
+    The index of compressed row group lengths precedes the row groups.
+  */
+  for (i=0; i < (ssize_t) group_info->number_groups; i++)
+    if (WriteBlobMSBLong(image,(unsigned int) group_info->lengths[i]) != 4)
+      return(MagickFalse);
+  return(MagickTrue);
+}
+
+static MagickBooleanType StartMIFFRowGroups(Image *image,
+  MIFFRowGroupInfo *group_info)
+{
+  MagickOffsetType
+    offset;
+
+  /*
+    When the blob can seek back, reserve the index so each batch of row
+    groups is written as soon as it is compressed; FinishMIFFRowGroups()
+    fills the index in.  Otherwise every group is held until the index can
+    be written.  A compressed file reports itself seekable but only seeks
+    forward, so probe a step back first.
+  */
+  if (IsBlobSeekable(image) == MagickFalse)
+    return(MagickTrue);
+  offset=TellBlob(image);
+  if ((offset <= 0) || (SeekBlob(image,offset-1,SEEK_SET) != (offset-1)))
+    return(MagickTrue);
+  if (SeekBlob(image,offset,SEEK_SET) != offset)
+    return(MagickFalse);
+  group_info->offset=offset;
+  return(WriteMIFFRowGroupIndex(image,group_info));
+}
+
+static MagickBooleanType WriteMIFFRowGroups(Image *image,
+  MIFFRowGroupInfo *group_info,const size_t first_group,
+  const size_t number_groups)
+{
+  ssize_t
+    i;
+
+  for (i=0; i < (ssize_t) number_groups; i++)
+  {
+    size_t
+      group;
+
+    group=first_group+(size_t) i;
+    if (WriteBlob(image,group_info->lengths[group],group_info->groups[group]) !=
+        (ssize_t) group_info->lengths[group])
+      return(MagickFalse);
+    group_info->groups[group]=(unsigned char *) RelinquishMagickMemory(
+      group_info->groups[group]);
+  }
+  return(MagickTrue);
+}
+
+static MagickBooleanType FinishMIFFRowGroups(Image *image,
+  MIFFRowGroupInfo *group_info)
+{
+  MagickOffsetType
+    offset;
+
+  if (group_info->offset < 0)
+    {
+      if (WriteMIFFRowGroupIndex(image,group_info) == MagickFalse)
+        return(MagickFalse);
+      return(WriteMIFFRowGroups(image,group_info,0,group_info->number_groups));
+    }
+  offset=TellBlob(image);
+  if ((offset < 0) || (SeekBlob(image,group_info->offset,SEEK_SET) < 0))
+    return(MagickFalse);
+  if (WriteMIFFRowGroupIndex(image,group_info) == MagickFalse)
+    return(MagickFalse);
+  if (SeekBlob(image,offset,SEEK_SET) < 0)
+    return(MagickFalse);
+  return(MagickTrue);
+}
+
+static MagickBooleanType ReadMIFFRowGroups(Image *image,
+  MIFFRowGroupInfo *group_info,const size_t first_group,
+  const size_t number_groups)
+{
+  MagickBooleanType
+    status;
+
+  MagickSizeType
+    remaining;
+
+  ssize_t
+    i;
+
+  /*
+    The lengths are untrusted: before anything is allocated, each must be
+    within the compression bound of its row group and the batch must fit in
+    a seekable blob.  The blob size of a compressed file is that of the
+    compressed data, so it is not compared with the current offset.
+  */
+  remaining=MagickResourceInfinity;
+  if (IsBlobSeekable(image) != MagickFalse)
+    remaining=GetBlobSize(image);
+  for (i=0; i < (ssize_t) number_groups; i++)
+  {
+    size_t
+      extent,
+      group,
+      length;
+
+    group=first_group+(size_t) i;
+    length=GetMIFFRowGroupLength(image,group_info,group);
+    extent=GetMIFFRowGroupExtent(group_info,length);
+    if ((group_info->lengths[group] == 0) ||
+        (group_info->lengths[group] > extent) ||
+        ((MagickSizeType) group_info->lengths[group] > remaining))
+      return(MagickFalse);
+    remaining-=group_info->lengths[group];
+  }
+  /*
+    Read a batch of row groups in file order, then decompress them
+    concurrently.
+  */
+  for (i=0; i < (ssize_t) number_groups; i++)
+  {
+    size_t
+      group;
+
+    group=first_group+(size_t) i;
+    group_info->groups[group]=(unsigned char *) AcquireQuantumMemory(
+      MagickMax(group_info->lengths[group],1),sizeof(**group_info->groups));
+    if (group_info->groups[group] == (unsigned char *) NULL)
+      return(MagickFalse);
+    if (ReadBlob(image,group_info->lengths[group],group_info->groups[group]) !=
+        (ssize_t) group_info->lengths[group])
+      return(MagickFalse);
+  }
+  status=MagickTrue;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(dynamic) shared(status) \
+    num_threads((int) group_info->batch)
+#endif
+  for (i=0; i < (ssize_t) number_groups; i++)
+  {
+    size_t
+      group,
+      length;
+
+    unsigned char
+      *pixels;
+
+    if (status == MagickFalse)
+      continue;
+    group=first_group+(size_t) i;
+    length=GetMIFFRowGroupLength(image,group_info,group);
+    pixels=group_info->pixels+(size_t) i*group_info->rows*group_info->extent;
+    switch (group_info->compression)
+    {
+#if defined(MAGICKCORE_BZLIB_DELEGATE)
+      case BZipCompression:
+      {
+        unsigned int
+          pixels_length;
+
+        pixels_length=(unsigned int) length;
+        if ((BZ2_bzBuffToBuffDecompress((char *) pixels,&pixels_length,
+              (char *) group_info->groups[group],(unsigned int)
+              group_info->lengths[group],0,0) != BZ_OK) ||
+            (pixels_length != length))
+          status=MagickFalse;
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_LZMA_DELEGATE)
+      case LZMACompression:
+      {
+        size_t
+          in_position,
+          out_position;
+
+        uint64_t
+          memory_limit;
+
+        in_position=0;
+        out_position=0;
+        memory_limit=UINT64_MAX;
+        if ((lzma_stream_buffer_decode(&memory_limit,0,(const lzma_allocator *)
+              NULL,group_info->groups[group],&in_position,
+              group_info->lengths[group],pixels,&out_position,length) !=
+              LZMA_OK) || (out_position != length))
+          status=MagickFalse;
+        break;
+      }
+#endif
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+      case LZWCompression:
+      case ZipCompression:
+      {
+        uLongf
+          pixels_length;
+
+        pixels_length=(uLongf) length;
+        if ((uncompress(pixels,&pixels_length,group_info->groups[group],
+              (uLong) group_info->lengths[group]) != Z_OK) ||
+            (pixels_length != length))
+          status=MagickFalse;
+        break;
+      }
+#endif
+      default:
+      {
+        status=MagickFalse;
+        break;
+      }
+    }
+    group_info->groups[group]=(unsigned char *) RelinquishMagickMemory(
+      group_info->groups[group]);
+  }
+  return(status);
+}
+
 static Image *ReadMIFFImage(const ImageInfo *image_info,
   ExceptionInfo *exception)
 {
-#define BZipMaxExtent(x)  ((x)+((x)/100)+600)
-#define LZMAMaxExtent(x)  ((x)+((x)/3)+128)
 #define ThrowMIFFException(exception,message) \
 { \
   if (quantum_info != (QuantumInfo *) NULL) \
     quantum_info=DestroyQuantumInfo(quantum_info); \
   if (compress_pixels != (unsigned char *) NULL) \
     compress_pixels=(unsigned char *) RelinquishMagickMemory(compress_pixels); \
+  if (group_info != (MIFFRowGroupInfo *) NULL) \
+    group_info=DestroyMIFFRowGroupInfo(group_info); \
   ThrowReaderException((exception),(message)); \
 }
-#define ZipMaxExtent(x)  ((x)+(((x)+7) >> 3)+(((x)+63) >> 6)+11)
 
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
   bz_stream
@@ -426,6 +890,9 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
     keyword[MagickPathExtent],
     *options;
 
+  CompressionType
+    compression;
+
   double
     version;
 
@@ -453,6 +920,9 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
   MagickBooleanType
     status;
 
+  MIFFRowGroupInfo
+    *group_info;
+
   PixelInfo
     pixel;
 
@@ -473,7 +943,8 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
     compress_extent,
     extent,
     length,
-    packet_size;
+    packet_size,
+    row_group;
 
   ssize_t
     count,
@@ -515,6 +986,7 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
     ThrowReaderException(CorruptImageError,"ImproperImageHeader");
   *id='\0';
   compress_pixels=(unsigned char *) NULL;
+  group_info=(MIFFRowGroupInfo *) NULL;
   quantum_info=(QuantumInfo *) NULL;
   (void) memset(keyword,0,sizeof(keyword));
   version=0.0;
@@ -530,6 +1002,7 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
     quantum_format=UndefinedQuantumFormat;
     profiles=(LinkedListInfo *) NULL;
     colors=0;
+    row_group=0;
     image->depth=8UL;
     image->compression=NoCompression;
     while ((isgraph((int) ((unsigned char) c)) != 0) && (c != (int) ':'))
@@ -1012,6 +1485,11 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
                       image->resolution.y=image->resolution.x;
                     break;
                   }
+                if (LocaleCompare(keyword,"row-group") == 0)
+                  {
+                    row_group=StringToUnsignedLong(options);
+                    break;
+                  }
                 if (LocaleCompare(keyword,"rows") == 0)
                   {
                     image->rows=StringToUnsignedLong(options);
@@ -1362,6 +1840,40 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
       sizeof(*compress_pixels));
     if (compress_pixels == (unsigned char *) NULL)
       ThrowMIFFException(ResourceLimitError,"MemoryAllocationFailed");
+    compression=image->compression;
+    if (row_group != 0)
+      {
+        /*
+          Pixels are stored as independently compressed row groups preceded
+          by an index of their compressed lengths.
+        */
+        switch (image->compression)
+        {
+#if defined(MAGICKCORE_BZLIB_DELEGATE)
+          case BZipCompression:
+#endif
+#if defined(MAGICKCORE_LZMA_DELEGATE)
+          case LZMACompression:
+#endif
+#if defined(MAGICKCORE_ZLIB_DELEGATE)
+          case LZWCompression:
+          case ZipCompression:
+#endif
+            break;
+          default:
+            ThrowMIFFException(CorruptImageError,"ImproperImageHeader");
+        }
+        group_info=AcquireMIFFRowGroupInfo(image,image->compression,row_group,
+          packet_size*image->columns);
+        if ((group_info == (MIFFRowGroupInfo *) NULL) ||
+            (group_info->rows != row_group))
+          ThrowMIFFException(ResourceLimitError,"MemoryAllocationFailed");
+        for (i=0; i < (ssize_t) group_info->number_groups; i++)
+          group_info->lengths[i]=(size_t) ReadBlobMSBLong(image);
+        if (EOFBlob(image) != MagickFalse)
+          ThrowMIFFException(CorruptImageError,"UnexpectedEndOfFile");
+        compression=NoCompression;
+      }
     /*
       Read image pixels.
     */
@@ -1399,7 +1911,7 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
 #if defined(MAGICKCORE_ZLIB_DELEGATE)
     (void) memset(&zip_info,0,sizeof(zip_info));
 #endif
-    switch (image->compression)
+    switch (compression)
     {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
       case BZipCompression:
@@ -1471,7 +1983,7 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
       if (q == (Quantum *) NULL)
         break;
       extent=0;
-      switch (image->compression)
+      switch (compression)
       {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
         case BZipCompression:
@@ -1644,6 +2156,27 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
           const void
             *stream;
 
+          if (group_info != (MIFFRowGroupInfo *) NULL)
+            {
+              size_t
+                batch_rows,
+                group;
+
+              batch_rows=group_info->batch*group_info->rows;
+              if (((size_t) y % batch_rows) == 0)
+                {
+                  group=(size_t) y/group_info->rows;
+                  if (ReadMIFFRowGroups(image,group_info,group,MagickMin(
+                        group_info->batch,group_info->number_groups-group)) ==
+                        MagickFalse)
+                    ThrowMIFFException(CorruptImageError,
+                      "UnableToReadImageData");
+                }
+              extent=ImportQuantumPixels(image,(CacheView *) NULL,quantum_info,
+                quantum_type,group_info->pixels+((size_t) y % batch_rows)*
+                group_info->extent,exception);
+              break;
+            }
           stream=ReadBlobStream(image,packet_size*image->columns,pixels,&count);
           if (count != (ssize_t) (packet_size*image->columns))
             ThrowMIFFException(CorruptImageError,"UnableToReadImageData");
@@ -1658,7 +2191,7 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
         break;
     }
     SetQuantumImageType(image,quantum_type);
-    switch (image->compression)
+    switch (compression)
     {
 #if defined(MAGICKCORE_BZLIB_DELEGATE)
       case BZipCompression:
@@ -1729,6 +2262,8 @@ static Image *ReadMIFFImage(const ImageInfo *image_info,
     }
     quantum_info=DestroyQuantumInfo(quantum_info);
     compress_pixels=(unsigned char *) RelinquishMagickMemory(compress_pixels);
+    if (group_info != (MIFFRowGroupInfo *) NULL)
+      group_info=DestroyMIFFRowGroupInfo(group_info);
     if (((y != (ssize_t) image->rows)) || (status == MagickFalse))
       {
         image=DestroyImageList(image);
@@ -2076,6 +2611,9 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
   MagickOffsetType
     scene;
 
+  MIFFRowGroupInfo
+    *group_info;
+
   PixelInfo
     pixel,
     target;
@@ -2205,6 +2743,26 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
         quantum_info=DestroyQuantumInfo(quantum_info);
         ThrowWriterException(ResourceLimitError,"MemoryAllocationFailed");
       }
+    group_info=(MIFFRowGroupInfo *) NULL;
+    value=GetImageOption(image_info,"miff:row-group");
+    if (value != (const char *) NULL)
+      switch (compression)
+      {
+        case BZipCompression:
+        case LZMACompression:
+        case LZWCompression:
+        case ZipCompression:
+        {
+          /*
+            Compress independent groups of rows concurrently.
+          */
+          group_info=AcquireMIFFRowGroupInfo(image,compression,
+            StringToUnsignedLong(value),packet_size*image->columns);
+          break;
+        }
+        default:
+          break;
+      }
     /*
       Write MIFF header.
     */
@@ -2258,6 +2816,12 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
           compression),(double) image->quality);
         (void) WriteBlobString(image,buffer);
       }
+    if (group_info != (MIFFRowGroupInfo *) NULL)
+      {
+        (void) FormatLocaleString(buffer,MagickPathExtent,"row-group=%.17g\n",
+          (double) group_info->rows);
+        (void) WriteBlobString(image,buffer);
+      }
     if (image->units != UndefinedResolution)
       {
         (void) FormatLocaleString(buffer,MagickPathExtent,"units=%s\n",
@@ -2500,6 +3064,8 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
           colormap_size*sizeof(*colormap));
         if (colormap == (unsigned char *) NULL)
           {
+            if (group_info != (MIFFRowGroupInfo *) NULL)
+              group_info=DestroyMIFFRowGroupInfo(group_info);
             quantum_info=DestroyQuantumInfo(quantum_info);
             ThrowWriterException(ResourceLimitError,"MemoryAllocationFailed");
           }
@@ -2568,6 +3134,8 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
     /*
       Write image pixels to file.
     */
+    if (group_info != (MIFFRowGroupInfo *) NULL)
+      compression=NoCompression;
     status=MagickTrue;
     switch (compression)
     {
@@ -2627,6 +3195,9 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
       default:
         break;
     }
+    if ((group_info != (MIFFRowGroupInfo *) NULL) &&
+        (StartMIFFRowGroups(image,group_info) == MagickFalse))
+      status=MagickFalse;
     quantum_type=GetQuantumType(image,exception);
     pixels=(unsigned char *) GetQuantumPixels(quantum_info);
     for (y=0; y < (ssize_t) image->rows; y++)
@@ -2759,6 +3330,36 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
         }
         default:
         {
+          if (group_info != (MIFFRowGroupInfo *) NULL)
+            {
+              size_t
+                batch_rows,
+                group,
+                number_groups;
+
+              batch_rows=group_info->batch*group_info->rows;
+              (void) ExportQuantumPixels(image,(CacheView *) NULL,quantum_info,
+                quantum_type,group_info->pixels+((size_t) y % batch_rows)*
+                group_info->extent,exception);
+              length=0;
+              count=0;
+              if (((((size_t) y+1) % batch_rows) == 0) ||
+                  (y == ((ssize_t) image->rows-1)))
+                {
+                  group=((size_t) y/batch_rows)*group_info->batch;
+                  number_groups=MagickMin(group_info->batch,
+                    group_info->number_groups-group);
+                  if (CompressMIFFRowGroups(image,group_info,group,
+                        number_groups) == MagickFalse)
+                    count=(-1);
+                  else
+                    if ((group_info->offset >= 0) &&
+                        (WriteMIFFRowGroups(image,group_info,group,
+                          number_groups) == MagickFalse))
+                      count=(-1);
+                }
+              break;
+            }
           (void) ExportQuantumPixels(image,(CacheView *) NULL,quantum_info,
             quantum_type,pixels,exception);
           length=packet_size*image->columns;
@@ -2868,6 +3469,13 @@ static MagickBooleanType WriteMIFFImage(const ImageInfo *image_info,
       default:
         break;
     }
+    if (group_info != (MIFFRowGroupInfo *) NULL)
+      {
+        if ((status != MagickFalse) &&
+            (FinishMIFFRowGroups(image,group_info) == MagickFalse))
+          status=MagickFalse;
+        group_info=DestroyMIFFRowGroupInfo(group_info);
+      }
     quantum_info=DestroyQuantumInfo(quantum_info);
     compress_pixels=(unsigned char *) RelinquishMagickMemory(compress_pixels);
     if (GetNextImageInList(image) == (Image *) NULL)
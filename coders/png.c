@@ -83,6 +83,7 @@
 #include "MagickCore/statistic.h"
 #include "MagickCore/string_.h"
 #include "MagickCore/string-private.h"
+#include "MagickCore/thread-private.h"
 #include "MagickCore/timer-private.h"
 #include "MagickCore/transform.h"
 #include "MagickCore/utility.h"
@@ -7996,6 +7997,387 @@ static void Magick_png_set_text(png_struct *ping,png_info *ping_info,
   png_free(ping,text);
 }
 
+/*
+  Parallel deflate support ("-define png:parallel-deflate=true").
+
+  The filtered scanlines are split into blocks that are deflated
+  concurrently, as pigz does.  Each block is primed with the last 32K of
+  the data that precedes it and, except for the last one, ends with a sync
+  flush so the blocks concatenate into a single valid zlib stream.  The
+  Adler-32 checksums of the blocks are combined into that of the stream.
+*/
+#define PNGDeflateBlockSize  131072
+#define PNGDeflateWindowSize  32768
+
+static inline size_t GetPNGFilterCost(const unsigned char *magick_restrict p,
+  const size_t length)
+{
+  size_t
+    cost;
+
+  ssize_t
+    i;
+
+  /*
+    The libpng heuristic: the sum of the filtered bytes taken as signed.
+  */
+  cost=0;
+  for (i=0; i < (ssize_t) length; i++)
+    cost+=(size_t) (p[i] < 128 ? p[i] : 256-p[i]);
+  return(cost);
+}
+
+static void FilterPNGRow(const unsigned char *magick_restrict row,
+  const unsigned char *magick_restrict previous,const size_t rowbytes,
+  const size_t bpp,const int filter,unsigned char *magick_restrict filtered)
+{
+  ssize_t
+    i;
+
+  *filtered++=(unsigned char) filter;
+  for (i=0; i < (ssize_t) rowbytes; i++)
+  {
+    int
+      a,
+      b,
+      c;
+
+    a=i >= (ssize_t) bpp ? (int) row[i-(ssize_t) bpp] : 0;
+    b=previous != (const unsigned char *) NULL ? (int) previous[i] : 0;
+    c=(i >= (ssize_t) bpp) && (previous != (const unsigned char *) NULL) ?
+      (int) previous[i-(ssize_t) bpp] : 0;
+    switch (filter)
+    {
+      case PNG_FILTER_VALUE_SUB: filtered[i]=(unsigned char) (row[i]-a); break;
+      case PNG_FILTER_VALUE_UP: filtered[i]=(unsigned char) (row[i]-b); break;
+      case PNG_FILTER_VALUE_AVG:
+      {
+        filtered[i]=(unsigned char) (row[i]-((a+b) >> 1));
+        break;
+      }
+      case PNG_FILTER_VALUE_PAETH:
+      {
+        int
+          pa,
+          pb,
+          pc,
+          predictor;
+
+        pa=abs(b-c);
+        pb=abs(a-c);
+        pc=abs(a+b-2*c);
+        predictor=c;
+        if ((pa <= pb) && (pa <= pc))
+          predictor=a;
+        else
+          if (pb <= pc)
+            predictor=b;
+        filtered[i]=(unsigned char) (row[i]-predictor);
+        break;
+      }
+      default: filtered[i]=row[i]; break;
+    }
+  }
+}
+
+static MagickBooleanType WritePNGParallelIDAT(Image *image,
+  const unsigned char *pixels,const size_t rows,const size_t rowbytes,
+  const size_t bpp,const size_t chunk_size,const int filters,const int level,
+  const int strategy,const MagickBooleanType logging)
+{
+  int
+    mask,
+    window_bits,
+    zlib_strategy;
+
+  MagickBooleanType
+    status;
+
+  MemoryInfo
+    *filtered_info;
+
+  size_t
+    block_offset,
+    *compressed_length,
+    extent,
+    number_blocks,
+    number_threads,
+    rows_per_block,
+    total_length;
+
+  ssize_t
+    i,
+    y;
+
+  uLong
+    adler,
+    *block_adler;
+
+  unsigned char
+    **compressed,
+    *filtered,
+    *scratch;
+
+  /*
+    Filter the scanlines; each one only depends on its unfiltered neighbor.
+    Filters is the PNG_FILTER_* mask given to png_set_filter(); filters that
+    need a previous row or pixel are dropped when there is none.
+  */
+  mask=filters;
+  if (rows == 1)
+    mask&=(~(PNG_FILTER_UP | PNG_FILTER_AVG | PNG_FILTER_PAETH));
+  if (rowbytes <= bpp)
+    mask&=(~(PNG_FILTER_SUB | PNG_FILTER_AVG | PNG_FILTER_PAETH));
+  if ((mask & PNG_ALL_FILTERS) == 0)
+    mask=PNG_FILTER_NONE;
+  zlib_strategy=strategy;
+  if (zlib_strategy < 0)
+    zlib_strategy=mask == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED;
+  extent=rowbytes+1;
+  /*
+    Like libpng, shrink the deflate window for small images.
+  */
+  window_bits=MAX_WBITS;
+  if ((rows*extent) <= 16384)
+    while (((rows*extent)+262) <= ((size_t) 1 << (window_bits-1)))
+      window_bits--;
+  filtered_info=AcquireVirtualMemory(rows,extent*sizeof(*filtered));
+  if (filtered_info == (MemoryInfo *) NULL)
+    return(MagickFalse);
+  filtered=(unsigned char *) GetVirtualMemoryBlob(filtered_info);
+  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
+  scratch=(unsigned char *) AcquireQuantumMemory(number_threads,extent*
+    sizeof(*scratch));
+  if (scratch == (unsigned char *) NULL)
+    {
+      filtered_info=RelinquishVirtualMemory(filtered_info);
+      return(MagickFalse);
+    }
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static) \
+    magick_number_threads(image,image,rows,1)
+#endif
+  for (y=0; y < (ssize_t) rows; y++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    const unsigned char
+      *previous,
+      *row;
+
+    int
+      filter;
+
+    size_t
+      cost,
+      minimum_cost;
+
+    unsigned char
+      *q;
+
+    row=pixels+y*(ssize_t) rowbytes;
+    previous=y > 0 ? row-rowbytes : (const unsigned char *) NULL;
+    q=filtered+y*(ssize_t) extent;
+    if ((mask & (mask-1)) == 0)
+      {
+        filter=0;
+        while ((PNG_FILTER_NONE << filter) != mask)
+          filter++;
+        FilterPNGRow(row,previous,rowbytes,bpp,filter,q);
+        continue;
+      }
+    minimum_cost=(~(size_t) 0);
+    for (filter=PNG_FILTER_VALUE_NONE; filter < PNG_FILTER_VALUE_LAST; filter++)
+    {
+      if ((mask & (PNG_FILTER_NONE << filter)) == 0)
+        continue;
+      FilterPNGRow(row,previous,rowbytes,bpp,filter,scratch+id*(ssize_t)
+        extent);
+      cost=GetPNGFilterCost(scratch+id*(ssize_t) extent+1,rowbytes);
+      if (cost < minimum_cost)
+        {
+          minimum_cost=cost;
+          (void) memcpy(q,scratch+id*(ssize_t) extent,extent);
+        }
+    }
+  }
+  scratch=(unsigned char *) RelinquishMagickMemory(scratch);
+  /*
+    Deflate the blocks concurrently.
+  */
+  rows_per_block=MagickMax(PNGDeflateBlockSize/extent,1);
+  number_blocks=(rows+rows_per_block-1)/rows_per_block;
+  compressed=(unsigned char **) AcquireQuantumMemory(number_blocks,
+    sizeof(*compressed));
+  compressed_length=(size_t *) AcquireQuantumMemory(number_blocks,
+    sizeof(*compressed_length));
+  block_adler=(uLong *) AcquireQuantumMemory(number_blocks,
+    sizeof(*block_adler));
+  if ((compressed == (unsigned char **) NULL) ||
+      (compressed_length == (size_t *) NULL) ||
+      (block_adler == (uLong *) NULL))
+    {
+      if (block_adler != (uLong *) NULL)
+        block_adler=(uLong *) RelinquishMagickMemory(block_adler);
+      if (compressed_length != (size_t *) NULL)
+        compressed_length=(size_t *) RelinquishMagickMemory(compressed_length);
+      if (compressed != (unsigned char **) NULL)
+        compressed=(unsigned char **) RelinquishMagickMemory(compressed);
+      filtered_info=RelinquishVirtualMemory(filtered_info);
+      return(MagickFalse);
+    }
+  (void) memset(compressed,0,number_blocks*sizeof(*compressed));
+  status=MagickTrue;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(dynamic) shared(status) \
+    magick_number_threads(image,image,number_blocks,1)
+#endif
+  for (i=0; i < (ssize_t) number_blocks; i++)
+  {
+    int
+      code;
+
+    size_t
+      length,
+      offset;
+
+    z_stream
+      stream;
+
+    if (status == MagickFalse)
+      continue;
+    offset=(size_t) i*rows_per_block*extent;
+    length=MagickMin(rows_per_block*extent,rows*extent-offset);
+    block_adler[i]=adler32(adler32(0L,Z_NULL,0),filtered+offset,(uInt)
+      length);
+    (void) memset(&stream,0,sizeof(stream));
+    if (deflateInit2(&stream,level,Z_DEFLATED,-window_bits,9,zlib_strategy) !=
+        Z_OK)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    if (i > 0)
+      {
+        size_t
+          window;
+
+        window=MagickMin(offset,PNGDeflateWindowSize);
+        (void) deflateSetDictionary(&stream,filtered+offset-window,(uInt)
+          window);
+      }
+    /*
+      Leave room for the zlib header and the trailing checksum.
+    */
+    compressed[i]=(unsigned char *) AcquireQuantumMemory(deflateBound(&stream,
+      (uLong) length)+16,sizeof(**compressed));
+    if (compressed[i] == (unsigned char *) NULL)
+      {
+        (void) deflateEnd(&stream);
+        status=MagickFalse;
+        continue;
+      }
+    stream.next_in=filtered+offset;
+    stream.avail_in=(uInt) length;
+    stream.next_out=compressed[i]+2;
+    stream.avail_out=(uInt) deflateBound(&stream,(uLong) length)+10;
+    code=deflate(&stream,i == (ssize_t) (number_blocks-1) ? Z_FINISH :
+      Z_SYNC_FLUSH);
+    if ((stream.avail_in != 0) || (stream.avail_out == 0) ||
+        ((code != Z_OK) && (code != Z_STREAM_END)))
+      status=MagickFalse;
+    compressed_length[i]=(size_t) stream.total_out;
+    (void) deflateEnd(&stream);
+  }
+  filtered_info=RelinquishVirtualMemory(filtered_info);
+  if (status != MagickFalse)
+    {
+      int
+        cinfo,
+        flevel;
+
+      unsigned char
+        chunk[4];
+
+      /*
+        Prepend the zlib header, append the combined Adler-32, and emit the
+        IDAT chunks.
+      */
+      flevel=zlib_strategy >= Z_HUFFMAN_ONLY ? 0 : level < 0 ? 2 : level < 2 ?
+        0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+      cinfo=window_bits-8;
+      while ((cinfo > 0) && ((rows*extent) <= ((size_t) 1 << (cinfo+7))))
+        cinfo--;
+      compressed[0][0]=(unsigned char) ((cinfo << 4) | Z_DEFLATED);
+      compressed[0][1]=(unsigned char) (flevel << 6);
+      compressed[0][1]+=(unsigned char) (31-((compressed[0][0] << 8)+
+        compressed[0][1]) % 31);
+      adler=block_adler[0];
+      for (i=1; i < (ssize_t) number_blocks; i++)
+        adler=adler32_combine(adler,block_adler[i],(z_off_t) MagickMin(
+          rows_per_block*extent,rows*extent-(size_t) i*rows_per_block*extent));
+      PNGLong(compressed[number_blocks-1]+2+
+        compressed_length[number_blocks-1],(png_uint_32) adler);
+      compressed_length[number_blocks-1]+=4;
+      compressed_length[0]+=2;
+      total_length=0;
+      for (i=0; i < (ssize_t) number_blocks; i++)
+        total_length+=compressed_length[i];
+      /*
+        Split the stream into IDAT chunks of the libpng compression buffer
+        size, as png_write_row() does.
+      */
+      PNGType(chunk,mng_IDAT);
+      i=0;
+      block_offset=0;
+      while (total_length != 0)
+      {
+        size_t
+          length,
+          remaining;
+
+        uLong
+          crc;
+
+        length=MagickMin(total_length,chunk_size);
+        LogPNGChunk(logging,mng_IDAT,length);
+        (void) WriteBlobMSBULong(image,(unsigned int) length);
+        (void) WriteBlob(image,4,chunk);
+        crc=crc32(0,chunk,4);
+        for (remaining=length; remaining != 0; )
+        {
+          size_t
+            count;
+
+          unsigned char
+            *p;
+
+          p=compressed[i]+(i == 0 ? 0 : 2)+block_offset;
+          count=MagickMin(remaining,compressed_length[i]-block_offset);
+          (void) WriteBlob(image,count,p);
+          crc=crc32(crc,p,(uInt) count);
+          remaining-=count;
+          block_offset+=count;
+          if (block_offset == compressed_length[i])
+            {
+              i++;
+              block_offset=0;
+            }
+        }
+        (void) WriteBlobMSBULong(image,(unsigned int) crc);
+        total_length-=length;
+      }
+    }
+  for (i=0; i < (ssize_t) number_blocks; i++)
+    if (compressed[i] != (unsigned char *) NULL)
+      compressed[i]=(unsigned char *) RelinquishMagickMemory(compressed[i]);
+  block_adler=(uLong *) RelinquishMagickMemory(block_adler);
+  compressed_length=(size_t *) RelinquishMagickMemory(compressed_length);
+  compressed=(unsigned char **) RelinquishMagickMemory(compressed);
+  return(status);
+}
+
 /* Write one PNG image */
 static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
   const ImageInfo *IMimage_info,Image *IMimage,ExceptionInfo *exception)
@@ -8075,6 +8457,7 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
     ping_have_blob;
 
   MemoryInfo
+    *volatile deflate_info,
     *volatile pixel_info;
 
   QuantumInfo
@@ -8088,6 +8471,7 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
     x;
 
   unsigned char
+    *deflate_pixels,
     *ping_pixels;
 
   volatile int
@@ -8114,6 +8498,7 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
     number_opaque,
     number_semitransparent,
     number_transparent,
+    ping_filters,
     ping_pHYs_unit_type;
 
   png_uint_32
@@ -9408,6 +9793,7 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
     }
 
   png_set_write_fn(ping,image,png_put_data,png_flush_data);
+  deflate_info=(MemoryInfo *) NULL;
   pixel_info=(MemoryInfo *) NULL;
 
   if (setjmp(png_jmpbuf(ping)))
@@ -9420,6 +9806,9 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
       UnlockSemaphoreInfo(ping_semaphore);
 #endif
 
+      if (deflate_info != (MemoryInfo *) NULL)
+        deflate_info=RelinquishVirtualMemory(deflate_info);
+
       if (pixel_info != (MemoryInfo *) NULL)
         pixel_info=RelinquishVirtualMemory(pixel_info);
 
@@ -10395,18 +10784,19 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
   if (mng_info->compression_level != 0)
     png_set_compression_level(ping,(int) mng_info->compression_level-1);
 
+  ping_filters=(-1);
   if (mng_info->compression_filter == 6)
     {
       if (((int) ping_color_type == PNG_COLOR_TYPE_GRAY) ||
          ((int) ping_color_type == PNG_COLOR_TYPE_PALETTE) ||
          (quality < 50))
-        png_set_filter(ping,PNG_FILTER_TYPE_BASE,PNG_NO_FILTERS);
+        ping_filters=PNG_FILTER_NONE;
       else
-        png_set_filter(ping,PNG_FILTER_TYPE_BASE,PNG_ALL_FILTERS);
+        ping_filters=PNG_ALL_FILTERS;
      }
   else if (mng_info->compression_filter == 7 ||
       mng_info->compression_filter == 10)
-    png_set_filter(ping,PNG_FILTER_TYPE_BASE,PNG_ALL_FILTERS);
+    ping_filters=PNG_ALL_FILTERS;
 
   else if (mng_info->compression_filter == 8)
     {
@@ -10418,15 +10808,25 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
         ping_filter_method=PNG_INTRAPIXEL_DIFFERENCING;
       }
 #endif
-      png_set_filter(ping,PNG_FILTER_TYPE_BASE,PNG_NO_FILTERS);
+      ping_filters=PNG_FILTER_NONE;
     }
 
   else if (mng_info->compression_filter == 9)
-    png_set_filter(ping,PNG_FILTER_TYPE_BASE,PNG_NO_FILTERS);
+    ping_filters=PNG_FILTER_NONE;
 
   else if (mng_info->compression_filter != 0)
-    png_set_filter(ping,PNG_FILTER_TYPE_BASE,
-       (int) mng_info->compression_filter-1);
+    ping_filters=(int) mng_info->compression_filter-1;
+
+  /*
+    Hand libpng a mask: with libpng 1.6 a bare filter value passed to
+    png_set_filter() does not select that filter.  0 leaves the adaptive
+    default in place and 1 to 4 write neither their own filter nor none.
+  */
+  if ((ping_filters >= 0) && (ping_filters < PNG_FILTER_VALUE_LAST))
+    ping_filters=PNG_FILTER_NONE << ping_filters;
+
+  if (ping_filters >= 0)
+    png_set_filter(ping,PNG_FILTER_TYPE_BASE,ping_filters);
 
   if (mng_info->compression_strategy != 0)
     png_set_compression_strategy(ping,
@@ -11015,6 +11415,22 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
   (void) SetQuantumDepth(image,quantum_info,image_depth);
   (void) SetQuantumEndian(image,quantum_info,MSBEndian);
   num_passes=png_set_interlace_handling(ping);
+  /*
+    With png:parallel-deflate, gather the scanlines and compress them
+    ourselves; the scanlines must not need any libpng transformation.
+  */
+  deflate_pixels=(unsigned char *) NULL;
+  value=GetImageOption(image_info,"png:parallel-deflate");
+  if (value == (char *) NULL)
+    value=GetImageArtifact(image,"png:parallel-deflate");
+  if ((IsStringTrue(value) != MagickFalse) && (num_passes == 1) &&
+      (ping_bit_depth >= 8) && (ping_filter_method == 0) && (ping_filters >= 0))
+    {
+      deflate_info=AcquireVirtualMemory(image->rows,png_get_rowbytes(ping,
+        ping_info));
+      if (deflate_info != (MemoryInfo *) NULL)
+        deflate_pixels=(unsigned char *) GetVirtualMemoryBlob(deflate_info);
+    }
 
   if ((mng_info->colortype-1 == PNG_COLOR_TYPE_PALETTE) ||
       ((mng_info->write_png8 == MagickFalse) &&
@@ -11069,7 +11485,11 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
             (void) LogMagickEvent(CoderEvent,GetMagickModule(),
                 "    Writing row of pixels (1)");
 
-          png_write_row(ping,ping_pixels);
+          if (deflate_pixels == (unsigned char *) NULL)
+            png_write_row(ping,ping_pixels);
+          else
+            (void) memcpy(deflate_pixels+y*(ssize_t) png_get_rowbytes(ping,
+              ping_info),ping_pixels,png_get_rowbytes(ping,ping_info));
 
           status=SetImageProgress(image,SaveImageTag,
               (MagickOffsetType) (pass * (ssize_t) image->rows + y),
@@ -11133,7 +11553,11 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
               (void) LogMagickEvent(CoderEvent,GetMagickModule(),
                   "    Writing row of pixels (2)");
 
-            png_write_row(ping,ping_pixels);
+            if (deflate_pixels == (unsigned char *) NULL)
+              png_write_row(ping,ping_pixels);
+            else
+              (void) memcpy(deflate_pixels+y*(ssize_t) png_get_rowbytes(ping,
+                ping_info),ping_pixels,png_get_rowbytes(ping,ping_info));
 
             status=SetImageProgress(image,SaveImageTag,
               (MagickOffsetType) (pass * (ssize_t) image->rows + y),
@@ -11200,7 +11624,11 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
                   (void) LogMagickEvent(CoderEvent,GetMagickModule(),
                       "    Writing row of pixels (3)");
 
-                png_write_row(ping,ping_pixels);
+                if (deflate_pixels == (unsigned char *) NULL)
+                  png_write_row(ping,ping_pixels);
+                else
+                  (void) memcpy(deflate_pixels+y*(ssize_t) png_get_rowbytes(ping,
+                    ping_info),ping_pixels,png_get_rowbytes(ping,ping_info));
 
                 status=SetImageProgress(image,SaveImageTag,
                   (MagickOffsetType) (pass * (ssize_t) image->rows + y),
@@ -11275,7 +11703,11 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
                           (int)ping_pixels[0],(int)ping_pixels[1]);
                     }
                   }
-                png_write_row(ping,ping_pixels);
+                if (deflate_pixels == (unsigned char *) NULL)
+                  png_write_row(ping,ping_pixels);
+                else
+                  (void) memcpy(deflate_pixels+y*(ssize_t) png_get_rowbytes(ping,
+                    ping_info),ping_pixels,png_get_rowbytes(ping,ping_info));
 
                 status=SetImageProgress(image,SaveImageTag,
                   (MagickOffsetType) pass * (ssize_t) image->rows + y,
@@ -11329,7 +11761,39 @@ static MagickBooleanType WriteOnePNGImage(MngWriteInfo *mng_info,
     (void) LogMagickEvent(CoderEvent,GetMagickModule(),
       "  Writing PNG end info");
 
-  png_write_end(ping,ping_info);
+  if ((deflate_pixels != (unsigned char *) NULL) &&
+      (WritePNGParallelIDAT(image,deflate_pixels,image->rows,
+       png_get_rowbytes(ping,ping_info),(size_t) MagickMax(
+       png_get_channels(ping,ping_info)*ping_bit_depth/8,1),(size_t)
+       png_get_compression_buffer_size(ping),ping_filters,mng_info->compression_level != 0 ?
+       (int) mng_info->compression_level-1 : Z_DEFAULT_COMPRESSION,
+       (int) mng_info->compression_strategy-1,logging) != MagickFalse))
+    {
+      unsigned char
+        chunk[4];
+
+      /*
+        libpng did not see the IDAT chunks and png_write_end() refuses to run
+        without them, so write IEND ourselves.  Nothing is left pending for
+        it: the text, tIME and eXIf chunks are all set before png_write_info()
+        writes them, and no unknown chunks are queued to follow IDAT.
+      */
+      (void) WriteBlobMSBULong(image,0L);
+      PNGType(chunk,mng_IEND);
+      LogPNGChunk(logging,mng_IEND,0L);
+      (void) WriteBlob(image,4,chunk);
+      (void) WriteBlobMSBULong(image,crc32(0,chunk,4));
+    }
+  else
+    {
+      if (deflate_pixels != (unsigned char *) NULL)
+        for (y=0; y < (ssize_t) image->rows; y++)
+          png_write_row(ping,deflate_pixels+y*(ssize_t) png_get_rowbytes(ping,
+            ping_info));
+      png_write_end(ping,ping_info);
+    }
+  if (deflate_info != (MemoryInfo *) NULL)
+    deflate_info=RelinquishVirtualMemory(deflate_info);
 
   if (mng_info->need_fram != MagickFalse &&
       (int) image->dispose == BackgroundDispose)
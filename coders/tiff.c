@@ -143,6 +143,28 @@ typedef struct _PhotoshopProfile
     extent,
     quantum;
 } PhotoshopProfile;
+
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+typedef struct _TIFFDecoderInfo
+{
+  TIFF
+    **decoders;
+
+  size_t
+    number_decoders,
+    number_striles;
+
+  tmsize_t
+    *lengths,
+    *offsets;
+
+  unsigned char
+    *chunks;
+
+  size_t
+    extent;
+} TIFFDecoderInfo;
+#endif
 
 /*
   Global declarations.
@@ -545,6 +567,14 @@ static int TIFFCloseBlob(thandle_t image)
   return(0);
 }
 
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+static int TIFFCloseDecoderBlob(thandle_t magick_unused(image))
+{
+  magick_unreferenced(image);
+  return(0);
+}
+#endif
+
 static void TIFFErrors(const char *,const char *,va_list)
   magick_attribute((__format__ (__printf__,2,0)));
 
@@ -1138,6 +1168,225 @@ static void TIFFReadPhotoshopLayers(const ImageInfo *image_info,Image *image,
 }
 #endif
 
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+static TIFFDecoderInfo *DestroyTIFFDecoderInfo(TIFFDecoderInfo *decoder_info)
+{
+  ssize_t
+    i;
+
+  if (decoder_info->decoders != (TIFF **) NULL)
+    {
+      for (i=0; i < (ssize_t) decoder_info->number_decoders; i++)
+        if (decoder_info->decoders[i] != (TIFF *) NULL)
+          TIFFClose(decoder_info->decoders[i]);
+      decoder_info->decoders=(TIFF **) RelinquishMagickMemory(
+        decoder_info->decoders);
+    }
+  if (decoder_info->chunks != (unsigned char *) NULL)
+    decoder_info->chunks=(unsigned char *) RelinquishMagickMemory(
+      decoder_info->chunks);
+  if (decoder_info->offsets != (tmsize_t *) NULL)
+    decoder_info->offsets=(tmsize_t *) RelinquishMagickMemory(
+      decoder_info->offsets);
+  if (decoder_info->lengths != (tmsize_t *) NULL)
+    decoder_info->lengths=(tmsize_t *) RelinquishMagickMemory(
+      decoder_info->lengths);
+  decoder_info=(TIFFDecoderInfo *) RelinquishMagickMemory(decoder_info);
+  return(decoder_info);
+}
+
+static TIFFDecoderInfo *AcquireTIFFDecoderInfo(Image *image,TIFF *tiff,
+  const size_t number_striles)
+{
+  size_t
+    number_decoders;
+
+  ssize_t
+    i;
+
+  tdir_t
+    directory;
+
+  TIFFDecoderInfo
+    *decoder_info;
+
+  /*
+    Open a private libtiff handle on the current directory for each thread.
+    The handles share the blob with the primary handle but only read from it
+    while they are opened; afterwards they decode from memory exclusively.
+  */
+  number_decoders=(size_t) GetMagickResourceLimit(ThreadResource);
+  if ((number_decoders < 2) || (number_striles < 2))
+    return((TIFFDecoderInfo *) NULL);
+  decoder_info=(TIFFDecoderInfo *) AcquireMagickMemory(sizeof(*decoder_info));
+  if (decoder_info == (TIFFDecoderInfo *) NULL)
+    return((TIFFDecoderInfo *) NULL);
+  (void) memset(decoder_info,0,sizeof(*decoder_info));
+  decoder_info->number_decoders=number_decoders;
+  decoder_info->number_striles=number_striles;
+  decoder_info->decoders=(TIFF **) AcquireQuantumMemory(number_decoders,
+    sizeof(*decoder_info->decoders));
+  decoder_info->offsets=(tmsize_t *) AcquireQuantumMemory(number_striles,
+    sizeof(*decoder_info->offsets));
+  decoder_info->lengths=(tmsize_t *) AcquireQuantumMemory(number_striles,
+    sizeof(*decoder_info->lengths));
+  if ((decoder_info->decoders == (TIFF **) NULL) ||
+      (decoder_info->offsets == (tmsize_t *) NULL) ||
+      (decoder_info->lengths == (tmsize_t *) NULL))
+    return(DestroyTIFFDecoderInfo(decoder_info));
+  (void) memset(decoder_info->decoders,0,number_decoders*
+    sizeof(*decoder_info->decoders));
+  directory=TIFFCurrentDirectory(tiff);
+  for (i=0; i < (ssize_t) number_decoders; i++)
+  {
+    decoder_info->decoders[i]=TIFFClientOpen(image->filename,"rb",
+      (thandle_t) image,TIFFReadBlob,TIFFWriteBlob,TIFFSeekBlob,
+      TIFFCloseDecoderBlob,TIFFGetBlobSize,TIFFMapBlob,TIFFUnmapBlob);
+    if (decoder_info->decoders[i] == (TIFF *) NULL)
+      return(DestroyTIFFDecoderInfo(decoder_info));
+    if (TIFFSetDirectory(decoder_info->decoders[i],directory) == 0)
+      return(DestroyTIFFDecoderInfo(decoder_info));
+  }
+  return(decoder_info);
+}
+
+static MagickBooleanType DecodeTIFFStriles(TIFFDecoderInfo *decoder_info,
+  TIFF *tiff,const uint32 strile,const size_t number_striles,
+  unsigned char *pixels,const size_t extent,ExceptionInfo *exception)
+{
+  int
+    tiled;
+
+  MagickBooleanType
+    status;
+
+  size_t
+    length;
+
+  ssize_t
+    i;
+
+  tmsize_t
+    strip_size,
+    tile_size;
+
+  uint32
+    image_rows,
+    rows_per_strip,
+    strips_per_plane;
+
+  /*
+    Read the compressed strips or tiles serially, in file order, then
+    decompress them concurrently, each thread with its own libtiff handle.
+  */
+  if ((number_striles == 0) || (number_striles > decoder_info->number_striles))
+    return(MagickFalse);
+  length=0;
+  for (i=0; i < (ssize_t) number_striles; i++)
+  {
+    uint64
+      count;
+
+    count=TIFFGetStrileByteCount(tiff,strile+(uint32) i);
+    if ((count == 0) || (count > (uint64) (MAGICK_SSIZE_MAX-length)))
+      return(MagickFalse);
+    decoder_info->offsets[i]=(tmsize_t) length;
+    decoder_info->lengths[i]=(tmsize_t) count;
+    length+=(size_t) count;
+  }
+  if (length > decoder_info->extent)
+    {
+      decoder_info->chunks=(unsigned char *) ResizeQuantumMemory(
+        decoder_info->chunks,length,sizeof(*decoder_info->chunks));
+      if (decoder_info->chunks == (unsigned char *) NULL)
+        {
+          decoder_info->extent=0;
+          return(MagickFalse);
+        }
+      decoder_info->extent=length;
+    }
+  tiled=TIFFIsTiled(tiff);
+  for (i=0; i < (ssize_t) number_striles; i++)
+  {
+    tmsize_t
+      count;
+
+    if (tiled != 0)
+      count=TIFFReadRawTile(tiff,strile+(uint32) i,decoder_info->chunks+
+        decoder_info->offsets[i],decoder_info->lengths[i]);
+    else
+      count=TIFFReadRawStrip(tiff,strile+(uint32) i,decoder_info->chunks+
+        decoder_info->offsets[i],decoder_info->lengths[i]);
+    if (count != decoder_info->lengths[i])
+      return(MagickFalse);
+  }
+  /*
+    The last strip of each plane may hold fewer rows than the others.
+  */
+  image_rows=0;
+  rows_per_strip=0;
+  strips_per_plane=1;
+  strip_size=0;
+  tile_size=0;
+  if (tiled != 0)
+    tile_size=TIFFTileSize(tiff);
+  else
+    {
+      (void) TIFFGetField(tiff,TIFFTAG_IMAGELENGTH,&image_rows);
+      (void) TIFFGetFieldDefaulted(tiff,TIFFTAG_ROWSPERSTRIP,&rows_per_strip);
+      if ((rows_per_strip == 0) || (rows_per_strip > image_rows))
+        rows_per_strip=image_rows;
+      if (rows_per_strip == 0)
+        return(MagickFalse);
+      strips_per_plane=(image_rows+rows_per_strip-1)/rows_per_strip;
+      strip_size=TIFFVStripSize(tiff,rows_per_strip);
+    }
+  status=MagickTrue;
+  #pragma omp parallel for schedule(dynamic) shared(status) \
+    num_threads((int) decoder_info->number_decoders)
+  for (i=0; i < (ssize_t) number_striles; i++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    ExceptionInfo
+      *thread_exception;
+
+    tmsize_t
+      size;
+
+    uint32
+      row;
+
+    if (status == MagickFalse)
+      continue;
+    /*
+      Route libtiff errors and warnings raised on this thread's handle, then
+      give the thread back whatever exception it routed to before.
+    */
+    thread_exception=(ExceptionInfo *) GetMagickThreadValue(tiff_exception);
+    (void) SetMagickThreadValue(tiff_exception,exception);
+    size=tile_size;
+    if (tiled == 0)
+      {
+        size=strip_size;
+        row=((strile+(uint32) i) % strips_per_plane)*rows_per_strip;
+        if ((row+rows_per_strip) > image_rows)
+          size=TIFFVStripSize(decoder_info->decoders[id],image_rows-row);
+      }
+    if ((size <= 0) || ((size_t) size > extent))
+      status=MagickFalse;
+    else
+      if (TIFFReadFromUserBuffer(decoder_info->decoders[id],strile+(uint32) i,
+            decoder_info->chunks+decoder_info->offsets[i],
+            decoder_info->lengths[i],pixels+(size_t) i*extent,size) == 0)
+        status=MagickFalse;
+    (void) SetMagickThreadValue(tiff_exception,thread_exception);
+  }
+  return(status);
+}
+#endif
+
 static Image *ReadTIFFImage(const ImageInfo *image_info,
   ExceptionInfo *exception)
 {
@@ -1906,6 +2155,7 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
             count,
             extent,
             length,
+            number_strips,
             stride,
             strip_size;
 
@@ -1916,6 +2166,16 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
             *p,
             *strip_pixels;
 
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          size_t
+            batch_index,
+            batch_remaining,
+            strips_per_plane;
+
+          TIFFDecoderInfo
+            *decoder_info;
+
+#endif
           /*
             Convert stripped TIFF image.
           */
@@ -1925,11 +2185,27 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
           if (HeapOverflowSanityCheckGetSize(rows_per_strip,MagickMax(stride,length),&count) != MagickFalse)
             ThrowTIFFException(ResourceLimitError,"MemoryAllocationFailed");
           extent=MagickMax(strip_size,count);
-          strip_pixels=(unsigned char *) AcquireQuantumMemory(extent,
+          number_strips=1;
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          strips_per_plane=(size_t) TIFFNumberOfStrips(tiff);
+          if ((interlace == PLANARCONFIG_SEPARATE) && (samples_per_pixel > 1))
+            strips_per_plane/=samples_per_pixel;
+          if (IsStringTrue(GetImageOption(image_info,"tiff:parallel-decode")) != MagickFalse)
+            number_strips=MagickMin(2*(size_t) GetMagickResourceLimit(
+              ThreadResource),strips_per_plane);
+          if (number_strips == 0)
+            number_strips=1;
+#endif
+          if (HeapOverflowSanityCheckGetSize(number_strips,extent,&count) != MagickFalse)
+            ThrowTIFFException(ResourceLimitError,"MemoryAllocationFailed");
+          strip_pixels=(unsigned char *) AcquireQuantumMemory(count,
             sizeof(*strip_pixels));
           if (strip_pixels == (unsigned char *) NULL)
             ThrowTIFFException(ResourceLimitError,"MemoryAllocationFailed");
-          (void) memset(strip_pixels,0,extent*sizeof(*strip_pixels));
+          (void) memset(strip_pixels,0,count*sizeof(*strip_pixels));
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          decoder_info=AcquireTIFFDecoderInfo(image,tiff,number_strips);
+#endif
           strip_id=0;
           p=strip_pixels;
           for (i=0; i < (ssize_t) samples_per_pixel; i++)
@@ -1981,6 +2257,10 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
                 break;
               }
             }
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+            batch_index=0;
+            batch_remaining=0;
+#endif
             rows_remaining=0;
             for (y=0; y < (ssize_t) image->rows; y++)
             {
@@ -1992,12 +2272,43 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
                 break;
               if (rows_remaining == 0)
                 {
-                  size=TIFFReadEncodedStrip(tiff,strip_id,strip_pixels,
-                    strip_size);
-                  if (size == -1)
-                    break;
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+                  if (decoder_info != (TIFFDecoderInfo *) NULL)
+                    {
+                      if (batch_remaining == 0)
+                        {
+                          /*
+                            Decode the next batch of strips of this plane.
+                          */
+                          batch_remaining=MagickMin(number_strips,
+                            strips_per_plane-(strip_id % strips_per_plane));
+                          if (DecodeTIFFStriles(decoder_info,tiff,strip_id,
+                                batch_remaining,strip_pixels,extent,
+                                exception) == MagickFalse)
+                            {
+                              (void) ThrowMagickException(exception,
+                                GetMagickModule(),CorruptImageError,
+                                "UnableToReadImageData","`%s'",
+                                image->filename);
+                              size=(-1);
+                              break;
+                            }
+                          batch_index=0;
+                        }
+                      p=strip_pixels+batch_index*extent;
+                      batch_index++;
+                      batch_remaining--;
+                    }
+                  else
+#endif
+                    {
+                      size=TIFFReadEncodedStrip(tiff,strip_id,strip_pixels,
+                        strip_size);
+                      if (size == -1)
+                        break;
+                      p=strip_pixels;
+                    }
                   rows_remaining=rows_per_strip;
-                  p=strip_pixels;
                   strip_id++;
                 }
               (void) ImportQuantumPixels(image,(CacheView *) NULL,
@@ -2019,6 +2330,10 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
               break;
           }
           (void) SetQuantumMetaChannel(image,quantum_info,-1);
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          if (decoder_info != (TIFFDecoderInfo *) NULL)
+            decoder_info=DestroyTIFFDecoderInfo(decoder_info);
+#endif
           strip_pixels=(unsigned char *) RelinquishMagickMemory(strip_pixels);
           break;
         }
@@ -2028,6 +2343,7 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
             count,
             extent,
             length,
+            number_tiles,
             stride,
             tile_size;
 
@@ -2039,6 +2355,11 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
             *p,
             *tile_pixels;
 
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          TIFFDecoderInfo
+            *decoder_info;
+
+#endif
           /*
             Convert tiled TIFF image.
           */
@@ -2056,11 +2377,21 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
           if (HeapOverflowSanityCheckGetSize(rows,MagickMax(stride,length),&count) != MagickFalse)
             ThrowTIFFException(ResourceLimitError,"MemoryAllocationFailed");
           extent=MagickMax(tile_size,count);
-          tile_pixels=(unsigned char *) AcquireQuantumMemory(extent,
+          number_tiles=1;
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          if (IsStringTrue(GetImageOption(image_info,"tiff:parallel-decode")) != MagickFalse)
+            number_tiles=(image->columns+columns-1)/columns;
+#endif
+          if (HeapOverflowSanityCheckGetSize(number_tiles,extent,&count) != MagickFalse)
+            ThrowTIFFException(ResourceLimitError,"MemoryAllocationFailed");
+          tile_pixels=(unsigned char *) AcquireQuantumMemory(count,
             sizeof(*tile_pixels));
           if (tile_pixels == (unsigned char *) NULL)
             ThrowTIFFException(ResourceLimitError,"MemoryAllocationFailed");
-          (void) memset(tile_pixels,0,extent*sizeof(*tile_pixels));
+          (void) memset(tile_pixels,0,count*sizeof(*tile_pixels));
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          decoder_info=AcquireTIFFDecoderInfo(image,tiff,number_tiles);
+#endif
           for (i=0; i < (ssize_t) samples_per_pixel; i++)
           {
             QuantumType
@@ -2118,6 +2449,24 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
               rows_remaining=image->rows-(size_t) y;
               if ((ssize_t) (y+rows) < (ssize_t) image->rows)
                 rows_remaining=rows;
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+              if (decoder_info != (TIFFDecoderInfo *) NULL)
+                {
+                  /*
+                    Decode this row of tiles in parallel.
+                  */
+                  if (DecodeTIFFStriles(decoder_info,tiff,TIFFComputeTile(tiff,
+                        0,(uint32) y,0,(uint16) i),number_tiles,tile_pixels,
+                        extent,exception) == MagickFalse)
+                    {
+                      (void) ThrowMagickException(exception,GetMagickModule(),
+                        CorruptImageError,"UnableToReadImageData","`%s'",
+                        image->filename);
+                      size=(-1);
+                      break;
+                    }
+                }
+#endif
               for (x=0; x < (ssize_t) image->columns; x+=columns)
               {
                 size_t
@@ -2127,11 +2476,18 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
                 columns_remaining=image->columns-(size_t) x;
                 if ((x+(ssize_t) columns) < (ssize_t) image->columns)
                   columns_remaining=columns;
-                size=TIFFReadTile(tiff,tile_pixels,(uint32_t) x,(uint32_t) y,
-                  0,(uint16_t) i);
-                if (size == -1)
-                  break;
-                p=tile_pixels;
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+                if (decoder_info != (TIFFDecoderInfo *) NULL)
+                  p=tile_pixels+((size_t) x/columns)*extent;
+                else
+#endif
+                  {
+                    size=TIFFReadTile(tiff,tile_pixels,(uint32_t) x,
+                      (uint32_t) y,0,(uint16_t) i);
+                    if (size == -1)
+                      break;
+                    p=tile_pixels;
+                  }
                 for (row=0; row < rows_remaining; row++)
                 {
                   Quantum
@@ -2163,6 +2519,10 @@ static Image *ReadTIFFImage(const ImageInfo *image_info,
               }
           }
           (void) SetQuantumMetaChannel(image,quantum_info,-1);
+#if defined(MAGICKCORE_OPENMP_SUPPORT) && (TIFFLIB_VERSION >= 20191103)
+          if (decoder_info != (TIFFDecoderInfo *) NULL)
+            decoder_info=DestroyTIFFDecoderInfo(decoder_info);
+#endif
           tile_pixels=(unsigned char *) RelinquishMagickMemory(tile_pixels);
           break;
         }
@@ -0,0 +1,196 @@
+/*
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%                                                                             %
+%                                                                             %
+%                                                                             %
+%                 M   M  EEEEE  M   M   OOO   RRRR   Y   Y                    %
+%                 MM MM  E      MM MM  O   O  R   R   Y Y                     %
+%                 M M M  EEE    M M M  O   O  RRRR     Y                      %
+%                 M   M  E      M   M  O   O  R R      Y                      %
+%                 M   M  EEEEE  M   M   OOO   R  R     Y                      %
+%                                                                             %
+%                         TTTTT  EEEEE  SSSSS  TTTTT                          %
+%                           T    E      SS       T                            %
+%                           T    EEE     SSS     T                            %
+%                           T    E         SS    T                            %
+%                           T    EEEEE  SSSSS    T                            %
+%                                                                             %
+%                                                                             %
+%                        MagickCore Memory Arena Tests                        %
+%                                                                             %
+%                              Software Design                                %
+%                                   Cristy                                    %
+%                                October 2026                                 %
+%                                                                             %
+%                                                                             %
+%  Copyright 1999 ImageMagick Studio LLC, a non-profit organization           %
+%  dedicated to making software imaging solutions freely available.           %
+%                                                                             %
+%  You may not use this file except in compliance with the License.  You may  %
+%  obtain a copy of the License at                                            %
+%                                                                             %
+%    https://imagemagick.org/license/                                         %
+%                                                                             %
+%  Unless required by applicable law or agreed to in writing, software        %
+%  distributed under the License is distributed on an "AS IS" BASIS,          %
+%  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   %
+%  See the License for the specific language governing permissions and        %
+%  limitations under the License.                                             %
+%                                                                             %
+%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+%
+%
+%
+*/
+
+/*
+  Include declarations.
+*/
+#include "MagickCore/studio.h"
+#include "MagickCore/MagickCore.h"
+#include "MagickCore/memory-private.h"
+#include "MagickCore/thread-private.h"
+
+#define ThrowMemoryTestException(message) \
+{ \
+  (void) FormatLocaleFile(stderr,"%s %s %lu %s\n",GetMagickModule(), \
+    message); \
+  return(MagickFalse); \
+}
+
+static inline MagickBooleanType IsCacheAligned(const void *memory)
+{
+  return(((size_t) memory % CACHE_LINE_SIZE) == 0 ? MagickTrue : MagickFalse);
+}
+
+static MagickBooleanType TestArenaScopes(void)
+{
+  char
+    *huge,
+    *inner,
+    *outer,
+    *reuse;
+
+  /*
+    Blocks are cache aligned and do not overlap.
+  */
+  outer=(char *) AcquireArenaMemory(1,100);
+  inner=(char *) AcquireArenaMemory(10,10);
+  if ((outer == (char *) NULL) || (inner == (char *) NULL))
+    ThrowMemoryTestException("arena memory allocation failed");
+  if ((IsCacheAligned(outer) == MagickFalse) ||
+      (IsCacheAligned(inner) == MagickFalse))
+    ThrowMemoryTestException("arena memory is not cache aligned");
+  if (inner < (outer+100))
+    ThrowMemoryTestException("arena memory blocks overlap");
+  (void) memset(outer,0xaa,100);
+  (void) memset(inner,0x55,100);
+  /*
+    A request larger than the arena block extent gets a block of its own.
+  */
+  huge=(char *) AcquireArenaMemory(1024,1024);
+  if (huge == (char *) NULL)
+    ThrowMemoryTestException("arena memory allocation failed");
+  (void) memset(huge,0xff,1024*1024);
+  if ((outer[99] != (char) 0xaa) || (inner[0] != (char) 0x55))
+    ThrowMemoryTestException("arena memory blocks overlap");
+  /*
+    Relinquishing a block releases it and every block acquired after it, and
+    the next request reuses the released memory.
+  */
+  (void) RelinquishArenaMemory(inner);
+  reuse=(char *) AcquireArenaMemory(10,10);
+  if (reuse != inner)
+    ThrowMemoryTestException("released arena memory is not reused");
+  huge=(char *) AcquireArenaMemory(1024,1024);
+  if (huge == (char *) NULL)
+    ThrowMemoryTestException("arena memory allocation failed");
+  (void) RelinquishArenaMemory(outer);
+  reuse=(char *) AcquireArenaMemory(1,100);
+  if (reuse != outer)
+    ThrowMemoryTestException("empty arena does not restart at its first block");
+  (void) RelinquishArenaMemory(reuse);
+  return(MagickTrue);
+}
+
+static MagickBooleanType TestThreadArenas(void)
+{
+  char
+    **memory;
+
+  MagickBooleanType
+    status;
+
+  ssize_t
+    i,
+    j;
+
+  size_t
+    number_threads;
+
+  /*
+    Every thread bumps from its own arena; worker arenas are left holding
+    live blocks so the memory manager must free them at teardown.
+  */
+  number_threads=(size_t) GetMagickResourceLimit(ThreadResource);
+  memory=(char **) AcquireQuantumMemory(number_threads,sizeof(*memory));
+  if (memory == (char **) NULL)
+    ThrowMemoryTestException("memory allocation failed");
+  (void) memset(memory,0,number_threads*sizeof(*memory));
+  status=MagickTrue;
+#if defined(MAGICKCORE_OPENMP_SUPPORT)
+  #pragma omp parallel for schedule(static,1) num_threads((int) number_threads)
+#endif
+  for (i=0; i < (ssize_t) number_threads; i++)
+  {
+    const int
+      id = GetOpenMPThreadId();
+
+    char
+      *p;
+
+    p=(char *) AcquireArenaMemory(1,4096);
+    if (p == (char *) NULL)
+      {
+        status=MagickFalse;
+        continue;
+      }
+    (void) memset(p,id,4096);
+    memory[i]=p;
+  }
+  if (status == MagickFalse)
+    {
+      memory=(char **) RelinquishMagickMemory(memory);
+      ThrowMemoryTestException("arena memory allocation failed");
+    }
+  for (i=0; i < (ssize_t) number_threads; i++)
+    for (j=i+1; j < (ssize_t) number_threads; j++)
+      if ((memory[i] < (memory[j]+4096)) && (memory[j] < (memory[i]+4096)))
+        status=MagickFalse;
+  memory=(char **) RelinquishMagickMemory(memory);
+  if (status == MagickFalse)
+    ThrowMemoryTestException("thread arenas overlap");
+  return(MagickTrue);
+}
+
+int main(int argc,char **argv)
+{
+  ssize_t
+    i;
+
+  (void) argc;
+  /*
+    Exercise the arenas across several memory manager lifetimes: teardown
+    must free the arena of every thread and leave no stale thread value.
+  */
+  for (i=0; i < 3; i++)
+  {
+    MagickCoreGenesis(*argv,MagickFalse);
+    if (TestArenaScopes() == MagickFalse)
+      return(1);
+    if (TestThreadArenas() == MagickFalse)
+      return(1);
+    MagickCoreTerminus();
+  }
+  return(0);
+}